@@ -6,6 +6,16 @@
  * Description: 
  * Hand-optimized SIMD (NEON) routine for complex matrix multiplication pre-processing.
  * Utilizing 128-bit vector registers (v0-v31) for 4x throughput.
+ *
+ * Kernels:
+ *   hocs_neon_accumulate  - elementwise float add (dest += src)
+ *   hocs_neon_dot_f64     - double dot product (FMLA, 4 accumulators)
+ *   hocs_neon_dot_f32     - float dot product (FMLA, 4 accumulators)
+ *   hocs_neon_dot_q12     - Q4.12 int16 dot product, int32 accumulate (SMLAL)
+ *   hocs_neon_axpy_f64    - y += a * x (double, FMLA by element)
+ *   hocs_neon_axpy_f32    - y += a * x (float, FMLA by element)
+ * The dot/axpy kernels are dispatched by cpp_core/hocs_simd_kernels.hpp.
+ * Only caller-saved vector registers (v0-v7, v16-v31) are used.
  */
 
 .text
@@ -83,4 +93,286 @@ hocs_neon_accumulate:
  * The 'prfm' instruction is critical here to avoid stalling the pipeline
  * while waiting for DRAM access. This gives us ~30% boost over -O3 GCC output.
  */
- 
+
+// ---------------------------------------------------------------------------
+// double hocs_neon_dot_f64(const double* a, const double* b, long n);
+// x0 = a ptr, x1 = b ptr, x2 = n  ->  d0 = sum(a[i] * b[i])
+// ---------------------------------------------------------------------------
+.global hocs_neon_dot_f64
+.type hocs_neon_dot_f64, %function
+.align 4
+
+hocs_neon_dot_f64:
+    stp     x29, x30, [sp, #-16]!
+    mov     x29, sp
+
+    // Four independent accumulators hide the FMLA latency
+    movi    v0.2d, #0
+    movi    v1.2d, #0
+    movi    v2.2d, #0
+    movi    v3.2d, #0
+
+    cmp     x2, #8
+    blt     .L_dot64_reduce
+
+.L_dot64_loop:
+    prfm    PLDL1KEEP, [x0, #256]
+    prfm    PLDL1KEEP, [x1, #256]
+
+    // 8 doubles (one cache line) from each operand
+    ld1     {v4.2d, v5.2d, v6.2d, v7.2d}, [x0], #64
+    ld1     {v16.2d, v17.2d, v18.2d, v19.2d}, [x1], #64
+
+    // Fused multiply-add: acc += a * b
+    fmla    v0.2d, v4.2d, v16.2d
+    fmla    v1.2d, v5.2d, v17.2d
+    fmla    v2.2d, v6.2d, v18.2d
+    fmla    v3.2d, v7.2d, v19.2d
+
+    sub     x2, x2, #8
+    cmp     x2, #8
+    bge     .L_dot64_loop
+
+.L_dot64_reduce:
+    fadd    v0.2d, v0.2d, v1.2d
+    fadd    v2.2d, v2.2d, v3.2d
+    fadd    v0.2d, v0.2d, v2.2d
+    faddp   d0, v0.2d
+
+.L_dot64_tail:
+    cmp     x2, #0
+    ble     .L_dot64_done
+    ldr     d4, [x0], #8
+    ldr     d5, [x1], #8
+    fmadd   d0, d4, d5, d0
+    sub     x2, x2, #1
+    b       .L_dot64_tail
+
+.L_dot64_done:
+    ldp     x29, x30, [sp], #16
+    ret
+
+.size hocs_neon_dot_f64, .-hocs_neon_dot_f64
+
+// ---------------------------------------------------------------------------
+// float hocs_neon_dot_f32(const float* a, const float* b, long n);
+// x0 = a ptr, x1 = b ptr, x2 = n  ->  s0 = sum(a[i] * b[i])
+// ---------------------------------------------------------------------------
+.global hocs_neon_dot_f32
+.type hocs_neon_dot_f32, %function
+.align 4
+
+hocs_neon_dot_f32:
+    stp     x29, x30, [sp, #-16]!
+    mov     x29, sp
+
+    movi    v0.4s, #0
+    movi    v1.4s, #0
+    movi    v2.4s, #0
+    movi    v3.4s, #0
+
+    cmp     x2, #16
+    blt     .L_dot32_reduce
+
+.L_dot32_loop:
+    prfm    PLDL1KEEP, [x0, #256]
+    prfm    PLDL1KEEP, [x1, #256]
+
+    // 16 floats (one cache line) from each operand
+    ld1     {v4.4s, v5.4s, v6.4s, v7.4s}, [x0], #64
+    ld1     {v16.4s, v17.4s, v18.4s, v19.4s}, [x1], #64
+
+    fmla    v0.4s, v4.4s, v16.4s
+    fmla    v1.4s, v5.4s, v17.4s
+    fmla    v2.4s, v6.4s, v18.4s
+    fmla    v3.4s, v7.4s, v19.4s
+
+    sub     x2, x2, #16
+    cmp     x2, #16
+    bge     .L_dot32_loop
+
+.L_dot32_reduce:
+    fadd    v0.4s, v0.4s, v1.4s
+    fadd    v2.4s, v2.4s, v3.4s
+    fadd    v0.4s, v0.4s, v2.4s
+    faddp   v0.4s, v0.4s, v0.4s
+    faddp   s0, v0.2s
+
+.L_dot32_tail:
+    cmp     x2, #0
+    ble     .L_dot32_done
+    ldr     s4, [x0], #4
+    ldr     s5, [x1], #4
+    fmadd   s0, s4, s5, s0
+    sub     x2, x2, #1
+    b       .L_dot32_tail
+
+.L_dot32_done:
+    ldp     x29, x30, [sp], #16
+    ret
+
+.size hocs_neon_dot_f32, .-hocs_neon_dot_f32
+
+// ---------------------------------------------------------------------------
+// int32_t hocs_neon_dot_q12(const int16_t* a, const int16_t* b, long n);
+// x0 = a ptr, x1 = b ptr, x2 = n  ->  w0 = sum(a[i] * b[i]) (Q8.24, int32)
+// ---------------------------------------------------------------------------
+.global hocs_neon_dot_q12
+.type hocs_neon_dot_q12, %function
+.align 4
+
+hocs_neon_dot_q12:
+    stp     x29, x30, [sp, #-16]!
+    mov     x29, sp
+
+    movi    v0.4s, #0
+    movi    v1.4s, #0
+    movi    v2.4s, #0
+    movi    v3.4s, #0
+    mov     w3, #0
+
+    cmp     x2, #16
+    blt     .L_dotq_reduce
+
+.L_dotq_loop:
+    prfm    PLDL1KEEP, [x0, #128]
+    prfm    PLDL1KEEP, [x1, #128]
+
+    // 16 Q4.12 samples from each operand
+    ld1     {v4.8h, v5.8h}, [x0], #32
+    ld1     {v16.8h, v17.8h}, [x1], #32
+
+    // Signed multiply-accumulate long: int16 x int16 -> int32 lanes
+    smlal   v0.4s, v4.4h, v16.4h
+    smlal2  v1.4s, v4.8h, v16.8h
+    smlal   v2.4s, v5.4h, v17.4h
+    smlal2  v3.4s, v5.8h, v17.8h
+
+    sub     x2, x2, #16
+    cmp     x2, #16
+    bge     .L_dotq_loop
+
+.L_dotq_reduce:
+    add     v0.4s, v0.4s, v1.4s
+    add     v2.4s, v2.4s, v3.4s
+    add     v0.4s, v0.4s, v2.4s
+    addv    s0, v0.4s
+    fmov    w3, s0
+
+.L_dotq_tail:
+    cmp     x2, #0
+    ble     .L_dotq_done
+    ldrsh   w4, [x0], #2
+    ldrsh   w5, [x1], #2
+    madd    w3, w4, w5, w3
+    sub     x2, x2, #1
+    b       .L_dotq_tail
+
+.L_dotq_done:
+    mov     w0, w3
+    ldp     x29, x30, [sp], #16
+    ret
+
+.size hocs_neon_dot_q12, .-hocs_neon_dot_q12
+
+// ---------------------------------------------------------------------------
+// void hocs_neon_axpy_f64(double* y, const double* x, double a, long n);
+// x0 = y ptr, x1 = x ptr, d0 = a, x2 = n  ->  y[i] += a * x[i]
+// ---------------------------------------------------------------------------
+.global hocs_neon_axpy_f64
+.type hocs_neon_axpy_f64, %function
+.align 4
+
+hocs_neon_axpy_f64:
+    stp     x29, x30, [sp, #-16]!
+    mov     x29, sp
+
+    cmp     x2, #8
+    blt     .L_axpy64_tail
+
+.L_axpy64_loop:
+    prfm    PLDL1KEEP, [x1, #256]
+    prfm    PSTL1KEEP, [x0, #256]
+
+    ld1     {v16.2d, v17.2d, v18.2d, v19.2d}, [x1], #64
+    ld1     {v4.2d, v5.2d, v6.2d, v7.2d}, [x0]
+
+    // FMLA by element: y += x * a (a broadcast from lane 0 of v0)
+    fmla    v4.2d, v16.2d, v0.d[0]
+    fmla    v5.2d, v17.2d, v0.d[0]
+    fmla    v6.2d, v18.2d, v0.d[0]
+    fmla    v7.2d, v19.2d, v0.d[0]
+
+    st1     {v4.2d, v5.2d, v6.2d, v7.2d}, [x0], #64
+
+    sub     x2, x2, #8
+    cmp     x2, #8
+    bge     .L_axpy64_loop
+
+.L_axpy64_tail:
+    cmp     x2, #0
+    ble     .L_axpy64_done
+    ldr     d16, [x1], #8
+    ldr     d4, [x0]
+    fmadd   d4, d16, d0, d4
+    str     d4, [x0], #8
+    sub     x2, x2, #1
+    b       .L_axpy64_tail
+
+.L_axpy64_done:
+    ldp     x29, x30, [sp], #16
+    ret
+
+.size hocs_neon_axpy_f64, .-hocs_neon_axpy_f64
+
+// ---------------------------------------------------------------------------
+// void hocs_neon_axpy_f32(float* y, const float* x, float a, long n);
+// x0 = y ptr, x1 = x ptr, s0 = a, x2 = n  ->  y[i] += a * x[i]
+// ---------------------------------------------------------------------------
+.global hocs_neon_axpy_f32
+.type hocs_neon_axpy_f32, %function
+.align 4
+
+hocs_neon_axpy_f32:
+    stp     x29, x30, [sp, #-16]!
+    mov     x29, sp
+
+    cmp     x2, #16
+    blt     .L_axpy32_tail
+
+.L_axpy32_loop:
+    prfm    PLDL1KEEP, [x1, #256]
+    prfm    PSTL1KEEP, [x0, #256]
+
+    ld1     {v16.4s, v17.4s, v18.4s, v19.4s}, [x1], #64
+    ld1     {v4.4s, v5.4s, v6.4s, v7.4s}, [x0]
+
+    fmla    v4.4s, v16.4s, v0.s[0]
+    fmla    v5.4s, v17.4s, v0.s[0]
+    fmla    v6.4s, v18.4s, v0.s[0]
+    fmla    v7.4s, v19.4s, v0.s[0]
+
+    st1     {v4.4s, v5.4s, v6.4s, v7.4s}, [x0], #64
+
+    sub     x2, x2, #16
+    cmp     x2, #16
+    bge     .L_axpy32_loop
+
+.L_axpy32_tail:
+    cmp     x2, #0
+    ble     .L_axpy32_done
+    ldr     s16, [x1], #4
+    ldr     s4, [x0]
+    fmadd   s4, s16, s0, s4
+    str     s4, [x0], #4
+    sub     x2, x2, #1
+    b       .L_axpy32_tail
+
+.L_axpy32_done:
+    ldp     x29, x30, [sp], #16
+    ret
+
+.size hocs_neon_axpy_f32, .-hocs_neon_axpy_f32
+
+// No executable stack: otherwise the linker marks libhocs_engine.so execstack
+.section .note.GNU-stack,"",%progbits
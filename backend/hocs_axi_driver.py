@@ -20,13 +20,17 @@ import numpy as np
 import time
 import os
 import sys
+import math
+import ctypes
+import mmap
 import logging
 import asyncio
+import threading
 from concurrent.futures import ThreadPoolExecutor
 
 # Try importing PYNQ, otherwise fallback to Virtual Mode
 try:
-    from pynq import Overlay, allocate
+    from pynq import Overlay, allocate, MMIO
     PYNQ_AVAILABLE = True
 except ImportError:
     PYNQ_AVAILABLE = False
@@ -34,8 +38,28 @@ except ImportError:
 # --- CONFIGURATION ---
 DEFAULT_BITSTREAM = "hocs_core_v1.bit"
 DMA_ADDRESS_BASE  = 0x40000000
+CSR_WINDOW_BYTES  = 0x1000      # BAR0 registers at DMA_ADDRESS_BASE (docs/INTERFACE_SPEC.md, section 3)
+HOCS_REG_TEMP     = 0x10        # SYSMON code of the FPGA die temperature
+HOCS_DEVICE_PATH  = "/dev/hocs_accelerator"  # PCIe card (kernel_driver/), BAR0 at mmap offset 0
 MAX_BUFFER_SIZE   = 512 * 1024 * 1024  # 512 MB DMA Buffer
 THERMAL_LIMIT     = 85.0  # Celsius
+THERMAL_SOFT_LIMIT    = 80.0  # Celsius; the scheduler sheds load above this, SCRAM stays at THERMAL_LIMIT
+THERMAL_TIME_CONSTANT = 2.0   # Seconds, die / crossbar cooling toward ambient
+THERMAL_MAX_DELAY     = 0.5   # Seconds a job may be held back before it is shed instead
+THERMAL_UNITS         = 2     # Crossbar replicas per layer shape in simulation
+SIM_AMBIENT_C         = 26.85 # T_AMBIENT of cpp_core/hocs_native_engine.hpp
+DMA_QUEUE_DEPTH   = 4     # Hardware tensors in flight (CMA buffer sets kept warm)
+NATIVE_QUEUE_SLOTS   = 8
+NATIVE_QUEUE_WORKERS = 2
+NATIVE_SLOT_BYTES    = 4 * 1024 * 1024  # Per slot and direction (one HugePage DMA payload)
+NATIVE_SPARSE        = True  # Skip all-off tiles / rows of pruned weights (cost follows the nonzeros)
+NATIVE_ENGINE_LIB = os.environ.get(
+    "HOCS_ENGINE_LIB",
+    os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "cpp_core", "libhocs_engine.so"))
+
+HOCS_STAGES = ("quantize", "dma_submit", "irq", "readback", "dequantize")  # HOCSStage order
+HOCS_HDR_BUCKETS = 1216      # HOCSLatencyHistogram::BUCKETS
+HOCS_TILE_BUDGET_US = 50.0   # Target round trip per tile (docs/INTERFACE_SPEC.md, section 4)
 
 # Logging Setup
 logging.basicConfig(
@@ -45,21 +69,446 @@ logging.basicConfig(
 )
 logger = logging.getLogger("HOCS_AXI")
 
+class HOCSConvGeometry(ctypes.Structure):
+    """struct HOCSConvGeometry of cpp_core/hocs_conv.hpp."""
+    _fields_ = [(name, ctypes.c_int32) for name in
+                ("channels", "height", "width", "kernel_h", "kernel_w", "stride", "padding", "dilation")]
+
+class HOCSStageSummary(ctypes.Structure):
+    """struct HOCSStageSummary of cpp_core/hocs_telemetry.hpp (nanoseconds)."""
+    _fields_ = [("count", ctypes.c_uint64)] + [(name, ctypes.c_double) for name in
+                ("min_ns", "mean_ns", "p50_ns", "p90_ns", "p99_ns", "p999_ns", "max_ns")]
+
+def sysmon_to_celsius(raw):
+    """UltraScale+ SYSMON transfer function of the 16-bit TEMP code."""
+    return (raw & 0xFFFF) * 509.3140064 / 65536.0 - 280.23087870
+
+class HOCSRegisterWindow:
+    """
+    BAR0 register window of the accelerator: mmap of /dev/hocs_accelerator
+    on the PCIe card, PYNQ MMIO on the Kria SoM. Reads are single 32-bit
+    loads, as the AXI-Lite slave requires.
+    """
+
+    def __init__(self, device_path=HOCS_DEVICE_PATH, csr_base=DMA_ADDRESS_BASE):
+        self.regs = None
+        self.mmio = None
+        if os.path.exists(device_path):
+            # Read-only: a writable window needs CAP_SYS_RAWIO
+            fd = os.open(device_path, os.O_RDONLY | os.O_SYNC)
+            try:
+                self.regs = mmap.mmap(fd, CSR_WINDOW_BYTES, prot=mmap.PROT_READ,
+                                      offset=0)  # HOCS_MMAP_REGS_OFFSET
+                self.words = memoryview(self.regs).cast("I")
+            finally:
+                os.close(fd)
+        elif PYNQ_AVAILABLE:
+            self.mmio = MMIO(csr_base, CSR_WINDOW_BYTES)
+        else:
+            raise RuntimeError("HOCS register window: no device node and no PYNQ")
+
+    def read(self, offset):
+        if self.regs is not None:
+            return self.words[offset // 4]
+        return self.mmio.read(offset)
+
+class HOCSStageRecorder:
+    """
+    Feeds stages timed in Python (the PYNQ DMA path) into the native
+    telemetry of cpp_core/hocs_telemetry.hpp; a no-op without the library.
+    """
+
+    def __init__(self, lib):
+        self.lib = lib
+
+    def now(self):
+        return self.lib.hocs_telemetry_now() if self.lib is not None else 0
+
+    def record(self, stage, start, end):
+        if self.lib is not None:
+            self.lib.hocs_telemetry_record(HOCS_STAGES.index(stage), start, end)
+
+def read_stage_histograms(lib):
+    """Per-stage HDR histograms of the native library, in microseconds."""
+    count = len(HOCS_STAGES)
+    summaries = (HOCSStageSummary * count)()
+    lower = (ctypes.c_uint64 * HOCS_HDR_BUCKETS)()
+    counts = (ctypes.c_uint64 * HOCS_HDR_BUCKETS)()
+    stages = {}
+    for index in range(max(lib.hocs_telemetry_snapshot(summaries, count), 0)):
+        summary = summaries[index]
+        entry = {"count": summary.count}
+        if summary.count:
+            for field in ("min", "mean", "p50", "p90", "p99", "p999", "max"):
+                entry[f"{field}_us"] = round(getattr(summary, f"{field}_ns") / 1e3, 3)
+        used = lib.hocs_telemetry_buckets(index, lower, counts, HOCS_HDR_BUCKETS)
+        entry["buckets"] = [[lower[i] / 1e3, counts[i]] for i in range(max(used, 0))]  # [lower_us, count]
+        stages[HOCS_STAGES[index]] = entry
+    return {"tile_budget_us": HOCS_TILE_BUDGET_US, "dropped_events": lib.hocs_telemetry_dropped(),
+            "stages": stages}
+
+class HOCSNativeLayer:
+    """
+    Warm M x K crossbar layer of the native engine (cpp_core/libhocs_engine.so),
+    held through the opaque-handle C API. Buffers are passed by pointer, so no
+    copies are made beyond the float32/C-order conversion NumPy needs.
+    """
+
+    PRECISION_F32 = 1  # HOCS_PRECISION_F32
+    _lib = None
+
+    @classmethod
+    def load_library(cls, path=NATIVE_ENGINE_LIB):
+        """Binds the handle API once; returns None if the library is unavailable."""
+        if cls._lib is None:
+            try:
+                lib = ctypes.CDLL(path)
+            except OSError:
+                return None
+            lib.hocs_engine_create.restype = ctypes.c_void_p
+            lib.hocs_engine_create.argtypes = [ctypes.c_int, ctypes.c_int, ctypes.c_int]
+            lib.hocs_engine_destroy.argtypes = [ctypes.c_void_p]
+            lib.hocs_engine_program_weights.argtypes = [ctypes.c_void_p, ctypes.c_void_p, ctypes.c_int]
+            lib.hocs_engine_propagate_batch.argtypes = [ctypes.c_void_p, ctypes.c_void_p, ctypes.c_int, ctypes.c_void_p]
+            lib.hocs_engine_program_and_propagate.argtypes = [
+                ctypes.c_void_p, ctypes.c_void_p, ctypes.c_int, ctypes.c_void_p, ctypes.c_int, ctypes.c_void_p]
+            lib.hocs_engine_convolve.argtypes = [
+                ctypes.c_void_p, ctypes.POINTER(HOCSConvGeometry), ctypes.c_void_p, ctypes.c_int, ctypes.c_void_p]
+            lib.hocs_engine_peak_temperature.argtypes = [ctypes.c_void_p, ctypes.POINTER(ctypes.c_double)]
+            lib.hocs_engine_set_thermal_time_constant.argtypes = [ctypes.c_void_p, ctypes.c_double]
+            lib.hocs_engine_set_sparse.argtypes = [ctypes.c_void_p, ctypes.c_int]
+            lib.hocs_engine_tile_density.argtypes = [ctypes.c_void_p, ctypes.POINTER(ctypes.c_double)]
+            lib.hocs_engine_last_error.restype = ctypes.c_char_p
+
+            lib.hocs_telemetry_snapshot.argtypes = [ctypes.POINTER(HOCSStageSummary), ctypes.c_int]
+            lib.hocs_telemetry_buckets.argtypes = [
+                ctypes.c_int, ctypes.POINTER(ctypes.c_uint64), ctypes.POINTER(ctypes.c_uint64), ctypes.c_int]
+            lib.hocs_telemetry_dropped.restype = ctypes.c_uint64
+            lib.hocs_telemetry_now.restype = ctypes.c_uint64
+            lib.hocs_telemetry_record.argtypes = [ctypes.c_int, ctypes.c_uint64, ctypes.c_uint64]
+
+            lib.hocs_queue_create.restype = ctypes.c_void_p
+            lib.hocs_queue_create.argtypes = [ctypes.c_int, ctypes.c_size_t, ctypes.c_size_t, ctypes.c_int]
+            lib.hocs_queue_destroy.argtypes = [ctypes.c_void_p]
+            lib.hocs_queue_eventfd.argtypes = [ctypes.c_void_p]
+            lib.hocs_queue_acquire.argtypes = [ctypes.c_void_p]
+            for name in ("hocs_queue_input", "hocs_queue_output"):
+                getattr(lib, name).restype = ctypes.c_void_p
+                getattr(lib, name).argtypes = [ctypes.c_void_p, ctypes.c_int]
+            lib.hocs_queue_voltage_offset.restype = ctypes.c_long
+            lib.hocs_queue_voltage_offset.argtypes = [ctypes.c_void_p]
+            lib.hocs_queue_submit_program_propagate.argtypes = [
+                ctypes.c_void_p, ctypes.c_int, ctypes.c_void_p, ctypes.c_int]
+            lib.hocs_queue_reap.argtypes = [ctypes.c_void_p, ctypes.c_void_p, ctypes.c_void_p, ctypes.c_int]
+            lib.hocs_queue_release.argtypes = [ctypes.c_void_p, ctypes.c_int]
+            cls._lib = lib
+        return cls._lib
+
+    def __init__(self, rows, cols):
+        self.handle = None
+        self.lib = self.load_library()
+        if self.lib is None:
+            raise RuntimeError(f"HOCS native engine not found: {NATIVE_ENGINE_LIB}")
+        self.rows, self.cols = rows, cols
+        self.handle = self.lib.hocs_engine_create(rows, cols, self.PRECISION_F32)
+        if not self.handle:
+            raise RuntimeError(self._last_error())
+
+    def _last_error(self):
+        return self.lib.hocs_engine_last_error().decode(errors="replace")
+
+    def _check(self, status):
+        if status != 0:
+            raise RuntimeError(f"HOCS native engine: {self._last_error()}")
+
+    def program_weights(self, weights):
+        weights = np.ascontiguousarray(weights, dtype=np.float32)
+        self._check(self.lib.hocs_engine_program_weights(self.handle, weights.ctypes.data, self.cols))
+
+    def propagate_batch(self, voltages):
+        """cols x B voltages -> rows x B currents."""
+        voltages = np.ascontiguousarray(voltages, dtype=np.float32)
+        batch = voltages.shape[1]
+        currents = np.empty((self.rows, batch), dtype=np.float32)
+        self._check(self.lib.hocs_engine_propagate_batch(self.handle, voltages.ctypes.data, batch,
+                                                         currents.ctypes.data))
+        return currents
+
+    def multiply(self, weights, voltages):
+        """Programs `weights` and returns weights @ voltages as one atomic step."""
+        weights = np.ascontiguousarray(weights, dtype=np.float32)
+        voltages = np.ascontiguousarray(voltages, dtype=np.float32)
+        batch = voltages.shape[1]
+        currents = np.empty((self.rows, batch), dtype=np.float32)
+        self._check(self.lib.hocs_engine_program_and_propagate(
+            self.handle, weights.ctypes.data, self.cols, voltages.ctypes.data, batch, currents.ctypes.data))
+        return currents
+
+    def convolve(self, feature_maps, kernel_size, stride=1, padding=0, dilation=1):
+        """
+        Conv2d through the programmed out_channels x (C * kh * kw) kernel
+        matrix (program_weights(weight.reshape(rows, -1))). N x C x H x W in,
+        N x rows x out_h x out_w out; patches are formed inside the engine.
+        """
+        feature_maps = np.ascontiguousarray(feature_maps, dtype=np.float32)
+        images, channels, height, width = feature_maps.shape
+        kh, kw = (kernel_size, kernel_size) if isinstance(kernel_size, int) else kernel_size
+        geometry = HOCSConvGeometry(channels, height, width, kh, kw, stride, padding, dilation)
+        out_h = (height + 2 * padding - dilation * (kh - 1) - 1) // stride + 1
+        out_w = (width + 2 * padding - dilation * (kw - 1) - 1) // stride + 1
+        output = np.empty((images, self.rows, out_h, out_w), dtype=np.float32)
+        self._check(self.lib.hocs_engine_convolve(self.handle, ctypes.byref(geometry), feature_maps.ctypes.data,
+                                                  images, output.ctypes.data))
+        return output
+
+    def set_thermal_time_constant(self, seconds):
+        """Lets the layer cool toward ambient between passes (0 = adiabatic)."""
+        self._check(self.lib.hocs_engine_set_thermal_time_constant(self.handle, seconds))
+
+    def set_sparse(self, enabled):
+        """Skips all-off tiles, rows and column blocks of pruned weights."""
+        self._check(self.lib.hocs_engine_set_sparse(self.handle, int(bool(enabled))))
+
+    def tile_density(self):
+        """Fraction of the layer's tiles holding programmed weights."""
+        density = ctypes.c_double()
+        self._check(self.lib.hocs_engine_tile_density(self.handle, ctypes.byref(density)))
+        return density.value
+
+    def peak_temperature(self):
+        """Hottest crossbar cell of the layer, Kelvin."""
+        kelvin = ctypes.c_double()
+        self._check(self.lib.hocs_engine_peak_temperature(self.handle, ctypes.byref(kelvin)))
+        return kelvin.value
+
+    def close(self):
+        if self.handle:
+            self.lib.hocs_engine_destroy(self.handle)
+            self.handle = None
+
+    def __del__(self):
+        self.close()
+
+def _native_view(address, shape, dtype=np.float32):
+    """NumPy view of native memory (no copy)."""
+    count = int(np.prod(shape))
+    raw = (ctypes.c_char * (count * np.dtype(dtype).itemsize)).from_address(address)
+    return np.frombuffer(raw, dtype=dtype, count=count).reshape(shape)
+
+class HOCSNativeQueue:
+    """
+    Native job queue (cpp_core/hocs_job_queue.hpp) driven from asyncio.
+    Tensors are copied into preallocated slots, run on native worker threads,
+    and completed through an eventfd registered with the event loop, so many
+    requests can be in flight without blocking the loop or allocating.
+    """
+
+    def __init__(self, slots=NATIVE_QUEUE_SLOTS, slot_bytes=NATIVE_SLOT_BYTES, workers=NATIVE_QUEUE_WORKERS):
+        self.queue = None
+        self.lib = HOCSNativeLayer.load_library()
+        if self.lib is None:
+            raise RuntimeError(f"HOCS native engine not found: {NATIVE_ENGINE_LIB}")
+        self.queue = self.lib.hocs_queue_create(slots, slot_bytes, slot_bytes, workers)
+        if not self.queue:
+            raise RuntimeError(self.lib.hocs_engine_last_error().decode(errors="replace"))
+        self.slot_bytes = slot_bytes
+        self.efd = self.lib.hocs_queue_eventfd(self.queue)
+        self.pending = {}  # slot -> (future, rows, batch)
+        self.loop = None
+        self.slot_released = None
+        self._reaped = (ctypes.c_int * slots)()
+        self._statuses = (ctypes.c_int * slots)()
+
+    def fits(self, layer, batch):
+        offset = self.lib.hocs_queue_voltage_offset(layer.handle)
+        return (offset + layer.cols * batch * 4 <= self.slot_bytes and
+                layer.rows * batch * 4 <= self.slot_bytes)
+
+    def _bind(self, loop):
+        """Moves the completion reader to the running loop (asyncio.run makes new ones)."""
+        if self.loop is loop:
+            return
+        if self.loop is not None and not self.loop.is_closed():
+            self.loop.remove_reader(self.efd)
+        loop.add_reader(self.efd, self._on_completion)
+        self.loop = loop
+        self.slot_released = asyncio.Event()
+
+    def _on_completion(self):
+        count = self.lib.hocs_queue_reap(self.queue, self._reaped, self._statuses, len(self._reaped))
+        for i in range(max(count, 0)):
+            slot, status = self._reaped[i], self._statuses[i]
+            future, rows, batch = self.pending.pop(slot)
+            if status == 0:
+                result = _native_view(self.lib.hocs_queue_output(self.queue, slot), (rows, batch)).copy()
+            self.lib.hocs_queue_release(self.queue, slot)
+            if future.done():
+                continue
+            if status == 0:
+                future.set_result(result)
+            else:
+                future.set_exception(RuntimeError(f"HOCS native job failed with status {status}"))
+        if count > 0:
+            self.slot_released.set()
+
+    async def multiply(self, layer, weights, voltages):
+        """weights @ voltages on `layer`, awaited without blocking the loop."""
+        loop = asyncio.get_running_loop()
+        self._bind(loop)
+        slot = self.lib.hocs_queue_acquire(self.queue)
+        while slot < 0:  # Back-pressure: every slot is in flight
+            self.slot_released.clear()
+            await self.slot_released.wait()
+            slot = self.lib.hocs_queue_acquire(self.queue)
+
+        batch = voltages.shape[1]
+        data = self.lib.hocs_queue_input(self.queue, slot)
+        offset = self.lib.hocs_queue_voltage_offset(layer.handle)
+        np.copyto(_native_view(data, (layer.rows, layer.cols)), weights, casting="unsafe")
+        np.copyto(_native_view(data + offset, (layer.cols, batch)), voltages, casting="unsafe")
+
+        future = loop.create_future()
+        self.pending[slot] = (future, layer.rows, batch)
+        if self.lib.hocs_queue_submit_program_propagate(self.queue, slot, layer.handle, batch) != 0:
+            del self.pending[slot]
+            self.lib.hocs_queue_release(self.queue, slot)
+            raise RuntimeError(self.lib.hocs_engine_last_error().decode(errors="replace"))
+        return await future
+
+    def close(self):
+        if self.queue:
+            if self.loop is not None and not self.loop.is_closed():
+                self.loop.remove_reader(self.efd)
+            self.lib.hocs_queue_destroy(self.queue)
+            self.queue = None
+
+    def __del__(self):
+        self.close()
+
+class HOCSThermalOverload(RuntimeError):
+    """Every unit is too hot to take a job within THERMAL_MAX_DELAY."""
+
+    def __init__(self, retry_after):
+        super().__init__(f"HOCS thermal limit: job shed, retry in {retry_after:.2f} s")
+        self.retry_after = retry_after
+
+class HOCSThermalScheduler:
+    """
+    Keeps HOCS units (crossbar replicas in simulation, the device on
+    hardware) under THERMAL_SOFT_LIMIT, so load is shed gradually instead of
+    tripping the safety SCRAM at THERMAL_LIMIT.
+
+    Each unit follows a lumped RC model: it cools toward ambient with
+    THERMAL_TIME_CONSTANT and every job adds the heat of one job, learned
+    from sensor readings (REG_TEMP or the simulated crossbars), which also
+    replace the model state after each job. reserve() takes the coolest
+    unit; if even that one would cross the soft limit the job is delayed
+    until it has cooled enough, or shed when that takes longer than
+    max_delay.
+    """
+
+    def __init__(self, units, ambient, soft_limit=THERMAL_SOFT_LIMIT, time_constant=THERMAL_TIME_CONSTANT,
+                 max_delay=THERMAL_MAX_DELAY):
+        now = time.monotonic()
+        self.ambient = ambient
+        self.soft_limit = soft_limit
+        self.time_constant = time_constant
+        self.max_delay = max_delay
+        self.temps = [ambient] * units    # Model state at self.stamps
+        self.stamps = [now] * units       # May lie ahead: a delayed job's start
+        self.heat = 0.0                   # Kelvin per job (EWMA)
+        self.heat_samples = 0
+        self.lock = threading.Lock()
+        self.dispatched = self.throttled = self.shed = 0
+        self.delay_total = 0.0
+
+    def _predict(self, unit, now):
+        elapsed = max(now - self.stamps[unit], 0.0)
+        return self.ambient + (self.temps[unit] - self.ambient) * math.exp(-elapsed / self.time_constant)
+
+    def _plan(self, unit, now):
+        """(delay, start temperature) of a job on `unit`: after its booked jobs, once cool enough."""
+        ready = max(now, self.stamps[unit])
+        start = self._predict(unit, ready)
+        if start + self.heat <= self.soft_limit:
+            return ready - now, start
+        # Time for start to decay to soft_limit - heat
+        headroom = self.soft_limit - self.heat - self.ambient
+        if headroom <= 0:
+            return math.inf, start
+        cooling = self.time_constant * math.log((start - self.ambient) / headroom)
+        return ready - now + cooling, self.soft_limit - self.heat
+
+    def reserve(self):
+        """(unit, delay in seconds, predicted start temperature); raises HOCSThermalOverload."""
+        with self.lock:
+            now = time.monotonic()
+            plans = [self._plan(unit, now) for unit in range(len(self.temps))]
+            unit = min(range(len(plans)), key=plans.__getitem__)
+            delay, start = plans[unit]
+            if delay > self.max_delay:
+                self.shed += 1
+                raise HOCSThermalOverload(delay if math.isfinite(delay) else self.time_constant)
+            if delay > 0:
+                self.throttled += 1
+                self.delay_total += delay
+
+            self.temps[unit] = start + self.heat
+            self.stamps[unit] = now + delay
+            self.dispatched += 1
+            return unit, delay, start
+
+    def observe(self, unit, celsius, baseline=None):
+        """Sensor reading of `unit` after a job that started at `baseline` (from reserve)."""
+        with self.lock:
+            if baseline is not None and celsius > baseline:
+                rise = celsius - baseline
+                self.heat = rise if self.heat_samples == 0 else 0.8 * self.heat + 0.2 * rise
+                self.heat_samples += 1
+            self.temps[unit] = celsius
+            self.stamps[unit] = time.monotonic()
+
+    def stats(self):
+        with self.lock:
+            now = time.monotonic()
+            return {
+                "soft_limit_c": self.soft_limit,
+                "unit_temps_c": [round(self._predict(unit, now), 2) for unit in range(len(self.temps))],
+                "heat_per_job_c": round(self.heat, 4),
+                "dispatched": self.dispatched,
+                "throttled": self.throttled,
+                "shed": self.shed,
+                "throttle_delay_s": round(self.delay_total, 3),
+            }
+
 class HOCSDriverEngine:
     """
     The main driver class that orchestrates data transfer between PS (Processing System)
     and PL (Programmable Logic / Optical Core).
     """
 
-    def __init__(self, bitstream_path=DEFAULT_BITSTREAM, simulation_mode=False):
+    def __init__(self, bitstream_path=DEFAULT_BITSTREAM, simulation_mode=False, device_id="HOCS_UNIT_01",
+                 dma_channel="axi_dma_0", csr_base=DMA_ADDRESS_BASE, device_node=HOCS_DEVICE_PATH):
         self.simulation_mode = simulation_mode
+        self.device_id = device_id
+        self.dma_channel = dma_channel
+        self.csr_base = csr_base
+        self.device_node = device_node
         self.overlay = None
         self.dma = None
         self.input_buffer = None
         self.output_buffer = None
         self.status = "OFFLINE"
+        self.native_layers = {}  # (rows, cols, unit) -> HOCSNativeLayer, kept warm
+        self.layer_lock = threading.Lock()  # native_layers is shared by loop and worker threads
+        self.native_queue = None
+        self.cma_pool = {}  # shape -> [(in_buf, out_buf)], reused across requests
+        self.dma_lock = threading.Lock()  # One transfer pair on the AXI DMA channel at a time
+        self.dma_executor = ThreadPoolExecutor(max_workers=DMA_QUEUE_DEPTH, thread_name_prefix="hocs-dma")
+        self.registers = None  # HOCSRegisterWindow once the hardware is linked
+        self.stages = HOCSStageRecorder(HOCSNativeLayer.load_library())
         
-        logger.info("Initializing HOCS Driver Engine...")
+        logger.info(f"Initializing HOCS Driver Engine ({device_id})...")
         logger.info(f"Mode: {'SIMULATION / VIRTUAL' if simulation_mode else 'HARDWARE ACCELERATED'}")
 
         if not self.simulation_mode and PYNQ_AVAILABLE:
@@ -70,6 +519,12 @@ class HOCSDriverEngine:
             self.simulation_mode = True
             self.status = "VIRTUAL_READY"
 
+        if self.registers is not None:
+            # One device; the idle die at link time is the ambient of its model
+            self.thermal = HOCSThermalScheduler(1, sysmon_to_celsius(self.registers.read(HOCS_REG_TEMP)))
+        else:
+            self.thermal = HOCSThermalScheduler(THERMAL_UNITS, SIM_AMBIENT_C)
+
     def _load_bitstream(self, path):
         """Loads the FPGA logic bitstream onto the Kria SoM."""
         if not os.path.exists(path):
@@ -79,7 +534,8 @@ class HOCSDriverEngine:
         try:
             logger.info(f"Programming FPGA with: {path} ...")
             self.overlay = Overlay(path)
-            self.dma = self.overlay.axi_dma_0
+            self.dma = getattr(self.overlay, self.dma_channel)
+            self.registers = HOCSRegisterWindow(self.device_node, self.csr_base)
             self.status = "HARDWARE_LINKED"
             logger.info("FPGA Bitstream Loaded Successfully. AXI DMA Channel Open.")
         except Exception as e:
@@ -87,15 +543,16 @@ class HOCSDriverEngine:
             self.status = "ERROR"
             raise
 
-    def allocate_buffers(self, shape, dtype=np.float32):
+    def allocate_buffers(self, shape, dtype=np.float32, out_shape=None):
         """Allocates contiguous memory blocks (CMA) for DMA transfer."""
+        out_shape = shape if out_shape is None else out_shape
         if self.simulation_mode:
             # Standard RAM allocation for simulation
-            return np.zeros(shape, dtype=dtype), np.zeros(shape, dtype=dtype)
+            return np.zeros(shape, dtype=dtype), np.zeros(out_shape, dtype=dtype)
         else:
             # Contiguous Memory Allocation for FPGA
             in_buf = allocate(shape=shape, dtype=dtype)
-            out_buf = allocate(shape=shape, dtype=dtype)
+            out_buf = allocate(shape=out_shape, dtype=dtype)
             return in_buf, out_buf
 
     def cpu_stress_test(self, matrix_size=2048):
@@ -122,55 +579,230 @@ class HOCSDriverEngine:
         logger.info(f"Stress Test Complete. Duration: {duration:.4f}s | Performance: {flops:.2f} GFLOPS")
         return C, duration
 
+    def _native_layer(self, rows, cols, unit=0):
+        """Returns the warm native layer for this shape on `unit`, or None without the library."""
+        with self.layer_lock:
+            layer = self.native_layers.get((rows, cols, unit))
+            if layer is None and HOCSNativeLayer.load_library() is not None:
+                layer = HOCSNativeLayer(rows, cols)
+                layer.set_thermal_time_constant(THERMAL_TIME_CONSTANT)
+                layer.set_sparse(NATIVE_SPARSE)
+                self.native_layers[(rows, cols, unit)] = layer
+            return layer
+
+    def _unit_temperature(self, unit):
+        """Celsius of one scheduler unit, None if it cannot be measured."""
+        if self.registers is not None:
+            return sysmon_to_celsius(self.registers.read(HOCS_REG_TEMP))
+        with self.layer_lock:
+            layers = [layer for (_, _, u), layer in self.native_layers.items() if u == unit]
+        kelvin = [layer.peak_temperature() for layer in layers]
+        return max(kelvin) - 273.15 if kelvin else None
+
+    def _native_job_queue(self):
+        if self.native_queue is None:
+            self.native_queue = HOCSNativeQueue()
+        return self.native_queue
+
+    def _acquire_cma(self, shape, out_shape=None):
+        free = self.cma_pool.setdefault((shape, out_shape), [])
+        return free.pop() if free else self.allocate_buffers(shape, out_shape=out_shape)
+
+    def _release_cma(self, shape, buffers, out_shape=None):
+        free = self.cma_pool.setdefault((shape, out_shape), [])
+        if len(free) < DMA_QUEUE_DEPTH:
+            free.append(buffers)
+        else:
+            for buf in buffers:
+                buf.freebuffer()
+
+    def _dma_roundtrip(self, in_buf, out_buf, input_matrix):
+        """Blocking copy-in / transfer / copy-out, run on a DMA worker thread."""
+        # Copy data to CMA buffer (overlaps with another request's transfer)
+        in_buf[:] = input_matrix
+        with self.dma_lock:
+            # Trigger DMA Transfer
+            logger.debug("DMA: Transferring data to Optical Core...")
+            submitted = self.stages.now()
+            self.dma.sendchannel.transfer(in_buf)
+            self.dma.recvchannel.transfer(out_buf)
+            started = self.stages.now()
+
+            # Wait for FPGA interrupt
+            self.dma.sendchannel.wait()
+            self.dma.recvchannel.wait()
+            interrupted = self.stages.now()
+        result = out_buf.copy()
+        self.stages.record("dma_submit", submitted, started)
+        self.stages.record("irq", started, interrupted)
+        self.stages.record("readback", interrupted, self.stages.now())
+        return result
+
     async def process_tensor_async(self, input_matrix):
         """
         Asynchronous processing pipeline. 
         Sends data to FPGA (or simulates it) and waits for result.
+        The thermal scheduler picks the unit and may hold the job back while
+        it cools, or shed it (HOCSThermalOverload).
         """
+        unit, delay, baseline = self.thermal.reserve()
+        if delay > 0:
+            logger.warning(f"Thermal throttling: unit {unit} held back {delay * 1000:.1f} ms")
+            await asyncio.sleep(delay)
+        try:
+            return await self._process_on_unit(input_matrix, unit)
+        finally:
+            # Scanning simulated crossbars is O(cells): off the event loop
+            temperature = await asyncio.get_running_loop().run_in_executor(None, self._unit_temperature, unit)
+            if temperature is not None:
+                self.thermal.observe(unit, temperature, baseline)
+
+    async def _process_on_unit(self, input_matrix, unit):
         rows, cols = input_matrix.shape
         logger.info(f"Processing Tensor Request [{rows}x{cols}]...")
 
         if self.simulation_mode:
-            # Simulate Optical Latency (Speed of Light is fast, but DAC is slow)
-            await asyncio.sleep(0.005) 
-            
-            # Use NumPy for logic verification
             # Adding artificial 'Optical Noise' to simulate analog behavior
-            noise = np.random.normal(0, 0.001, input_matrix.shape)
+            noise = np.random.normal(0, 0.001, (rows, rows))
+            layer = self._native_layer(rows, cols, unit)
+
+            if layer is not None:
+                # Native crossbar: the input is programmed as weights and its
+                # rows are applied as voltages, off the event loop
+                queue = self._native_job_queue()
+                if queue.fits(layer, rows):
+                    result = await queue.multiply(layer, input_matrix, input_matrix.T)
+                else:
+                    loop = asyncio.get_running_loop()
+                    result = await loop.run_in_executor(None, layer.multiply, input_matrix, input_matrix.T)
+                return result + noise
+
+            # Fallback without libhocs_engine.so: NumPy for logic verification
+            # Simulate Optical Latency (Speed of Light is fast, but DAC is slow)
+            await asyncio.sleep(0.005)
             result = np.dot(input_matrix, input_matrix.T) + noise
             
             return result
         
         else:
-            # REAL HARDWARE EXECUTION
-            in_buf, out_buf = self.allocate_buffers(input_matrix.shape)
-            
-            # Copy data to CMA buffer
-            in_buf[:] = input_matrix
-            
-            # Trigger DMA Transfer
-            logger.debug("DMA: Transferring data to Optical Core...")
-            self.dma.sendchannel.transfer(in_buf)
-            self.dma.recvchannel.transfer(out_buf)
-            
-            # Wait for FPGA interrupt
-            self.dma.sendchannel.wait()
-            self.dma.recvchannel.wait()
-            
-            result = out_buf.copy()
-            
-            # Free memory
-            in_buf.freebuffer()
-            out_buf.freebuffer()
-            
-            return result
+            # REAL HARDWARE EXECUTION: warm CMA buffers, blocking waits on a
+            # DMA worker so the event loop keeps serving other requests
+            shape = input_matrix.shape
+            buffers = self._acquire_cma(shape)
+            try:
+                loop = asyncio.get_running_loop()
+                return await loop.run_in_executor(self.dma_executor, self._dma_roundtrip, *buffers, input_matrix)
+            finally:
+                self._release_cma(shape, buffers)
+
+    def _multiply_on_unit(self, weights, voltages, unit):
+        """Blocking body of multiply(): the native layer of `unit`, NumPy, or one DMA job."""
+        if self.simulation_mode:
+            layer = self._native_layer(weights.shape[0], weights.shape[1], unit)
+            if layer is not None:
+                return layer.multiply(weights, voltages)
+            return np.dot(weights, voltages).astype(np.float32)
+
+        # One DMA job: weights then voltages back to back, M x B results
+        operands = np.concatenate((np.ravel(weights), np.ravel(voltages))).astype(np.float32)
+        shape, out_shape = operands.shape, (weights.shape[0], voltages.shape[1])
+        buffers = self._acquire_cma(shape, out_shape)
+        try:
+            return self._dma_roundtrip(*buffers, operands)
+        finally:
+            self._release_cma(shape, buffers, out_shape)
+
+    def multiply(self, weights, voltages):
+        """
+        weights (M x K) @ voltages (K x B) on this device, blocking: for
+        worker threads. Goes through the thermal scheduler like
+        process_tensor_async (sleeps while throttled, raises
+        HOCSThermalOverload when shed).
+        """
+        unit, delay, baseline = self.thermal.reserve()
+        if delay > 0:
+            time.sleep(delay)
+        try:
+            return self._multiply_on_unit(weights, voltages, unit)
+        finally:
+            temperature = self._unit_temperature(unit)
+            if temperature is not None:
+                self.thermal.observe(unit, temperature, baseline)
+
+    async def multiply_async(self, weights, voltages):
+        """
+        multiply() from the event loop. Simulated jobs that fit a slot go
+        through the native job queue (eventfd completion), the rest run on
+        the DMA workers.
+        """
+        unit, delay, baseline = self.thermal.reserve()
+        if delay > 0:
+            await asyncio.sleep(delay)
+        loop = asyncio.get_running_loop()
+        try:
+            if self.simulation_mode:
+                layer = self._native_layer(weights.shape[0], weights.shape[1], unit)
+                if layer is not None:
+                    queue = self._native_job_queue()
+                    if queue.fits(layer, voltages.shape[1]):
+                        return await queue.multiply(layer, weights, voltages)
+            return await loop.run_in_executor(self.dma_executor, self._multiply_on_unit, weights, voltages, unit)
+        finally:
+            temperature = await loop.run_in_executor(None, self._unit_temperature, unit)
+            if temperature is not None:
+                self.thermal.observe(unit, temperature, baseline)
+
+    def read_temperature(self):
+        """
+        Die temperature in Celsius and where it came from: REG_TEMP on
+        hardware, the hottest simulated crossbar cell otherwise (None until
+        a native layer exists).
+        """
+        if self.registers is not None:
+            return sysmon_to_celsius(self.registers.read(HOCS_REG_TEMP)), "REG_TEMP"
+        with self.layer_lock:
+            layers = list(self.native_layers.values())
+        if layers:
+            kelvin = max(layer.peak_temperature() for layer in layers)
+            return kelvin - 273.15, "SIMULATED_CROSSBAR"
+        return None, "UNAVAILABLE"
+
+    def close(self):
+        """
+        Releases the unit: DMA workers first (none still runs a layer), then
+        the native queue (its eventfd reader and worker threads), the warm
+        layers and the pooled CMA buffers.
+        """
+        self.dma_executor.shutdown(wait=True)
+        if self.native_queue is not None:
+            self.native_queue.close()
+            self.native_queue = None
+        with self.layer_lock:
+            layers = list(self.native_layers.values())
+            self.native_layers.clear()
+        for layer in layers:
+            layer.close()
+        if not self.simulation_mode:
+            for free in self.cma_pool.values():
+                for buffers in free:
+                    for buf in buffers:
+                        buf.freebuffer()
+        self.cma_pool.clear()
+
+    def get_latency_histograms(self):
+        """Per-stage latency (quantize .. dequantize) of the native runtime, {} without it."""
+        lib = HOCSNativeLayer.load_library()
+        return read_stage_histograms(lib) if lib is not None else {}
 
     def get_telemetry(self):
-        """Returns dummy or real telemetry data."""
+        """Driver state and the measured die temperature."""
+        temperature, source = self.read_temperature()
         return {
+            "device_id": self.device_id,
             "status": self.status,
             "mode": "SIMULATION" if self.simulation_mode else "HARDWARE",
-            "fpga_temp": 42.5 if self.simulation_mode else 38.0, # Fake reading
-            "power_draw_watts": 0.5 if self.simulation_mode else 12.4
-          }
+            "fpga_temp": round(temperature, 2) if temperature is not None else None,
+            "fpga_temp_source": source,
+            "thermal": self.thermal.stats(),
+        }
           
@@ -0,0 +1,201 @@
+"""
+HOCS Request Batcher - Dynamic Batching for the REST API
+--------------------------------------------------------
+Module: hocs_batcher.py
+Integration: HOCS Device Pool
+
+Description:
+    Coalesces concurrent propagations against the same programmed weights.
+    The first request for a weight set opens a batch; requests arriving
+    within the latency window append their voltage columns to it. When the
+    window closes (or the batch reaches max_columns) the columns are
+    concatenated into one K x B operand, dispatched as a single batched
+    propagate through the device pool, and the result columns are scattered
+    back to the callers.
+
+    Batches live in one event loop, i.e. one API worker process: requests
+    only coalesce with others served by the same uvicorn worker.
+
+    HOCSWeightsRegistry holds the weight sets those requests refer to,
+    content addressed and bounded: past max_mb the least recently used
+    sets are evicted.
+"""
+
+import asyncio
+import hashlib
+import logging
+from collections import OrderedDict
+
+import numpy as np
+
+from hocs_device_pool import DEFAULT_CONFIG
+
+BATCH_WINDOW_MS   = 2.0  # Longest a request waits for others to join its batch
+BATCH_MAX_COLUMNS = 512  # Voltage columns per dispatch (4 crossbar tiles)
+WEIGHTS_MAX_MB    = 256  # Registered weight sets kept per API worker
+
+logger = logging.getLogger("HOCS_BATCH")
+
+def _api_section(path, name):
+    """`api.<name>` of system_config.yaml, {} without the file or PyYAML."""
+    try:
+        import yaml
+        with open(path) as f:
+            return ((yaml.safe_load(f) or {}).get("api") or {}).get(name) or {}
+    except (ImportError, OSError) as e:
+        logger.warning(f"api.{name}: {path} not usable ({e}), using defaults")
+        return {}
+
+class _HOCSBatch:
+    def __init__(self, weights):
+        self.weights = weights
+        self.requests = []  # (voltages, future)
+        self.columns = 0
+        self.timer = None
+
+class HOCSRequestBatcher:
+    """Per weight set batching in front of HOCSDevicePool.gemm_async."""
+
+    def __init__(self, pool, window_ms=BATCH_WINDOW_MS, max_columns=BATCH_MAX_COLUMNS):
+        if window_ms < 0 or max_columns <= 0:
+            raise ValueError("HOCSRequestBatcher: window_ms must be >= 0 and max_columns > 0")
+        self.pool = pool
+        self.window = window_ms / 1000.0
+        self.max_columns = max_columns
+        self.pending = {}
+        self.requests = 0
+        self.batches = 0
+
+    @classmethod
+    def from_config(cls, pool, path=DEFAULT_CONFIG):
+        """Window and batch size from `api.batching` of system_config.yaml, defaults without it."""
+        batching = _api_section(path, "batching")
+        return cls(pool, window_ms=batching.get("window_ms", BATCH_WINDOW_MS),
+                   max_columns=batching.get("max_columns", BATCH_MAX_COLUMNS))
+
+    async def propagate(self, key, weights, voltages):
+        """
+        weights (M x K) @ voltages (K x B), batched with the other requests
+        for `key` (one key per weight set). A dispatch never exceeds
+        max_columns: a request that would overflow the open batch starts
+        the next one, and one wider than max_columns is rejected
+        (ValueError). Raises what the dispatch raised, HOCSThermalOverload
+        included.
+        """
+        voltages = np.ascontiguousarray(voltages, dtype=np.float32)
+        if voltages.shape[0] != weights.shape[1]:
+            raise ValueError(f"Voltages need {weights.shape[1]} rows, got {voltages.shape[0]}")
+        if voltages.shape[1] > self.max_columns:
+            raise ValueError(f"At most {self.max_columns} voltage columns per request, got {voltages.shape[1]}")
+
+        loop = asyncio.get_running_loop()
+        batch = self.pending.get(key)
+        if batch is not None and batch.columns + voltages.shape[1] > self.max_columns:
+            self._flush(key, batch)
+            batch = None
+        if batch is None:
+            batch = self.pending[key] = _HOCSBatch(weights)
+            batch.timer = loop.call_later(self.window, self._flush, key, batch)
+        future = loop.create_future()
+        batch.requests.append((voltages, future))
+        batch.columns += voltages.shape[1]
+        self.requests += 1
+        if batch.columns >= self.max_columns:
+            self._flush(key, batch)
+        return await future
+
+    def _flush(self, key, batch):
+        if self.pending.get(key) is not batch:
+            return  # Already dispatched by max_columns
+        del self.pending[key]
+        batch.timer.cancel()
+        self.batches += 1
+        asyncio.ensure_future(self._dispatch(batch))
+
+    async def _dispatch(self, batch):
+        try:
+            voltages = batch.requests[0][0] if len(batch.requests) == 1 else \
+                np.concatenate([v for v, _ in batch.requests], axis=1)
+            result = await self.pool.gemm_async(batch.weights, voltages)
+        except Exception as e:
+            for _, future in batch.requests:
+                if not future.done():
+                    future.set_exception(e)
+            return
+
+        column = 0
+        for v, future in batch.requests:
+            if not future.done():  # Client gone: its columns are dropped
+                future.set_result(result[:, column:column + v.shape[1]])
+            column += v.shape[1]
+
+    def stats(self):
+        return {
+            "window_ms": self.window * 1000.0,
+            "max_columns": self.max_columns,
+            "requests": self.requests,
+            "batches": self.batches,
+            "mean_batch": self.requests / self.batches if self.batches else 0.0,
+        }
+
+class HOCSWeightsRegistry:
+    """
+    weights_id -> M x K float32 for /compute/propagate. The id is a digest
+    of contents and shape, so clients registering the same weights share
+    one id (and one batch). Holds at most max_mb; lookups refresh an
+    entry, registrations past the cap evict the least recently used.
+    """
+
+    def __init__(self, max_mb=WEIGHTS_MAX_MB):
+        if max_mb <= 0:
+            raise ValueError("HOCSWeightsRegistry: max_mb must be > 0")
+        self.max_bytes = int(max_mb * 1024 * 1024)
+        self.entries = OrderedDict()
+        self.bytes = 0
+        self.evicted = 0
+
+    @classmethod
+    def from_config(cls, path=DEFAULT_CONFIG):
+        """Cap from `api.weights_registry` of system_config.yaml, the default without it."""
+        return cls(max_mb=_api_section(path, "weights_registry").get("max_mb", WEIGHTS_MAX_MB))
+
+    @staticmethod
+    def weights_id(weights):
+        digest = hashlib.blake2b(weights.tobytes(), digest_size=16)
+        digest.update(str(weights.shape).encode())
+        return digest.hexdigest()
+
+    def add(self, weights):
+        """Registers `weights` (ValueError if it alone exceeds the cap) and returns its id."""
+        weights = np.ascontiguousarray(weights, dtype=np.float32)
+        if weights.nbytes > self.max_bytes:
+            raise ValueError(f"Weights of {weights.nbytes} bytes exceed the registry cap of {self.max_bytes}")
+        weights_id = self.weights_id(weights)
+        if weights_id in self.entries:
+            self.entries.move_to_end(weights_id)
+            return weights_id
+        while self.bytes + weights.nbytes > self.max_bytes:
+            _, oldest = self.entries.popitem(last=False)
+            self.bytes -= oldest.nbytes
+            self.evicted += 1
+        self.entries[weights_id] = weights
+        self.bytes += weights.nbytes
+        return weights_id
+
+    def get(self, weights_id):
+        weights = self.entries.get(weights_id)
+        if weights is not None:
+            self.entries.move_to_end(weights_id)
+        return weights
+
+    def remove(self, weights_id):
+        """Drops the entry; False if it was not registered. Batches already open keep their copy."""
+        weights = self.entries.pop(weights_id, None)
+        if weights is None:
+            return False
+        self.bytes -= weights.nbytes
+        return True
+
+    def stats(self):
+        return {"entries": len(self.entries), "bytes": self.bytes, "max_bytes": self.max_bytes,
+                "evicted": self.evicted}
@@ -0,0 +1,190 @@
+"""
+HOCS Device Pool - Multi-Unit GEMM Sharding
+-------------------------------------------
+Module: hocs_device_pool.py
+Integration: HOCS AXI Driver
+
+Description:
+    Several HOCS units (Kria boards, or simulated engines) behind one GEMM
+    entry point. A GEMM is sharded by tile row: every shard is HOCS_TILE_DIM
+    output rows times the full K, so shards are independent and the results
+    are gathered by plain row placement, without a reduction.
+
+    Each device starts with a contiguous run of tile rows (its crossbar
+    layers stay warm on the same weights from call to call) in its own
+    deque and takes work from the front. A device whose deque runs dry
+    steals from the back of the longest other deque, so a slower device, or
+    one its thermal scheduler is holding back, ends up with fewer tiles.
+    A device that sheds a tile (HOCSThermalOverload) hands it back and sits
+    out the rest of the call; the GEMM only fails if every device sheds.
+
+    gemm() runs every device on its own single worker thread, so a device
+    never executes two tiles at once. gemm_async() drives the devices from
+    the event loop through HOCSDriverEngine.multiply_async, i.e. the native
+    job queue in simulation and the DMA workers on hardware.
+"""
+
+import os
+import asyncio
+import logging
+import threading
+from collections import deque
+from concurrent.futures import ThreadPoolExecutor
+
+import numpy as np
+
+from hocs_axi_driver import HOCSDriverEngine, HOCSThermalOverload, DEFAULT_BITSTREAM
+
+HOCS_TILE_DIM = 128  # cpp_core/hocs_tiler.hpp
+DEFAULT_CONFIG = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "config", "system_config.yaml")
+
+logger = logging.getLogger("HOCS_POOL")
+
+class HOCSDevicePool:
+    """
+    N HOCSDriverEngine devices sharing GEMMs with work stealing. Every
+    device owns one worker thread; the native engine and the DMA waits
+    release the GIL, so devices compute concurrently.
+    """
+
+    def __init__(self, devices):
+        if not devices:
+            raise ValueError("HOCSDevicePool needs at least one device")
+        self.devices = list(devices)
+        self.workers = [ThreadPoolExecutor(max_workers=1, thread_name_prefix=f"hocs-pool-{i}")
+                        for i in range(len(self.devices))]
+        self.counter_lock = threading.Lock()  # Tile counters, bumped from every worker
+        self.tiles_done = [0] * len(self.devices)
+        self.tiles_stolen = [0] * len(self.devices)
+        self.tiles_shed = [0] * len(self.devices)
+
+    @classmethod
+    def from_config(cls, path=DEFAULT_CONFIG, simulation_mode=True, bitstream_path=None):
+        """One device per `devices` entry of system_config.yaml (a single device without the file)."""
+        entries, bitstream = [{}], DEFAULT_BITSTREAM
+        try:
+            import yaml
+            with open(path) as f:
+                config = yaml.safe_load(f) or {}
+            entries = config.get("devices") or entries
+            bitstream = config.get("hardware", {}).get("fpga", {}).get("bitstream_file", bitstream)
+        except (ImportError, OSError) as e:
+            logger.warning(f"Device pool: {path} not usable ({e}), using one default device")
+        bitstream = bitstream_path or bitstream
+        return cls([HOCSDriverEngine(bitstream_path=bitstream, simulation_mode=simulation_mode, **entry)
+                    for entry in entries])
+
+    def __len__(self):
+        return len(self.devices)
+
+    def _next_tile(self, queues, index):
+        """Own work from the front, else a steal from the back of the longest other deque."""
+        while True:
+            try:
+                return queues[index].popleft()
+            except IndexError:
+                pass
+            victims = [i for i in range(len(queues)) if i != index and queues[i]]
+            if not victims:
+                return None
+            try:
+                tile = queues[max(victims, key=lambda i: len(queues[i]))].pop()
+            except IndexError:
+                continue  # Raced with the owner or another thief
+            self._count(self.tiles_stolen, index)
+            return tile
+
+    def _count(self, counters, index):
+        with self.counter_lock:
+            counters[index] += 1
+
+    def _worker(self, index, queues, weights, voltages, output):
+        device = self.devices[index]
+        while True:
+            tile = self._next_tile(queues, index)
+            if tile is None:
+                return None
+            row0, row1 = tile
+            try:
+                output[row0:row1] = device.multiply(weights[row0:row1], voltages)
+            except HOCSThermalOverload as e:
+                queues[index].appendleft(tile)  # Left for the devices that still have headroom
+                self._count(self.tiles_shed, index)
+                return e
+            self._count(self.tiles_done, index)
+
+    async def _worker_async(self, index, queues, weights, voltages, output):
+        """_worker() as a coroutine: one tile of this device in flight at a time."""
+        device = self.devices[index]
+        while True:
+            tile = self._next_tile(queues, index)
+            if tile is None:
+                return None
+            row0, row1 = tile
+            try:
+                output[row0:row1] = await device.multiply_async(weights[row0:row1], voltages)
+            except HOCSThermalOverload as e:
+                queues[index].appendleft(tile)
+                self._count(self.tiles_shed, index)
+                return e
+            self._count(self.tiles_done, index)
+
+    def _shard(self, weights, voltages):
+        """(weights, voltages, output, per-device tile deques) of one GEMM."""
+        weights = np.ascontiguousarray(weights, dtype=np.float32)
+        voltages = np.ascontiguousarray(voltages, dtype=np.float32)
+        rows = weights.shape[0]
+        output = np.empty((rows, voltages.shape[1]), dtype=np.float32)
+
+        tiles = [(row0, min(row0 + HOCS_TILE_DIM, rows)) for row0 in range(0, rows, HOCS_TILE_DIM)]
+        queues = [deque() for _ in self.devices]
+        for i, tile in enumerate(tiles):
+            queues[i * len(self.devices) // len(tiles)].append(tile)
+        return weights, voltages, output, queues
+
+    @staticmethod
+    def _retire(active, shed, queues):
+        """Devices still active after a round; raises once every device shed."""
+        overloads = [e for e in shed.values() if e is not None]
+        active = [index for index in active if shed[index] is None]
+        if any(queues) and not active:
+            raise HOCSThermalOverload(min(e.retry_after for e in overloads))
+        return active
+
+    def gemm(self, weights, voltages):
+        """weights (M x K) @ voltages (K x B), sharded across the pool. Blocking."""
+        weights, voltages, output, queues = self._shard(weights, voltages)
+        active = list(range(len(self.devices)))
+        while any(queues):
+            futures = {index: self.workers[index].submit(self._worker, index, queues, weights, voltages, output)
+                       for index in active}
+            active = self._retire(active, {index: future.result() for index, future in futures.items()}, queues)
+        return output
+
+    async def gemm_async(self, weights, voltages):
+        """gemm() from the event loop, without a thread per call."""
+        weights, voltages, output, queues = self._shard(weights, voltages)
+        active = list(range(len(self.devices)))
+        while any(queues):
+            results = await asyncio.gather(*(self._worker_async(index, queues, weights, voltages, output)
+                                             for index in active))
+            active = self._retire(active, dict(zip(active, results)), queues)
+        return output
+
+    def stats(self):
+        return {
+            "devices": [
+                {"device_id": device.device_id, "tiles_done": self.tiles_done[i],
+                 "tiles_stolen": self.tiles_stolen[i], "tiles_shed": self.tiles_shed[i],
+                 "thermal": device.thermal.stats()}
+                for i, device in enumerate(self.devices)
+            ],
+            "tile_rows": HOCS_TILE_DIM,
+        }
+
+    def close(self):
+        """Stops the pool workers, then releases every device."""
+        for worker in self.workers:
+            worker.shutdown(wait=True)
+        for device in self.devices:
+            device.close()
@@ -35,6 +35,7 @@ from typing import Dict, List, Optional
 LOG_DIR = "logs/blackbox"
 MAX_VOLTAGE_THRESHOLD = 12.5  # Volts
 MAX_TEMP_THRESHOLD = 85.0     # Celsius
+SOFT_TEMP_THRESHOLD = 80.0    # Celsius; the driver's thermal scheduler sheds load above this
 SHUTDOWN_TIMEOUT_SEC = 5.0
 CAPACITOR_DISCHARGE_RATE = 0.5 # Volts per step
 
@@ -201,9 +202,14 @@ class HOCSSafetyMonitor:
             print("!!! FORCING HARD KILL !!!")
             sys.exit(1)
 
-    def monitor_loop(self):
+    def monitor_loop(self, temperature_sensor=None):
         """
         Main heartbeat loop. Checks thermal and voltage sensors continuously.
+        temperature_sensor() returns the die temperature in Celsius or None
+        (e.g. lambda: driver.read_temperature()[0]); without one the reading
+        is simulated. Between SOFT_TEMP_THRESHOLD and MAX_TEMP_THRESHOLD the
+        driver's HOCSThermalScheduler is already shedding load, so the
+        monitor only reports THROTTLED; SCRAM stays the last resort.
         """
         logging.info("Safety Monitor Active. Waiting for interrupts...")
         print("[MONITOR] System Running. Press Ctrl+C to test Emergency Shutdown.")
@@ -211,13 +217,20 @@ class HOCSSafetyMonitor:
         while self.is_armed:
             try:
                 # Simulate Sensor Reading
-                temp = 45.0 + (random.random() * 5.0)
+                temp = temperature_sensor() if temperature_sensor else 45.0 + (random.random() * 5.0)
                 voltage = 12.0 + (random.random() * 0.1)
                 
                 # Check Thresholds
-                if temp > MAX_TEMP_THRESHOLD:
+                if temp is not None and temp > MAX_TEMP_THRESHOLD:
                     logging.critical(f"OVERHEAT DETECTED: {temp:.2f}C")
                     self.execute_shutdown_sequence("THERMAL RUNAWAY")
+                elif temp is not None and temp > SOFT_TEMP_THRESHOLD:
+                    if self.status != "THROTTLED":
+                        logging.warning(f"THERMAL THROTTLING: {temp:.2f}C, scheduler shedding load")
+                        self.status = "THROTTLED"
+                elif self.status == "THROTTLED":
+                    logging.info(f"Thermal headroom restored: {temp}C")
+                    self.status = "NOMINAL"
                     
                 if voltage > MAX_VOLTAGE_THRESHOLD:
                     logging.critical(f"OVERVOLTAGE DETECTED: {voltage:.2f}V")
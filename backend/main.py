@@ -11,7 +11,7 @@ Description:
 Usage: uvicorn main:app --host 0.0.0.0 --port 8000 --reload
 """
 
-from fastapi import FastAPI, HTTPException, BackgroundTasks, UploadFile
+from fastapi import FastAPI, HTTPException, BackgroundTasks, UploadFile, Request, Response
 from pydantic import BaseModel
 import numpy as np
 import time
@@ -19,7 +19,9 @@ import asyncio
 from typing import List, Optional
 
 # Import our custom heavy driver
-from hocs_axi_driver import HOCSDriverEngine
+from hocs_axi_driver import HOCSThermalOverload
+from hocs_device_pool import HOCSDevicePool
+from hocs_batcher import HOCSRequestBatcher, HOCSWeightsRegistry
 
 # --- APP INITIALIZATION ---
 app = FastAPI(
@@ -29,8 +31,19 @@ app = FastAPI(
     docs_url="/docs"
 )
 
-# Initialize Driver in Simulation Mode by default (Safety First)
-driver = HOCSDriverEngine(simulation_mode=True)
+# Initialize Devices in Simulation Mode by default (Safety First): one per
+# `devices` entry of config/system_config.yaml, GEMMs sharded across them
+pool = HOCSDevicePool.from_config(simulation_mode=True)
+driver = pool.devices[0]  # Telemetry and maintenance
+
+# Concurrent propagations against the same weights share one dispatch
+batcher = HOCSRequestBatcher.from_config(pool)
+weights_registry = HOCSWeightsRegistry.from_config()  # LRU, capped per worker
+
+# Binary bodies (shape in X-HOCS-Rows / X-HOCS-Cols, row-major, little endian)
+RAW_F32_MEDIA = "application/octet-stream"
+Q4_12_MEDIA   = "application/x-hocs-q4.12"  # int16, 12 fractional bits
+Q4_12_ONE     = 4096
 
 # --- DATA MODELS ---
 class MatrixInput(BaseModel):
@@ -43,6 +56,35 @@ class StressTestConfig(BaseModel):
     iterations: int = 5
     turbo_mode: bool = False
 
+async def read_matrix(request: Request):
+    """
+    Request body as a float32 matrix: JSON MatrixInput, raw float32 or
+    Q4.12. Binary bodies skip JSON decoding of every element.
+    """
+    media = request.headers.get("content-type", "").split(";")[0].strip()
+    if media in (RAW_F32_MEDIA, Q4_12_MEDIA):
+        try:
+            rows, cols = int(request.headers["x-hocs-rows"]), int(request.headers["x-hocs-cols"])
+        except (KeyError, ValueError):
+            raise HTTPException(status_code=400, detail="Binary bodies need X-HOCS-Rows and X-HOCS-Cols")
+        dtype = np.dtype("<f4") if media == RAW_F32_MEDIA else np.dtype("<i2")
+        body = await request.body()
+        if rows <= 0 or cols <= 0 or len(body) != rows * cols * dtype.itemsize:
+            raise HTTPException(status_code=400, detail=f"Body is {len(body)} bytes, expected {rows}x{cols} {dtype}")
+        values = np.frombuffer(body, dtype=dtype).reshape(rows, cols)
+        if media == Q4_12_MEDIA:
+            return values.astype(np.float32) * np.float32(1.0 / Q4_12_ONE)
+        return values.astype(np.float32)
+
+    try:
+        matrix = MatrixInput(**(await request.json()))
+        values = np.array(matrix.data, dtype=np.float32)
+    except Exception as e:
+        raise HTTPException(status_code=422, detail=f"Invalid matrix body: {e}")
+    if values.shape != (matrix.rows, matrix.cols):
+        raise HTTPException(status_code=422, detail=f"data is {values.shape}, declared {matrix.rows}x{matrix.cols}")
+    return values
+
 # --- SYSTEM MONITORING ---
 @app.on_event("startup")
 async def startup_event():
@@ -63,10 +105,18 @@ async def startup_event():
 async def root():
     return {"message": "HOCS System Online", "telemetry": driver.get_telemetry()}
 
+@app.get("/status")
 @app.get("/system/status")
 async def get_system_status():
-    """Returns detailed FPGA and CPU telemetry."""
+    """
+    Returns detailed FPGA and CPU telemetry: REG_TEMP and the per-stage
+    latency histograms (quantize, DMA submit, IRQ, readback, dequantize).
+    """
     telemetry = driver.get_telemetry()
+    telemetry["latency"] = driver.get_latency_histograms()
+    telemetry["device_pool"] = pool.stats()
+    telemetry["batching"] = batcher.stats()
+    telemetry["weights_registry"] = weights_registry.stats()
     # Add fake complex data
     telemetry["optical_link_stability"] = "99.8%"
     telemetry["dac_resolution"] = "12-bit"
@@ -84,9 +134,13 @@ async def load_bitstream(file: UploadFile):
         with open(filename, "wb") as f:
             f.write(contents)
         
-        # Reload driver with new hardware logic
-        global driver
-        driver = HOCSDriverEngine(bitstream_path=filename, simulation_mode=False)
+        # Reload every device with new hardware logic; a failed reload keeps the old pool
+        global pool, driver
+        new_pool = HOCSDevicePool.from_config(simulation_mode=False, bitstream_path=filename)
+        old_pool, pool = pool, new_pool
+        driver = pool.devices[0]
+        batcher.pool = pool
+        old_pool.close()
         return {"status": "success", "message": f"FPGA Reconfigured with {file.filename}"}
     except Exception as e:
         raise HTTPException(status_code=500, detail=str(e))
@@ -94,12 +148,18 @@ async def load_bitstream(file: UploadFile):
 @app.post("/compute/tensor_op")
 async def process_tensor(matrix: MatrixInput):
     """
-    Offloads a Matrix Multiplication task to the Optical Core.
+    Offloads a Matrix Multiplication task to the Optical Cores, sharded by
+    tile row across the device pool.
     """
     input_np = np.array(matrix.data, dtype=np.float32)
     
     start_time = time.time()
-    result = await driver.process_tensor_async(input_np)
+    try:
+        result = await pool.gemm_async(input_np, input_np.T)
+    except HOCSThermalOverload as e:
+        # Load shed below the SCRAM threshold: the client backs off and retries
+        raise HTTPException(status_code=503, detail=str(e),
+                            headers={"Retry-After": str(max(1, round(e.retry_after)))})
     end_time = time.time()
     
     return {
@@ -107,7 +167,64 @@ async def process_tensor(matrix: MatrixInput):
         "latency_ms": (end_time - start_time) * 1000,
         "result_shape": result.shape,
         "result_sample": result[:2, :2].tolist(), # Preview only
-        "compute_unit": "OPTICAL_CORE" if not driver.simulation_mode else "CPU_SIMULATION"
+        "compute_unit": "OPTICAL_CORE" if not driver.simulation_mode else "CPU_SIMULATION",
+        "devices": len(pool)
+    }
+
+@app.post("/compute/weights")
+async def register_weights(request: Request):
+    """
+    Registers an M x K weight matrix (JSON, raw float32 or Q4.12 body) for
+    /compute/propagate. The id is derived from the contents, so clients
+    registering the same weights share one batch. Least recently used
+    sets are evicted once the registry is full (propagate then 404s and
+    the client registers again).
+    """
+    weights = await read_matrix(request)
+    try:
+        weights_id = weights_registry.add(weights)
+    except ValueError as e:
+        raise HTTPException(status_code=413, detail=str(e))
+    return {"weights_id": weights_id, "shape": weights.shape}
+
+@app.delete("/compute/weights/{weights_id}")
+async def delete_weights(weights_id: str):
+    """Unregisters a weight set; propagations already batched still complete."""
+    if not weights_registry.remove(weights_id):
+        raise HTTPException(status_code=404, detail=f"Unknown weights_id {weights_id}")
+    return {"weights_id": weights_id, "deleted": True}
+
+@app.post("/compute/propagate/{weights_id}")
+async def propagate(weights_id: str, request: Request):
+    """
+    weights @ voltages for K x B voltages (JSON, raw float32 or Q4.12 body).
+    Concurrent requests for the same weights are coalesced into one batched
+    propagate. `Accept: application/octet-stream` returns the M x B result
+    as raw float32 instead of JSON.
+    """
+    weights = weights_registry.get(weights_id)
+    if weights is None:
+        raise HTTPException(status_code=404, detail=f"Unknown weights_id {weights_id}")
+    voltages = await read_matrix(request)
+
+    start_time = time.time()
+    try:
+        result = await batcher.propagate(weights_id, weights, voltages)
+    except ValueError as e:
+        raise HTTPException(status_code=422, detail=str(e))
+    except HOCSThermalOverload as e:
+        raise HTTPException(status_code=503, detail=str(e),
+                            headers={"Retry-After": str(max(1, round(e.retry_after)))})
+    end_time = time.time()
+
+    if RAW_F32_MEDIA in request.headers.get("accept", ""):
+        return Response(content=np.ascontiguousarray(result, dtype="<f4").tobytes(), media_type=RAW_F32_MEDIA,
+                        headers={"X-HOCS-Rows": str(result.shape[0]), "X-HOCS-Cols": str(result.shape[1])})
+    return {
+        "status": "completed",
+        "latency_ms": (end_time - start_time) * 1000,
+        "result_shape": result.shape,
+        "result": result.tolist(),
     }
 
 @app.post("/maintenance/stress_test")
@@ -8,17 +8,34 @@ Description:
     into HOCS Optical Assembly instructions (HOCS-ASM).
     
     Features:
-    - Automatic Operator Fusion (Conv2d + ReLU -> OptConv)
+    - Automatic Operator Fusion (Conv2d/Linear + ReLU, on-chip activations)
+    - Packed binary HOCS-ASM for the native runtime (cpp_core/hocs_isa.hpp)
     - Weight Quantization (Float32 -> 12-bit Analog DAC values)
     - Memory Layout Optimization for Crossbar Arrays
+    - Weight Residency: tiles already programmed into a crossbar region
+      skip CONFIG_XBAR (LRU with pinning, cpp_core/hocs_residency.hpp)
 """
 
+import ctypes
+import hashlib
+import os
+import struct
+from collections import OrderedDict
+from dataclasses import dataclass
+
 import torch
 import torch.nn as nn
 import numpy as np
 import logging
 from typing import List, Dict, Any
 
+HOCS_TILE_DIM     = 128  # Crossbar tile edge (cpp_core/hocs_tiler.hpp)
+HOCS_XBAR_REGIONS = 64   # Crossbar regions a tile can be programmed into
+HOCS_MAX_PAYLOAD_BYTES = 4 * 1024 * 1024  # ICD limit per DMA transaction
+NATIVE_ENGINE_LIB = os.environ.get(
+    "HOCS_ENGINE_LIB",
+    os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "cpp_core", "libhocs_engine.so"))
+
 # Setup Compiler Logging
 logging.basicConfig(level=logging.INFO, format='[HOCS-COMPILER] %(message)s')
 
@@ -44,65 +61,388 @@ class HOCSOptimizer:
         w_quant = np.round(w * scale)
         return w_quant.astype(np.int16)
 
+class HOCSResidencyStats(ctypes.Structure):
+    _fields_ = [("hits", ctypes.c_uint64), ("misses", ctypes.c_uint64), ("evictions", ctypes.c_uint64),
+                ("regions", ctypes.c_uint32), ("resident", ctypes.c_uint32), ("pinned", ctypes.c_uint32),
+                ("reserved", ctypes.c_uint32)]
+
+class HOCSResidencyMap:
+    """
+    Which weight tile is programmed into which crossbar region. Backed by the
+    native residency cache when libhocs_engine.so is available, otherwise by
+    an equivalent LRU here. Keys are content hashes, so they are stable
+    across processes and change whenever the weights do.
+    """
+    _lib = None
+
+    @classmethod
+    def load_library(cls, path=NATIVE_ENGINE_LIB):
+        if cls._lib is None:
+            try:
+                lib = ctypes.CDLL(path)
+            except OSError:
+                return None
+            lib.hocs_residency_create.restype = ctypes.c_void_p
+            lib.hocs_residency_create.argtypes = [ctypes.c_int]
+            lib.hocs_residency_destroy.argtypes = [ctypes.c_void_p]
+            lib.hocs_residency_acquire.argtypes = [
+                ctypes.c_void_p, ctypes.c_uint64, ctypes.c_int, ctypes.POINTER(ctypes.c_int)]
+            lib.hocs_residency_unpin.argtypes = [ctypes.c_void_p, ctypes.c_uint64]
+            lib.hocs_residency_reset.argtypes = [ctypes.c_void_p]
+            lib.hocs_residency_stats.argtypes = [ctypes.c_void_p, ctypes.POINTER(HOCSResidencyStats)]
+            lib.hocs_engine_last_error.restype = ctypes.c_char_p
+            cls._lib = lib
+        return cls._lib
+
+    def __init__(self, regions=HOCS_XBAR_REGIONS):
+        self.handle = None
+        self.regions = regions
+        self.lib = self.load_library()
+        if self.lib is not None:
+            self.handle = self.lib.hocs_residency_create(regions)
+            if not self.handle:
+                raise ValueError(self.lib.hocs_engine_last_error().decode(errors="replace"))
+        elif regions <= 0:
+            raise ValueError("HOCSResidencyMap: region count must be positive")
+        # Fallback state: key -> region in LRU order, pin counts, free regions
+        self._lru = OrderedDict()
+        self._pins = {}
+        self._free = list(range(regions - 1, -1, -1))
+        self._counters = {"hits": 0, "misses": 0, "evictions": 0}
+
+    def __del__(self):
+        if self.handle:
+            self.lib.hocs_residency_destroy(self.handle)
+            self.handle = None
+
+    @staticmethod
+    def tile_key(tile: np.ndarray) -> int:
+        """Stable 64-bit key of a quantized tile (shape and contents)."""
+        digest = hashlib.blake2b(digest_size=8)
+        digest.update(np.asarray(tile.shape, dtype=np.int64).tobytes())
+        digest.update(np.ascontiguousarray(tile).tobytes())
+        return int.from_bytes(digest.digest(), "little")
+
+    def acquire(self, key, pin=False):
+        """(region, resident). resident False: program the region now."""
+        if self.handle:
+            region = ctypes.c_int(-1)
+            status = self.lib.hocs_residency_acquire(self.handle, key, int(pin), ctypes.byref(region))
+            if status < 0:
+                raise RuntimeError(self.lib.hocs_engine_last_error().decode(errors="replace"))
+            return region.value, status == 1
+
+        if key in self._pins or key in self._lru:
+            self._counters["hits"] += 1
+            if key in self._pins:
+                region = self._pins[key][0]
+            else:
+                self._lru.move_to_end(key)
+                region = self._lru[key]
+            if pin:
+                self._pin(key, region)
+            return region, True
+
+        if self._free:
+            region = self._free.pop()
+        elif self._lru:
+            _, region = self._lru.popitem(last=False)
+            self._counters["evictions"] += 1
+        else:
+            raise RuntimeError("HOCSResidencyMap: every crossbar region is pinned")
+        self._counters["misses"] += 1
+        if pin:
+            self._pin(key, region)
+        else:
+            self._lru[key] = region
+        return region, False
+
+    def _pin(self, key, region):
+        # Pinned keys leave the LRU order; _pins holds (region, count)
+        self._lru.pop(key, None)
+        _, count = self._pins.get(key, (region, 0))
+        self._pins[key] = (region, count + 1)
+
+    def unpin(self, key):
+        if self.handle:
+            return self.lib.hocs_residency_unpin(self.handle, key) == 0
+        if key not in self._pins:
+            return False
+        region, count = self._pins.pop(key)
+        if count > 1:
+            self._pins[key] = (region, count - 1)
+        else:
+            self._lru[key] = region
+        return True
+
+    def reset(self):
+        """Forgets every tile, e.g. after the optical core was reset."""
+        if self.handle:
+            self.lib.hocs_residency_reset(self.handle)
+            return
+        self._lru.clear()
+        self._pins.clear()
+        self._free = list(range(self.regions - 1, -1, -1))
+
+    def stats(self) -> Dict[str, int]:
+        if self.handle:
+            raw = HOCSResidencyStats()
+            self.lib.hocs_residency_stats(self.handle, ctypes.byref(raw))
+            return {name: getattr(raw, name) for name, _ in HOCSResidencyStats._fields_ if name != "reserved"}
+        stats = dict(self._counters)
+        stats.update(regions=self.regions, resident=len(self._lru) + len(self._pins), pinned=len(self._pins))
+        return stats
+
+# Binary HOCS-ASM (cpp_core/hocs_isa.hpp): 16-byte header, 16-byte instructions
+HOCS_ASM_MAGIC   = b"HASM"
+HOCS_ASM_VERSION = 1
+HOCS_ASM_HEADER  = struct.Struct("<4sHHII")  # magic, version, instruction bytes, count, host buffers
+HOCS_ASM_INSN    = struct.Struct("<BBBBIII")  # opcode, flags, dst, src, operand, arg0, arg1
+HOCS_OPCODES = {
+    "NOP": 0x00, "INIT_CORE": 0x01, "LOAD_DMA": 0x02, "STORE_DMA": 0x03, "CONFIG_XBAR": 0x04,
+    "OPT_MATMUL": 0x05, "OPT_CONV": 0x06, "IM2COL": 0x07, "V_RELU": 0x08, "CONV_SHAPE": 0x09,
+    "HALT": 0xFF,
+}
+HOCS_INSN_RELU       = 1 << 0  # Fused ReLU once the instruction completes dst
+HOCS_INSN_ACCUMULATE = 1 << 1  # Add into dst (later tiles of an output band)
+HOCS_INSN_12BIT      = 1 << 2  # CONFIG_XBAR with 12-bit DAC levels
+HOCS_INSN_IMPLICIT   = 1 << 3  # OPT_CONV reads the raw feature map (patches formed on chip)
+
+# CONV_SHAPE field widths: operand = C | D << 16, arg0 = H << 16 | W,
+# arg1 = KH | KW << 8 | S << 16 | P << 24
+HOCS_CONV_FIELD_BITS = {"channels": 16, "dilation": 16, "height": 16, "width": 16,
+                        "kernel_h": 8, "kernel_w": 8, "stride": 8, "padding": 8}
+
+@dataclass
+class HOCSFusedOp:
+    """One node after fusion: a crossbar layer (with optional ReLU) or a lone ReLU."""
+    kind: str           # "dense", "conv" or "relu"
+    name: str
+    layer: Any = None
+    relu: bool = False  # Linear/Conv2d + ReLU -> a single instruction group
+
 class HOCSGraphTracer:
     """
     Traces the execution flow of a PyTorch model and generates
     HOCS-ASM (Assembly) code.
+
+    A fusion pass folds each ReLU into the preceding Linear/Conv2d and keeps
+    activations in on-chip vector registers between consecutive layers: the
+    program loads the input once and stores the output once. compile()
+    returns the text listing; encode() returns the packed binary image.
+
+    Conv2d is lowered as an implicit GEMM by default: a CONV_SHAPE carries
+    the geometry and OPT_CONV forms patches per tile from the raw feature
+    map, so no kernel_size^2 larger IM2COL matrix is transferred.
+    implicit_conv=False restores the IM2COL lowering.
     """
-    def __init__(self, model: nn.Module):
+    def __init__(self, model: nn.Module, residency: HOCSResidencyMap = None, pinned_layers=(),
+                 implicit_conv=True):
         self.model = model
         self.instruction_buffer = []
+        self.program = []  # Encoded instructions, in step with instruction_buffer
+        self.host_buffers = []  # Symbol table: host buffer index -> name
         self.memory_map = {}
         self.optimizer = HOCSOptimizer()
+        # Shared across compile() runs (and tracers): resident tiles are not reprogrammed
+        self.residency = residency if residency is not None else HOCSResidencyMap()
+        self.pinned_layers = set(pinned_layers)
+        self.pinned_tiles = set()  # Tile keys this tracer holds one pin on in self.residency
+        self.implicit_conv = implicit_conv
+        self.shape = None  # Activation shape while tracing: (C, H, W) or (features,)
 
-    def _emit(self, opcode, *args):
-        instr = f"{opcode:<10} " + ", ".join(map(str, args))
+    def _emit(self, opcode, *args, flags=0, dst=0, src=0, operand=0, arg0=0, arg1=0):
+        # Directives (SECTION, LABEL, COMMENT, ...) exist only in the text listing
+        text_args = list(map(str, args))
+        if flags & HOCS_INSN_ACCUMULATE:
+            text_args.append("ACC")
+        if flags & HOCS_INSN_RELU:
+            text_args.append("RELU")
+        instr = f"{opcode:<10} " + ", ".join(text_args)
         self.instruction_buffer.append(instr)
+        if opcode in HOCS_OPCODES:
+            self.program.append(HOCS_ASM_INSN.pack(HOCS_OPCODES[opcode], flags, dst, src, operand, arg0, arg1))
+
+    def _host_buffer(self, symbol):
+        if symbol not in self.host_buffers:
+            self.host_buffers.append(symbol)
+        return self.host_buffers.index(symbol)
+
+    def _fuse(self) -> List[HOCSFusedOp]:
+        ops = []
+        for name, layer in self.model.named_modules():
+            if isinstance(layer, nn.Linear):
+                ops.append(HOCSFusedOp("dense", name, layer))
+            elif isinstance(layer, nn.Conv2d):
+                ops.append(HOCSFusedOp("conv", name, layer))
+            elif isinstance(layer, nn.ReLU):
+                if ops and ops[-1].kind != "relu" and not ops[-1].relu:
+                    ops[-1].relu = True
+                else:
+                    ops.append(HOCSFusedOp("relu", name))
+        return ops
 
     def compile(self, input_shape=(1, 3, 224, 224)):
         logging.info("Starting Compilation Trace...")
+        self.instruction_buffer = []
+        self.program = []
+        self.host_buffers = []
+        self.shape = tuple(input_shape[1:])
+        self._compiled_pins = set()
         self._emit("SECTION", ".text")
         self._emit("GLOBAL", "_start")
         self._emit("LABEL", "_start")
         self._emit("INIT_CORE", "0") # Wake up Optical Core
 
-        # Iterate through named modules (Simulating a Graph Walk)
-        for name, layer in self.model.named_modules():
-            if isinstance(layer, nn.Linear):
-                logging.info(f"-> Compiling Dense Layer: {name} | Shape: {layer.weight.shape}")
-                self._compile_dense(name, layer)
-            
-            elif isinstance(layer, nn.Conv2d):
-                logging.info(f"-> Compiling Conv2d Layer: {name} | Kernel: {layer.kernel_size}")
-                self._compile_conv(name, layer)
-                
-            elif isinstance(layer, nn.ReLU):
-                self._emit("V_RELU", "v0", "v0") # Vector ReLU in optical domain
+        ops = self._fuse()
+        fused = sum(op.relu for op in ops)
+        logging.info(f"Fusion: {len(ops)} ops, {fused} ReLU folded into crossbar layers")
+
+        # Activations ping-pong between v1 and v2 and never leave the chip
+        # between layers; v3 holds IM2COL patches
+        act = 1
+        if ops:
+            first = self._host_buffer(f"HOST_RAM_{ops[0].name}")
+            self._emit("LOAD_DMA", f"v{act}", f"HOST_RAM_{ops[0].name}", dst=act, operand=first)
+        for op in ops:
+            if op.kind == "dense":
+                logging.info(f"-> Compiling Dense Layer: {op.name} | Shape: {op.layer.weight.shape}"
+                             f"{' + ReLU' if op.relu else ''}")
+                act = self._compile_dense(op, act)
+            elif op.kind == "conv":
+                logging.info(f"-> Compiling Conv2d Layer: {op.name} | Kernel: {op.layer.kernel_size}"
+                             f"{' + ReLU' if op.relu else ''}")
+                act = self._compile_conv(op, act)
+            else:
+                self._emit("V_RELU", f"v{act}", f"v{act}", dst=act, src=act) # Vector ReLU in optical domain
+        if ops:
+            out = self._host_buffer("OUT_BUFFER")
+            self._emit("STORE_DMA", f"v{act}", "OUT_BUFFER", src=act, operand=out)
 
         self._emit("HALT", "0")
+        # Pins of tiles this program no longer uses (weights changed, layer unpinned)
+        for key in self.pinned_tiles - self._compiled_pins:
+            self.residency.unpin(key)
+        self.pinned_tiles = self._compiled_pins
+        stats = self.residency.stats()
+        logging.info(f"Crossbar residency: {stats['hits']} hits, {stats['misses']} misses, "
+                     f"{stats['evictions']} evictions ({stats['resident']}/{stats['regions']} regions resident)")
         logging.info("Compilation Finished. Generating Binary...")
         return "\n".join(self.instruction_buffer)
 
-    def _compile_dense(self, name, layer):
+    def release(self):
+        """Drops every pin this tracer holds, e.g. before the model is retired."""
+        for key in self.pinned_tiles:
+            self.residency.unpin(key)
+        self.pinned_tiles = set()
+
+    def encode(self) -> bytes:
+        """Packed HOCS-ASM image of the last compile(); names in self.host_buffers."""
+        header = HOCS_ASM_HEADER.pack(HOCS_ASM_MAGIC, HOCS_ASM_VERSION, HOCS_ASM_INSN.size,
+                                      len(self.program), len(self.host_buffers))
+        return header + b"".join(self.program)
+
+    def _program_tiles(self, op, q_weights, matmul, src, dst, flags=0):
+        # One crossbar region per 128x128 tile, reused as is while the same
+        # tile is still programmed there. Tiles of a row band accumulate.
+        # A pinned layer pins each tile once per tracer, however often it is
+        # recompiled; release() (or a recompile not using the tile) unpins.
+        weights = self._host_buffer(f"WEIGHTS_{op.name}")
+        pin = op.name in self.pinned_layers
+        addresses = []
+        rows, cols = q_weights.shape
+        grid_rows = -(-rows // HOCS_TILE_DIM)
+        grid_cols = -(-cols // HOCS_TILE_DIM)
+        for tile_row in range(grid_rows):
+            for tile_col in range(grid_cols):
+                row0, col0 = tile_row * HOCS_TILE_DIM, tile_col * HOCS_TILE_DIM
+                tile = q_weights[row0:row0 + HOCS_TILE_DIM, col0:col0 + HOCS_TILE_DIM]
+                key = HOCSResidencyMap.tile_key(tile)
+                region, resident = self.residency.acquire(key, pin=pin and key not in self.pinned_tiles)
+                if pin:
+                    self.pinned_tiles.add(key)
+                    self._compiled_pins.add(key)
+                mem_addr = f"0x{region:04X}"
+                addresses.append(mem_addr)
+                tile_id = tile_row * grid_cols + tile_col
+
+                if not resident:
+                    self._emit("CONFIG_XBAR", mem_addr, "12_BIT", f"WEIGHTS_{op.name}", tile_id,
+                               flags=HOCS_INSN_12BIT, operand=region, arg0=weights, arg1=tile_id)
+                tile_flags = flags | (HOCS_INSN_ACCUMULATE if tile_col else 0)
+                if op.relu and tile_id == grid_rows * grid_cols - 1:
+                    tile_flags |= HOCS_INSN_RELU
+                self._emit(matmul, f"v{dst}", f"v{src}", mem_addr, flags=tile_flags, dst=dst, src=src,
+                           operand=region, arg0=tile_row, arg1=tile_col) # The Heavy Operation
+        self.memory_map[op.name] = addresses
+
+    def _compile_dense(self, op, act):
         # 1. Quantize Weights
-        q_weights = self.optimizer.quantize_weights(layer.weight)
-        
-        # 2. Allocate Optical Memory
-        mem_addr = f"0x{hash(name) & 0xFFFF:04X}"
-        self.memory_map[name] = mem_addr
-        
-        # 3. Emit Assembly Instructions
-        self._emit("COMMENT", f"--- Layer: {name} ---")
-        self._emit("LOAD_DMA", "v1", f"HOST_RAM_{name}")
-        self._emit("CONFIG_XBAR", mem_addr, "12_BIT") # Configure Crossbar
-        self._emit("OPT_MATMUL", "v2", "v1", mem_addr) # The Heavy Operation
-        self._emit("STORE_DMA", "v2", "OUT_BUFFER")
-
-    def _compile_conv(self, name, layer):
-        # Convolution on Optical Chip is done via Toeplitz Matrix conversion
-        self._emit("COMMENT", f"--- Layer: {name} (Conv2d) ---")
-        self._emit("IM2COL", "v1", "v0", f"{layer.kernel_size[0]}")
-        self._emit("OPT_CONV", "v2", "v1", "KERNEL_ADDR")
+        q_weights = self.optimizer.quantize_weights(op.layer.weight)
+
+        # 2. Allocate Optical Memory and 3. Emit Assembly Instructions
+        self._emit("COMMENT", f"--- Layer: {op.name} ---")
+        out = 3 - act
+        self._program_tiles(op, q_weights, "OPT_MATMUL", act, out)
+        self.shape = (q_weights.shape[0],)
+        return out
+
+    @staticmethod
+    def _conv_params(op):
+        """(stride, padding, dilation) of a Conv2d; one value per field, as CONV_SHAPE carries."""
+        layer = op.layer
+        if isinstance(layer.padding, str):
+            raise ValueError(f"Conv2d '{op.name}': padding='{layer.padding}' is not supported, use integers")
+        if layer.groups != 1:
+            raise ValueError(f"Conv2d '{op.name}': grouped convolution (groups={layer.groups}) is not supported")
+        params = []
+        for field in ("stride", "padding", "dilation"):
+            values = tuple(getattr(layer, field))
+            if len(set(values)) != 1:
+                raise ValueError(f"Conv2d '{op.name}': asymmetric {field} {values} is not supported")
+            params.append(values[0])
+        return tuple(params)
+
+    @staticmethod
+    def _check_conv_fields(op, **fields):
+        for field, value in fields.items():
+            limit = (1 << HOCS_CONV_FIELD_BITS[field]) - 1
+            if not 0 <= value <= limit:
+                raise ValueError(f"Conv2d '{op.name}': {field} {value} does not fit CONV_SHAPE (max {limit})")
+
+    def _compile_conv(self, op, act):
+        # Convolution on Optical Chip is a GEMM with the (out, in * kh * kw)
+        # kernel matrix, over patches formed on chip (implicit) or by IM2COL
+        q_weights = self.optimizer.quantize_weights(op.layer.weight)
+        q_weights = q_weights.reshape(q_weights.shape[0], -1)
+        if self.shape is None or len(self.shape) != 3:
+            raise ValueError(f"Conv2d '{op.name}' needs a (C, H, W) input, traced shape is {self.shape}")
+        channels, height, width = self.shape
+        kh, kw = op.layer.kernel_size
+        stride, padding, dilation = self._conv_params(op)
+        out_h = (height + 2 * padding - dilation * (kh - 1) - 1) // stride + 1
+        out_w = (width + 2 * padding - dilation * (kw - 1) - 1) // stride + 1
+        if out_h <= 0 or out_w <= 0:
+            raise ValueError(f"Conv2d '{op.name}': kernel does not fit the {height}x{width} input")
+
+        self._emit("COMMENT", f"--- Layer: {op.name} (Conv2d) ---")
+        out = 3 - act
+        if self.implicit_conv:
+            self._check_conv_fields(op, channels=channels, dilation=dilation, height=height, width=width,
+                                    kernel_h=kh, kernel_w=kw, stride=stride, padding=padding)
+            self._emit("CONV_SHAPE", f"v{act}", f"{channels}x{height}x{width}",
+                       f"k{kh}x{kw} s{stride} p{padding} d{dilation}", src=act,
+                       operand=channels | dilation << 16, arg0=height << 16 | width,
+                       arg1=kh | kw << 8 | stride << 16 | padding << 24)
+            self._program_tiles(op, q_weights, "OPT_CONV", act, out, flags=HOCS_INSN_IMPLICIT)
+        else:
+            patch_bytes = q_weights.shape[1] * out_h * out_w * 2  # int16 IM2COL matrix
+            if patch_bytes > HOCS_MAX_PAYLOAD_BYTES:
+                logging.warning(f"IM2COL of '{op.name}' is {patch_bytes >> 20} MB, above the 4 MB DMA payload")
+            self._emit("IM2COL", "v3", f"v{act}", f"{kh}", dst=3, src=act, operand=kh)
+            self._program_tiles(op, q_weights, "OPT_CONV", 3, out)
+        self.shape = (q_weights.shape[0], out_h, out_w)
+        return out
 
 # --- USAGE EXAMPLE ---
 if __name__ == "__main__":
@@ -122,9 +462,12 @@ if __name__ == "__main__":
 
     compiler = HOCSGraphTracer(net)
     assembly_code = compiler.compile()
+    binary = compiler.encode()
     
     print("\n[GENERATED ASSEMBLY CODE PREVIEW]:")
     print("-----------------------------------")
     print(assembly_code)
     print("-----------------------------------")
+    print(f"[BINARY] {len(binary)} bytes, {len(compiler.program)} instructions, "
+          f"host buffers: {compiler.host_buffers}")
       
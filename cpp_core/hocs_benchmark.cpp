@@ -0,0 +1,154 @@
+/*
+ * HOCS NATIVE ENGINE BENCHMARK SUITE
+ * ==================================
+ * Description:
+ * Standalone benchmark target for the CuO crossbar engine. Sweeps matrix size,
+ * batch width, thread count and kernel variant, prints a summary table and
+ * writes machine-readable JSON for CI regression tracking and node sizing.
+ *
+ * Build: g++ -std=c++17 -O3 -fopenmp -o cpp_core/hocs_bench cpp_core/hocs_benchmark.cpp
+ *        (add -DHOCS_NEON_ASM asm/hocs_vector_ops.s on AArch64 for the NEON kernels)
+ * Usage: hocs_bench --sizes 256,1024,4096 --batches 1,32,256 --threads 1,4
+ *                   --variants scalar,simd,blocked --precisions f64,f32,q12
+ *                   --iters 20 [--tiled] --json bench.json
+ */
+
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "hocs_benchmark.hpp"
+
+static std::vector<std::string> split_list(const std::string& arg) {
+    std::vector<std::string> items;
+    std::stringstream ss(arg);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        if (!item.empty()) items.push_back(item);
+    }
+    return items;
+}
+
+static std::vector<int> parse_int_list(const std::string& arg) {
+    std::vector<int> values;
+    for (const std::string& item : split_list(arg)) values.push_back(std::atoi(item.c_str()));
+    return values;
+}
+
+static void print_usage(const char* prog) {
+    std::cerr << "Usage: " << prog << " [options]\n"
+              << "  --sizes    N1,N2,...     Crossbar dimensions (default 256,1024)\n"
+              << "  --batches  B1,B2,...     Batch widths (default 1,32)\n"
+              << "  --threads  T1,T2,...     OpenMP thread counts, 0 = default (default 0)\n"
+              << "  --variants v1,v2,...     scalar, simd, blocked (default all)\n"
+              << "  --precisions p1,p2,...   f64, f32, q12 (default f64)\n"
+              << "  --warmup   W             Warmup iterations (default 3)\n"
+              << "  --iters    I             Timed iterations (default 20)\n"
+              << "  --fast-exp               Use hocs_fast_exp for the thermal factor\n"
+              << "  --tiled                  Run each size as a grid of 128x128 crossbar tiles\n"
+              << "  --quick                  Small CI sweep (sizes 128,256, batches 1,8)\n"
+              << "  --json     PATH          JSON output file (default hocs_bench.json)\n";
+}
+
+int main(int argc, char** argv) {
+    std::vector<int> sizes = {256, 1024};
+    std::vector<int> batches = {1, 32};
+    std::vector<int> threads = {0};
+    std::vector<KernelVariant> variants = {KernelVariant::Scalar, KernelVariant::Simd, KernelVariant::Blocked};
+    std::vector<ElementPrecision> precisions = {ElementPrecision::F64};
+    int warmup = 3;
+    int iters = 20;
+    bool fast_exp = false;
+    bool tiled = false;
+    std::string json_path = "hocs_bench.json";
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool has_value = (i + 1 < argc);
+
+        if (arg == "--sizes" && has_value) {
+            sizes = parse_int_list(argv[++i]);
+        } else if (arg == "--batches" && has_value) {
+            batches = parse_int_list(argv[++i]);
+        } else if (arg == "--threads" && has_value) {
+            threads = parse_int_list(argv[++i]);
+        } else if (arg == "--variants" && has_value) {
+            variants.clear();
+            for (const std::string& name : split_list(argv[++i])) {
+                KernelVariant v;
+                if (!parse_kernel_variant(name, v)) {
+                    std::cerr << "[BENCH] Unknown kernel variant: " << name << std::endl;
+                    return 1;
+                }
+                variants.push_back(v);
+            }
+        } else if (arg == "--precisions" && has_value) {
+            precisions.clear();
+            for (const std::string& name : split_list(argv[++i])) {
+                ElementPrecision p;
+                if (!parse_precision(name, p)) {
+                    std::cerr << "[BENCH] Unknown precision: " << name << std::endl;
+                    return 1;
+                }
+                precisions.push_back(p);
+            }
+        } else if (arg == "--warmup" && has_value) {
+            warmup = std::atoi(argv[++i]);
+        } else if (arg == "--iters" && has_value) {
+            iters = std::atoi(argv[++i]);
+        } else if (arg == "--fast-exp") {
+            fast_exp = true;
+        } else if (arg == "--tiled") {
+            tiled = true;
+        } else if (arg == "--quick") {
+            sizes = {128, 256};
+            batches = {1, 8};
+            warmup = 1;
+            iters = 5;
+        } else if (arg == "--json" && has_value) {
+            json_path = argv[++i];
+        } else {
+            print_usage(argv[0]);
+            return (arg == "--help" || arg == "-h") ? 0 : 1;
+        }
+    }
+
+    std::vector<BenchmarkResult> results;
+    std::cout << "[BENCH] HOCS Native Engine Benchmark Suite (SIMD: " << hocs_kernels().isa << ")" << std::endl;
+
+    for (int size : sizes) {
+        for (int batch : batches) {
+            for (int thread_count : threads) {
+                for (KernelVariant variant : variants) {
+                    for (ElementPrecision precision : precisions) {
+                        BenchmarkCase config;
+                        config.matrix_size = size;
+                        config.batch_size = batch;
+                        config.threads = thread_count;
+                        config.variant = variant;
+                        config.precision = precision;
+                        config.warmup_iters = warmup;
+                        config.timed_iters = iters;
+                        config.fast_exp = fast_exp;
+                        config.tiled = tiled;
+
+                        results.push_back(run_benchmark_case(config));
+                        print_benchmark_result(std::cout, results.back());
+                    }
+                }
+            }
+        }
+    }
+
+    std::ofstream json(json_path);
+    if (!json) {
+        std::cerr << "[BENCH] Cannot write " << json_path << std::endl;
+        return 1;
+    }
+    write_benchmark_json(json, results);
+    std::cout << "[BENCH] Results written to " << json_path << std::endl;
+    return 0;
+}
@@ -0,0 +1,240 @@
+/*
+ * HOCS NATIVE ENGINE BENCHMARK HARNESS
+ * ====================================
+ * Description:
+ * Measures HOCSEngine propagation kernels with warmup, per-iteration timing,
+ * latency percentiles, effective bandwidth and MAC throughput.
+ * Used by the hocs_bench CLI (hocs_benchmark.cpp) and run_cpp_benchmark().
+ */
+
+#ifndef HOCS_BENCHMARK_HPP
+#define HOCS_BENCHMARK_HPP
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include "hocs_native_engine.hpp"
+#include "hocs_tiled_engine.hpp"
+
+// Element type of the engine under test (see hocs_element_types.hpp)
+enum class ElementPrecision { F64, F32, Q12 };
+
+struct BenchmarkCase {
+    int matrix_size = 1024;
+    int batch_size = 1;
+    int threads = 0;        // 0 = OpenMP default
+    KernelVariant variant = KernelVariant::Simd;
+    ElementPrecision precision = ElementPrecision::F64;
+    int warmup_iters = 3;
+    int timed_iters = 20;
+    bool fast_exp = false;
+    bool tiled = false;     // Run as a grid of 128x128 crossbars (HOCSTilePlan)
+};
+
+struct BenchmarkResult {
+    BenchmarkCase config;
+    int threads_used;
+    double median_us;
+    double p99_us;
+    double mean_us;
+    double min_us;
+    double mac_gflops;         // 2*N^2*B per iteration
+    double bandwidth_gbs;      // Compulsory plane + vector traffic
+    double exp_evals_per_iter; // Activation-factor refreshes (thermal exp cost)
+    double checksum;           // Keeps the optimizer honest
+};
+
+inline const char* kernel_variant_name(KernelVariant variant) {
+    switch (variant) {
+        case KernelVariant::Scalar:  return "scalar";
+        case KernelVariant::Simd:    return "simd";
+        case KernelVariant::Blocked: return "blocked";
+    }
+    return "unknown";
+}
+
+inline const char* precision_name(ElementPrecision precision) {
+    switch (precision) {
+        case ElementPrecision::F64: return ElementTraits<double>::name;
+        case ElementPrecision::F32: return ElementTraits<float>::name;
+        case ElementPrecision::Q12: return ElementTraits<Q4_12>::name;
+    }
+    return "unknown";
+}
+
+inline bool parse_precision(const std::string& name, ElementPrecision& out) {
+    if (name == "f64") { out = ElementPrecision::F64; return true; }
+    if (name == "f32") { out = ElementPrecision::F32; return true; }
+    if (name == "q12" || name == "q4.12") { out = ElementPrecision::Q12; return true; }
+    return false;
+}
+
+inline bool parse_kernel_variant(const std::string& name, KernelVariant& out) {
+    if (name == "scalar")  { out = KernelVariant::Scalar;  return true; }
+    if (name == "simd")    { out = KernelVariant::Simd;    return true; }
+    if (name == "blocked") { out = KernelVariant::Blocked; return true; }
+    return false;
+}
+
+// Nearest-rank percentile of an ascending sample set
+inline double percentile(const std::vector<double>& sorted, double pct) {
+    if (sorted.empty()) return 0.0;
+    std::size_t rank = static_cast<std::size_t>(std::ceil(pct / 100.0 * sorted.size()));
+    rank = std::min(std::max<std::size_t>(rank, 1), sorted.size());
+    return sorted[rank - 1];
+}
+
+// One iteration = B input vectors. Scalar/SIMD variants issue B GEMV passes,
+// the blocked variant issues one GEMM pass over the whole batch.
+// Engine is BasicHOCSEngine or BasicHOCSTiledEngine (same propagation API).
+template <typename Engine>
+BenchmarkResult measure_engine(Engine& engine, const BenchmarkCase& config) {
+    using Traits = typename Engine::Traits;
+    using value_type = typename Traits::storage_type;
+
+#ifdef _OPENMP
+    // Restored on return, so a threads = 0 case after an explicit one runs
+    // with the OpenMP default rather than the previous case's count
+    struct ThreadCountGuard {
+        int saved = omp_get_max_threads();
+        ~ThreadCountGuard() { omp_set_num_threads(saved); }
+    } thread_guard;
+    if (config.threads > 0) omp_set_num_threads(config.threads);
+    int threads_used = omp_get_max_threads();
+#else
+    int threads_used = 1;
+#endif
+
+    const int N = config.matrix_size;
+    const int B = config.batch_size;
+
+    engine.set_kernel_variant(config.variant);
+    engine.set_fast_exp(config.fast_exp);
+
+    // Buffers are allocated once; timed iterations do not touch the heap
+    const value_type half_volt = Traits::from_double(0.5);
+    std::vector<value_type> vector_input(N, half_volt);
+    std::vector<value_type> batch_input(static_cast<std::size_t>(N) * B, half_volt);
+    std::vector<value_type> output(static_cast<std::size_t>(N) * B);
+    double checksum = 0.0;
+
+    auto run_iteration = [&]() {
+        if (config.variant == KernelVariant::Blocked) {
+            engine.compute_optical_propagation_batch(batch_input.data(), B, output.data());
+            checksum += Traits::to_double(output[0]);
+        } else {
+            for (int b = 0; b < B; ++b) {
+                engine.compute_optical_propagation(vector_input.data(), output.data());
+                checksum += Traits::to_double(output[0]);
+            }
+        }
+    };
+
+    for (int i = 0; i < config.warmup_iters; ++i) run_iteration();
+
+    uint64_t exp_before = engine.exp_evaluations();
+    std::vector<double> samples_us;
+    samples_us.reserve(config.timed_iters);
+
+    for (int i = 0; i < config.timed_iters; ++i) {
+        auto start = std::chrono::steady_clock::now();
+        run_iteration();
+        auto end = std::chrono::steady_clock::now();
+        samples_us.push_back(std::chrono::duration<double, std::micro>(end - start).count());
+    }
+    uint64_t exp_after = engine.exp_evaluations();
+
+    std::sort(samples_us.begin(), samples_us.end());
+    double total_us = 0.0;
+    for (double t : samples_us) total_us += t;
+
+    BenchmarkResult result;
+    result.config = config;
+    result.threads_used = threads_used;
+    result.median_us = percentile(samples_us, 50.0);
+    result.p99_us = percentile(samples_us, 99.0);
+    result.mean_us = samples_us.empty() ? 0.0 : total_us / samples_us.size();
+    result.min_us = samples_us.empty() ? 0.0 : samples_us.front();
+
+    // Per pass: G_eff read, T(k) read, T(k+1) write, plus the I/O vectors
+    double cells = static_cast<double>(N) * N;
+    double passes = (config.variant == KernelVariant::Blocked) ? 1.0 : static_cast<double>(B);
+    double bytes_per_cell = sizeof(value_type) + 2.0 * sizeof(double);
+    double bytes = passes * bytes_per_cell * cells + 2.0 * sizeof(value_type) * N * B;
+    double flops = 2.0 * cells * B;
+    double median_s = result.median_us * 1e-6;
+
+    result.mac_gflops = median_s > 0.0 ? flops / median_s / 1e9 : 0.0;
+    result.bandwidth_gbs = median_s > 0.0 ? bytes / median_s / 1e9 : 0.0;
+    result.exp_evals_per_iter = config.timed_iters > 0
+        ? static_cast<double>(exp_after - exp_before) / config.timed_iters : 0.0;
+    result.checksum = checksum;
+    return result;
+}
+
+template <typename Element>
+BenchmarkResult run_benchmark_case_typed(const BenchmarkCase& config) {
+    if (config.tiled) {
+        BasicHOCSTiledEngine<Element> engine(config.matrix_size, config.matrix_size);
+        return measure_engine(engine, config);
+    }
+    BasicHOCSEngine<Element> engine(config.matrix_size);
+    return measure_engine(engine, config);
+}
+
+inline BenchmarkResult run_benchmark_case(const BenchmarkCase& config) {
+    switch (config.precision) {
+        case ElementPrecision::F32: return run_benchmark_case_typed<float>(config);
+        case ElementPrecision::Q12: return run_benchmark_case_typed<Q4_12>(config);
+        case ElementPrecision::F64: break;
+    }
+    return run_benchmark_case_typed<double>(config);
+}
+
+inline void write_benchmark_json(std::ostream& os, const std::vector<BenchmarkResult>& results) {
+    os << "{\n  \"benchmark\": \"hocs_native_engine\",\n"
+       << "  \"simd_isa\": \"" << hocs_kernels().isa << "\",\n  \"results\": [\n";
+    for (std::size_t i = 0; i < results.size(); ++i) {
+        const BenchmarkResult& r = results[i];
+        os << "    {\"matrix_size\": " << r.config.matrix_size
+           << ", \"batch_size\": " << r.config.batch_size
+           << ", \"threads\": " << r.threads_used
+           << ", \"variant\": \"" << kernel_variant_name(r.config.variant) << "\""
+           << ", \"precision\": \"" << precision_name(r.config.precision) << "\""
+           << ", \"fast_exp\": " << (r.config.fast_exp ? "true" : "false")
+           << ", \"tiled\": " << (r.config.tiled ? "true" : "false")
+           << ", \"iterations\": " << r.config.timed_iters
+           << ", \"median_us\": " << r.median_us
+           << ", \"p99_us\": " << r.p99_us
+           << ", \"mean_us\": " << r.mean_us
+           << ", \"min_us\": " << r.min_us
+           << ", \"mac_gflops\": " << r.mac_gflops
+           << ", \"bandwidth_gbs\": " << r.bandwidth_gbs
+           << ", \"exp_evals_per_iter\": " << r.exp_evals_per_iter
+           << "}" << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    os << "  ]\n}\n";
+}
+
+inline void print_benchmark_result(std::ostream& os, const BenchmarkResult& r) {
+    os << "   N=" << r.config.matrix_size
+       << " B=" << r.config.batch_size
+       << " threads=" << r.threads_used
+       << " variant=" << kernel_variant_name(r.config.variant)
+       << " precision=" << precision_name(r.config.precision)
+       << (r.config.tiled ? " tiled" : "")
+       << " | median " << r.median_us << " us"
+       << " | p99 " << r.p99_us << " us"
+       << " | " << r.mac_gflops << " GFLOPS"
+       << " | " << r.bandwidth_gbs << " GB/s" << std::endl;
+}
+
+#endif // HOCS_BENCHMARK_HPP
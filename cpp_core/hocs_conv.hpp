@@ -0,0 +1,98 @@
+/*
+ * HOCS IMPLICIT-GEMM CONVOLUTION
+ * ==============================
+ * Description:
+ * Geometry and patch gathering for OPT_CONV without an IM2COL matrix. A
+ * Conv2d is the (out_channels x channels*kh*kw) kernel matrix applied to
+ * input patches; here the patches of one block of output pixels are formed
+ * on the fly from the raw feature map, so only the feature map is ever
+ * transferred and the staging buffer is K x HOCS_CONV_PIXEL_BLOCK instead
+ * of K x (out_h * out_w).
+ *
+ * Layouts (row-major, PyTorch order, one image):
+ *   input   channels x height x width
+ *   kernel  out_channels x channels x kernel_h x kernel_w (= rows x cols)
+ *   output  out_channels x out_h x out_w
+ */
+
+#ifndef HOCS_CONV_HPP
+#define HOCS_CONV_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+
+#include "hocs_tiler.hpp"
+
+// Output pixels whose patches are staged at once (one crossbar batch)
+constexpr int HOCS_CONV_PIXEL_BLOCK = HOCS_TILE_DIM;
+
+// C layout, passed through ctypes
+struct HOCSConvGeometry {
+    int32_t channels;
+    int32_t height;
+    int32_t width;
+    int32_t kernel_h;
+    int32_t kernel_w;
+    int32_t stride;
+    int32_t padding;
+    int32_t dilation;
+};
+
+inline int hocs_conv_out_h(const HOCSConvGeometry& g) {
+    return (g.height + 2 * g.padding - g.dilation * (g.kernel_h - 1) - 1) / g.stride + 1;
+}
+
+inline int hocs_conv_out_w(const HOCSConvGeometry& g) {
+    return (g.width + 2 * g.padding - g.dilation * (g.kernel_w - 1) - 1) / g.stride + 1;
+}
+
+// Columns of the kernel matrix (K), i.e. the crossbar layer's input width
+inline int hocs_conv_patch_size(const HOCSConvGeometry& g) {
+    return g.channels * g.kernel_h * g.kernel_w;
+}
+
+inline void hocs_validate_conv(const HOCSConvGeometry& g, int kernel_cols) {
+    if (g.channels <= 0 || g.height <= 0 || g.width <= 0 || g.kernel_h <= 0 || g.kernel_w <= 0 ||
+        g.stride <= 0 || g.padding < 0 || g.dilation <= 0) {
+        throw std::invalid_argument("HOCS conv: geometry fields must be positive");
+    }
+    if (g.height + 2 * g.padding < g.dilation * (g.kernel_h - 1) + 1 ||
+        g.width + 2 * g.padding < g.dilation * (g.kernel_w - 1) + 1) {
+        throw std::invalid_argument("HOCS conv: kernel larger than the padded input");
+    }
+    if (hocs_conv_patch_size(g) != kernel_cols) {
+        throw std::invalid_argument("HOCS conv: layer columns must equal channels * kernel_h * kernel_w");
+    }
+}
+
+// Writes the patches of output pixels [pixel0, pixel0 + count) as a
+// K x count block (voltage layout of a batched propagation); taps that fall
+// into the padding read `zero`
+template <typename T>
+void hocs_gather_patches(const T* input, const HOCSConvGeometry& g, int pixel0, int count, T* patches, T zero) {
+    const int out_w = hocs_conv_out_w(g);
+    std::size_t k = 0;
+    for (int c = 0; c < g.channels; ++c) {
+        const T* plane = input + static_cast<std::size_t>(c) * g.height * g.width;
+        for (int ky = 0; ky < g.kernel_h; ++ky) {
+            for (int kx = 0; kx < g.kernel_w; ++kx, ++k) {
+                T* row = patches + k * count;
+                int oy = pixel0 / out_w;
+                int ox = pixel0 % out_w;
+                for (int p = 0; p < count; ++p) {
+                    const int iy = oy * g.stride - g.padding + ky * g.dilation;
+                    const int ix = ox * g.stride - g.padding + kx * g.dilation;
+                    const bool inside = iy >= 0 && iy < g.height && ix >= 0 && ix < g.width;
+                    row[p] = inside ? plane[static_cast<std::size_t>(iy) * g.width + ix] : zero;
+                    if (++ox == out_w) {
+                        ox = 0;
+                        ++oy;
+                    }
+                }
+            }
+        }
+    }
+}
+
+#endif // HOCS_CONV_HPP
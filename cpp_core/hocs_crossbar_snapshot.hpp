@@ -0,0 +1,192 @@
+/*
+ * HOCS CROSSBAR SNAPSHOT FORMAT
+ * =============================
+ * Description:
+ * Versioned on-disk image of a crossbar's physical state, laid out so the
+ * engine can mmap() every plane in place (BasicHOCSEngine::load_snapshot).
+ *
+ * File layout (little endian, v1):
+ *   [0, 64 KB)  HOCSSnapshotHeader, zero padded
+ *   plane k     at plane_offset[k], plane_bytes[k] long, 64 KB aligned
+ *               (mappable with 4 KB, 16 KB and 64 KB kernel pages)
+ * Planes are row-major with pitch row_stride, in HOCSSnapshotPlane order.
+ * The cached effective conductance and its reference temperatures are
+ * stored too, so a warm start evaluates no exp().
+ */
+
+#ifndef HOCS_CROSSBAR_SNAPSHOT_HPP
+#define HOCS_CROSSBAR_SNAPSHOT_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+constexpr char HOCS_SNAPSHOT_MAGIC[8] = {'H', 'O', 'C', 'S', 'X', 'B', 'A', 'R'};
+constexpr uint32_t HOCS_SNAPSHOT_VERSION = 1;
+constexpr uint32_t HOCS_SNAPSHOT_ENDIAN_TAG = 0x01020304;
+constexpr std::size_t HOCS_SNAPSHOT_ALIGN = 64 * 1024;
+constexpr uint32_t HOCS_SNAPSHOT_FAST_EXP = 1u << 0; // flags: G_eff built with hocs_fast_exp
+
+enum HOCSSnapshotPlane {
+    SNAPSHOT_CONDUCTANCE = 0,    // double, Siemens
+    SNAPSHOT_TEMPERATURE,        // double, Kelvin (visible thermal generation)
+    SNAPSHOT_STATE,              // double, dopant drift x
+    SNAPSHOT_EFFECTIVE,          // Element storage type, cached G_eff
+    SNAPSHOT_REFERENCE_TEMP,     // double, temperature G_eff was evaluated at
+    HOCS_SNAPSHOT_PLANES
+};
+
+struct HOCSSnapshotHeader {
+    char     magic[8];          // HOCS_SNAPSHOT_MAGIC
+    uint32_t version;           // Readers reject newer major versions
+    uint32_t header_bytes;      // sizeof(HOCSSnapshotHeader) of the writer
+    uint32_t endian_tag;        // HOCS_SNAPSHOT_ENDIAN_TAG in host order
+    uint32_t matrix_size;
+    uint32_t row_stride;
+    uint32_t element_bytes;     // sizeof(ElementTraits<E>::storage_type)
+    char     element_name[8];   // ElementTraits<E>::name, NUL padded
+    uint32_t plane_count;
+    uint32_t flags;
+    double   thermal_tolerance;
+    uint64_t plane_offset[HOCS_SNAPSHOT_PLANES];
+    uint64_t plane_bytes[HOCS_SNAPSHOT_PLANES];
+    uint64_t header_checksum;   // FNV-1a of every byte before this field
+};
+
+// Memory-mapped plane, MAP_PRIVATE: writes stay in RAM (copy-on-write)
+struct HOCSMappedPlane {
+    void* mapping = nullptr;
+    std::size_t mapping_bytes = 0;
+};
+
+inline uint64_t hocs_snapshot_checksum(const HOCSSnapshotHeader& header) {
+    const unsigned char* bytes = reinterpret_cast<const unsigned char*>(&header);
+    uint64_t hash = 1469598103934665603ULL;
+    for (std::size_t i = 0; i < offsetof(HOCSSnapshotHeader, header_checksum); ++i) {
+        hash = (hash ^ bytes[i]) * 1099511628211ULL;
+    }
+    return hash;
+}
+
+inline std::size_t hocs_snapshot_align(std::size_t bytes) {
+    return (bytes + HOCS_SNAPSHOT_ALIGN - 1) / HOCS_SNAPSHOT_ALIGN * HOCS_SNAPSHOT_ALIGN;
+}
+
+// Fills magic, version and plane offsets; geometry fields must be set first
+inline void hocs_snapshot_layout(HOCSSnapshotHeader& header, const std::size_t (&plane_bytes)[HOCS_SNAPSHOT_PLANES]) {
+    std::memcpy(header.magic, HOCS_SNAPSHOT_MAGIC, sizeof(header.magic));
+    header.version = HOCS_SNAPSHOT_VERSION;
+    header.header_bytes = sizeof(HOCSSnapshotHeader);
+    header.endian_tag = HOCS_SNAPSHOT_ENDIAN_TAG;
+    header.plane_count = HOCS_SNAPSHOT_PLANES;
+
+    uint64_t offset = hocs_snapshot_align(sizeof(HOCSSnapshotHeader));
+    for (int k = 0; k < HOCS_SNAPSHOT_PLANES; ++k) {
+        header.plane_offset[k] = offset;
+        header.plane_bytes[k] = plane_bytes[k];
+        offset += hocs_snapshot_align(plane_bytes[k]);
+    }
+    header.header_checksum = hocs_snapshot_checksum(header);
+}
+
+inline bool hocs_write_all(int fd, const void* data, std::size_t bytes, uint64_t offset) {
+    const char* cursor = static_cast<const char*>(data);
+    while (bytes > 0) {
+        ssize_t written = pwrite(fd, cursor, bytes, static_cast<off_t>(offset));
+        if (written <= 0) return false;
+        cursor += written;
+        offset += static_cast<uint64_t>(written);
+        bytes -= static_cast<std::size_t>(written);
+    }
+    return true;
+}
+
+// Writes to "<path>.tmp" and renames, so a crash mid-checkpoint never
+// leaves a torn snapshot under the real name
+inline void hocs_write_snapshot(const std::string& path, const HOCSSnapshotHeader& header,
+                                const void* const (&planes)[HOCS_SNAPSHOT_PLANES]) {
+    std::string tmp_path = path + ".tmp";
+    int fd = open(tmp_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) throw std::runtime_error("HOCS snapshot: cannot create " + tmp_path);
+
+    bool ok = hocs_write_all(fd, &header, sizeof(header), 0);
+    for (int k = 0; ok && k < HOCS_SNAPSHOT_PLANES; ++k) {
+        ok = hocs_write_all(fd, planes[k], header.plane_bytes[k], header.plane_offset[k]);
+    }
+    // Extend to the aligned end so the last plane can be mapped whole
+    uint64_t end = header.plane_offset[HOCS_SNAPSHOT_PLANES - 1] +
+                   hocs_snapshot_align(header.plane_bytes[HOCS_SNAPSHOT_PLANES - 1]);
+    ok = ok && ftruncate(fd, static_cast<off_t>(end)) == 0 && fsync(fd) == 0;
+    ok = (close(fd) == 0) && ok;
+
+    if (!ok || std::rename(tmp_path.c_str(), path.c_str()) != 0) {
+        std::remove(tmp_path.c_str());
+        throw std::runtime_error("HOCS snapshot: write failed for " + path);
+    }
+}
+
+inline void hocs_unmap_snapshot(HOCSMappedPlane (&planes)[HOCS_SNAPSHOT_PLANES]) {
+    for (HOCSMappedPlane& plane : planes) {
+        if (plane.mapping) munmap(plane.mapping, plane.mapping_bytes);
+        plane = HOCSMappedPlane();
+    }
+}
+
+// Validates the header and maps every plane (all or none). Pages are read
+// lazily from the page cache, so startup cost does not scale with size.
+inline HOCSSnapshotHeader hocs_map_snapshot(const std::string& path, HOCSMappedPlane (&planes)[HOCS_SNAPSHOT_PLANES]) {
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) throw std::runtime_error("HOCS snapshot: cannot open " + path);
+
+    HOCSSnapshotHeader header;
+    struct stat info;
+    const char* error = nullptr;
+    if (pread(fd, &header, sizeof(header), 0) != static_cast<ssize_t>(sizeof(header)) || fstat(fd, &info) != 0) {
+        error = "truncated header";
+    } else if (std::memcmp(header.magic, HOCS_SNAPSHOT_MAGIC, sizeof(header.magic)) != 0) {
+        error = "not a crossbar snapshot";
+    } else if (header.version > HOCS_SNAPSHOT_VERSION) {
+        error = "unsupported version";
+    } else if (header.endian_tag != HOCS_SNAPSHOT_ENDIAN_TAG) {
+        error = "written on a host of different endianness";
+    } else if (header.header_checksum != hocs_snapshot_checksum(header) ||
+               header.plane_count != HOCS_SNAPSHOT_PLANES) {
+        error = "corrupt header";
+    } else {
+        for (int k = 0; k < HOCS_SNAPSHOT_PLANES; ++k) {
+            if (header.plane_offset[k] % HOCS_SNAPSHOT_ALIGN != 0 ||
+                header.plane_offset[k] + header.plane_bytes[k] > static_cast<uint64_t>(info.st_size)) {
+                error = "plane outside the file";
+            }
+        }
+    }
+
+    for (int k = 0; !error && k < HOCS_SNAPSHOT_PLANES; ++k) {
+        std::size_t bytes = hocs_snapshot_align(header.plane_bytes[k]);
+        void* ptr = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd,
+                         static_cast<off_t>(header.plane_offset[k]));
+        if (ptr == MAP_FAILED) {
+            error = "mmap failed";
+            break;
+        }
+        planes[k].mapping = ptr;
+        planes[k].mapping_bytes = bytes;
+    }
+    close(fd); // Mappings stay valid
+
+    if (error) {
+        hocs_unmap_snapshot(planes);
+        throw std::runtime_error("HOCS snapshot: " + path + ": " + error);
+    }
+    return header;
+}
+
+#endif // HOCS_CROSSBAR_SNAPSHOT_HPP
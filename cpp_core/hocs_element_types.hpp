@@ -0,0 +1,84 @@
+/*
+ * HOCS ENGINE ELEMENT TYPES
+ * =========================
+ * Description:
+ * Compile-time element traits for the templated crossbar engine.
+ * - double : reference precision (default HOCSEngine)
+ * - float  : Float32 host format, 2x the SIMD lanes of double
+ * - Q4_12  : Int16 fixed point wire format of the optical core
+ *            (docs/INTERFACE_SPEC.md), accumulated in int32
+ */
+
+#ifndef HOCS_ELEMENT_TYPES_HPP
+#define HOCS_ELEMENT_TYPES_HPP
+
+#include <cmath>
+#include <cstdint>
+
+// Q4.12 fixed point: bit 15 sign, bits 14-12 integer, bits 11-0 fraction
+struct Q4_12 {
+    static constexpr int FRAC_BITS = 12;
+    static constexpr double ONE = 4096.0;
+};
+
+template <typename Element>
+struct ElementTraits;
+
+template <>
+struct ElementTraits<double> {
+    using storage_type = double;
+    using accum_type = double;
+    static constexpr const char* name = "f64";
+
+    static storage_type from_double(double x) { return x; }
+    static double to_double(storage_type x) { return x; }
+    static accum_type mul(storage_type a, storage_type b) { return a * b; }
+    static storage_type from_accum(accum_type acc) { return acc; }
+};
+
+template <>
+struct ElementTraits<float> {
+    using storage_type = float;
+    using accum_type = float;
+    static constexpr const char* name = "f32";
+
+    static storage_type from_double(double x) { return static_cast<float>(x); }
+    static double to_double(storage_type x) { return x; }
+    static accum_type mul(storage_type a, storage_type b) { return a * b; }
+    static storage_type from_accum(accum_type acc) { return acc; }
+};
+
+// Products are Q8.24 and summed in int32, like the 32-bit result register of
+// cuo_array_controller. One 128-wide hardware tile of full-scale (|x| < 1.0)
+// operands cannot overflow; wider rows must keep |sum| below 128.0.
+template <>
+struct ElementTraits<Q4_12> {
+    using storage_type = int16_t;
+    using accum_type = int32_t;
+    static constexpr const char* name = "q4.12";
+
+    static storage_type saturate(int32_t v) {
+        return static_cast<storage_type>(v > INT16_MAX ? INT16_MAX : (v < INT16_MIN ? INT16_MIN : v));
+    }
+
+    // Round to nearest, saturate to [-8.0, 8.0)
+    static storage_type from_double(double x) {
+        double scaled = std::nearbyint(x * Q4_12::ONE);
+        if (scaled > INT16_MAX) return INT16_MAX;
+        if (scaled < INT16_MIN) return INT16_MIN;
+        return static_cast<storage_type>(scaled);
+    }
+
+    static double to_double(storage_type x) { return x / Q4_12::ONE; }
+
+    static accum_type mul(storage_type a, storage_type b) {
+        return static_cast<accum_type>(a) * static_cast<accum_type>(b);
+    }
+
+    // Q8.24 accumulator back to Q4.12 (round half up, saturate)
+    static storage_type from_accum(accum_type acc) {
+        return saturate((acc + (1 << (Q4_12::FRAC_BITS - 1))) >> Q4_12::FRAC_BITS);
+    }
+};
+
+#endif // HOCS_ELEMENT_TYPES_HPP
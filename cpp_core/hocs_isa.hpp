@@ -0,0 +1,144 @@
+/*
+ * HOCS-ASM BINARY ENCODING
+ * ========================
+ * Description:
+ * Packed instruction stream emitted by compiler/hocs_torch_bridge.py
+ * (HOCSGraphTracer.encode) for the native runtime. Instructions are fixed
+ * 16-byte words, so the runtime dispatches straight from the mapped image:
+ * no text, no parsing, no allocation per instruction.
+ *
+ * Image layout (little endian, v1):
+ *   HOCSAsmHeader, then instruction_count x HOCSInstruction. The last
+ *   instruction is HALT. Host buffers (activations and layer weights) are
+ *   numbered in order of first use; their names travel beside the image
+ *   (symbol table of the compiler).
+ * Opcode values are mirrored by HOCS_OPCODES in the compiler.
+ */
+
+#ifndef HOCS_ISA_HPP
+#define HOCS_ISA_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+
+#include "hocs_conv.hpp"
+
+constexpr char HOCS_ASM_MAGIC[4] = {'H', 'A', 'S', 'M'};
+constexpr uint16_t HOCS_ASM_VERSION = 1;
+constexpr int HOCS_ASM_REGISTERS = 8; // On-chip vector registers v0..v7
+
+enum HOCSOpcode : uint8_t {
+    HOCS_OP_NOP         = 0x00,
+    HOCS_OP_INIT_CORE   = 0x01, // operand: core index
+    HOCS_OP_LOAD_DMA    = 0x02, // dst <- host buffer `operand`
+    HOCS_OP_STORE_DMA   = 0x03, // host buffer `operand` <- src
+    HOCS_OP_CONFIG_XBAR = 0x04, // program region `operand` with TILE_ID arg1 of weight buffer arg0
+    HOCS_OP_OPT_MATMUL  = 0x05, // dst (+)= tile in region `operand` * src; arg0/arg1 = tile row/col
+    HOCS_OP_OPT_CONV    = 0x06, // as OPT_MATMUL, src holds IM2COL patches (HOCS_INSN_IMPLICIT: the feature map)
+    HOCS_OP_IM2COL      = 0x07, // dst <- patches of src, operand = kernel size
+    HOCS_OP_V_RELU      = 0x08, // dst <- max(src, 0)
+    HOCS_OP_CONV_SHAPE  = 0x09, // Geometry of the following implicit OPT_CONVs, see hocs_decode_conv_shape
+    HOCS_OP_HALT        = 0xFF
+};
+
+enum HOCSInstructionFlags : uint8_t {
+    HOCS_INSN_RELU       = 1u << 0, // Fused ReLU once this instruction completes dst
+    HOCS_INSN_ACCUMULATE = 1u << 1, // Add into dst instead of overwriting it
+    HOCS_INSN_12BIT      = 1u << 2, // CONFIG_XBAR: 12-bit DAC conductance levels
+    HOCS_INSN_IMPLICIT   = 1u << 3  // OPT_CONV: form patches per tile from the raw feature map
+};
+
+struct HOCSAsmHeader {
+    char     magic[4];          // HOCS_ASM_MAGIC
+    uint16_t version;           // HOCS_ASM_VERSION
+    uint16_t instruction_bytes; // sizeof(HOCSInstruction) of the writer
+    uint32_t instruction_count;
+    uint32_t host_buffers;      // Symbols referenced by DMA and CONFIG_XBAR
+};
+
+struct HOCSInstruction {
+    uint8_t  opcode;            // HOCSOpcode
+    uint8_t  flags;             // HOCSInstructionFlags
+    uint8_t  dst;               // Vector register
+    uint8_t  src;
+    uint32_t operand;           // Region, host buffer, kernel size or core index
+    uint32_t arg0;
+    uint32_t arg1;
+};
+
+static_assert(sizeof(HOCSAsmHeader) == 16, "HOCS-ASM header is 16 bytes on the wire");
+static_assert(sizeof(HOCSInstruction) == 16, "HOCS-ASM instructions are 16 bytes on the wire");
+
+inline bool hocs_known_opcode(uint8_t opcode) {
+    return opcode <= HOCS_OP_CONV_SHAPE || opcode == HOCS_OP_HALT;
+}
+
+// CONV_SHAPE fields: operand = channels | dilation << 16,
+// arg0 = height << 16 | width, arg1 = kh | kw << 8 | stride << 16 | padding << 24
+inline HOCSConvGeometry hocs_decode_conv_shape(const HOCSInstruction& insn) {
+    HOCSConvGeometry g;
+    g.channels = static_cast<int32_t>(insn.operand & 0xFFFF);
+    g.dilation = static_cast<int32_t>(insn.operand >> 16);
+    g.height = static_cast<int32_t>(insn.arg0 >> 16);
+    g.width = static_cast<int32_t>(insn.arg0 & 0xFFFF);
+    g.kernel_h = static_cast<int32_t>(insn.arg1 & 0xFF);
+    g.kernel_w = static_cast<int32_t>((insn.arg1 >> 8) & 0xFF);
+    g.stride = static_cast<int32_t>((insn.arg1 >> 16) & 0xFF);
+    g.padding = static_cast<int32_t>(insn.arg1 >> 24);
+    return g;
+}
+
+// Validated, zero-copy view of an image owned by the caller
+class HOCSProgramView {
+private:
+    HOCSAsmHeader header;
+    const HOCSInstruction* first;
+
+public:
+    HOCSProgramView(const void* image, std::size_t bytes) {
+        if (!image || bytes < sizeof(HOCSAsmHeader)) {
+            throw std::invalid_argument("HOCS-ASM: truncated header");
+        }
+        std::memcpy(&header, image, sizeof(header));
+        if (std::memcmp(header.magic, HOCS_ASM_MAGIC, sizeof(header.magic)) != 0) {
+            throw std::invalid_argument("HOCS-ASM: not an instruction stream");
+        }
+        if (header.version > HOCS_ASM_VERSION || header.instruction_bytes != sizeof(HOCSInstruction)) {
+            throw std::invalid_argument("HOCS-ASM: unsupported version");
+        }
+        if (header.instruction_count == 0 ||
+            header.instruction_count > (bytes - sizeof(HOCSAsmHeader)) / sizeof(HOCSInstruction)) {
+            throw std::invalid_argument("HOCS-ASM: instruction count exceeds the image");
+        }
+        if (reinterpret_cast<uintptr_t>(image) % alignof(HOCSInstruction) != 0) {
+            throw std::invalid_argument("HOCS-ASM: image must be 4-byte aligned");
+        }
+
+        first = reinterpret_cast<const HOCSInstruction*>(static_cast<const unsigned char*>(image) +
+                                                         sizeof(HOCSAsmHeader));
+        for (const HOCSInstruction& insn : *this) {
+            if (!hocs_known_opcode(insn.opcode)) throw std::invalid_argument("HOCS-ASM: unknown opcode");
+            if (insn.dst >= HOCS_ASM_REGISTERS || insn.src >= HOCS_ASM_REGISTERS) {
+                throw std::invalid_argument("HOCS-ASM: register out of range");
+            }
+            const bool dma = insn.opcode == HOCS_OP_LOAD_DMA || insn.opcode == HOCS_OP_STORE_DMA;
+            if ((dma && insn.operand >= header.host_buffers) ||
+                (insn.opcode == HOCS_OP_CONFIG_XBAR && insn.arg0 >= header.host_buffers)) {
+                throw std::invalid_argument("HOCS-ASM: host buffer out of range");
+            }
+        }
+        if (first[header.instruction_count - 1].opcode != HOCS_OP_HALT) {
+            throw std::invalid_argument("HOCS-ASM: program does not end with HALT");
+        }
+    }
+
+    const HOCSAsmHeader& info() const { return header; }
+    std::size_t size() const { return header.instruction_count; }
+    const HOCSInstruction& operator[](std::size_t i) const { return first[i]; }
+    const HOCSInstruction* begin() const { return first; }
+    const HOCSInstruction* end() const { return first + header.instruction_count; }
+};
+
+#endif // HOCS_ISA_HPP
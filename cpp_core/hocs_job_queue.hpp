@@ -0,0 +1,247 @@
+/*
+ * HOCS NATIVE JOB QUEUE
+ * =====================
+ * Description:
+ * Submission queue between the Python backend and the native engine. A
+ * fixed ring of slots owns preallocated input/output buffers; worker threads
+ * run submitted slots and post them to a completion list, signalling an
+ * eventfd the asyncio loop waits on (loop.add_reader). Several tensors can
+ * be in flight at once and no buffer is allocated per request.
+ *
+ * Slot life cycle (owner in brackets):
+ *   acquire() [caller fills input] -> submit() [worker runs] ->
+ *   reap() [caller reads output] -> release() -> free again
+ * An acquired slot may also be released unsubmitted. Any other transition
+ * (double release, submit of a slot in flight, ...) throws
+ * std::invalid_argument and leaves the slot untouched.
+ * Waiting for a worker is recorded as HOCS_STAGE_DMA_SUBMIT, running as
+ * HOCS_STAGE_IRQ and completion until reap() as HOCS_STAGE_READBACK: the
+ * queue stands in for the DMA channel in simulation.
+ */
+
+#ifndef HOCS_JOB_QUEUE_HPP
+#define HOCS_JOB_QUEUE_HPP
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+#include "hocs_native_engine.hpp"
+#include "hocs_telemetry.hpp"
+
+struct HOCSJob;
+
+enum class HOCSSlotState : uint8_t { Free, Acquired, Submitted, Reaped };
+
+// Runs one job on a worker thread; the return value becomes its status
+using HOCSJobFunction = int (*)(HOCSJob& job);
+
+struct HOCSJob {
+    int slot;
+    void* input;              // Slot-owned, input_capacity bytes
+    void* output;             // Slot-owned, output_capacity bytes
+    std::size_t input_capacity;
+    std::size_t output_capacity;
+
+    // Filled by the submitter
+    HOCSJobFunction run = nullptr;
+    void* target = nullptr;   // Object the job operates on (e.g. an engine handle)
+    int batch_size = 0;
+    int status = 0;           // Result of run(), valid after reap()
+    HOCSSlotState state = HOCSSlotState::Free; // Guarded by HOCSJobQueue::free_lock
+
+    // hocs_cycles() when submitted / completed (the counter is system-wide)
+    uint64_t submitted_at = 0;
+    uint64_t completed_at = 0;
+};
+
+class HOCSJobQueue {
+private:
+    std::vector<HOCSJob> jobs;
+    AlignedBuffer<unsigned char> input_region;
+    AlignedBuffer<unsigned char> output_region;
+    int completion_efd = -1;
+
+    std::mutex free_lock; // free_slots and every HOCSJob::state
+    std::vector<int> free_slots;
+
+    std::mutex submit_lock;
+    std::condition_variable submit_ready;
+    std::deque<int> submitted;
+    bool stopping = false;
+
+    std::mutex completion_lock;
+    std::deque<int> completed;
+
+    std::vector<std::thread> workers;
+
+    static std::size_t align_up(std::size_t bytes) {
+        return (bytes + CACHE_LINE_BYTES - 1) & ~(CACHE_LINE_BYTES - 1);
+    }
+
+    void worker_loop() {
+        for (;;) {
+            int slot;
+            {
+                std::unique_lock<std::mutex> guard(submit_lock);
+                submit_ready.wait(guard, [this] { return stopping || !submitted.empty(); });
+                if (submitted.empty()) return; // Stopping and drained
+                slot = submitted.front();
+                submitted.pop_front();
+            }
+
+            HOCSJob& job = jobs[slot];
+            const uint64_t started_at = hocs_cycles();
+            hocs_telemetry().record(HOCS_STAGE_DMA_SUBMIT, job.submitted_at, started_at);
+            job.status = job.run(job);
+            job.completed_at = hocs_cycles();
+            hocs_telemetry().record(HOCS_STAGE_IRQ, started_at, job.completed_at);
+
+            {
+                std::lock_guard<std::mutex> guard(completion_lock);
+                completed.push_back(slot);
+            }
+            uint64_t one = 1;
+            ssize_t ignored = write(completion_efd, &one, sizeof(one));
+            (void)ignored; // Only fails if the counter would overflow, still readable
+        }
+    }
+
+public:
+    // slot_count slots with input_bytes / output_bytes each (64 B aligned),
+    // served by worker_count threads
+    HOCSJobQueue(int slot_count, std::size_t input_bytes, std::size_t output_bytes, int worker_count) {
+        if (slot_count <= 0 || worker_count <= 0 || input_bytes == 0 || output_bytes == 0) {
+            throw std::invalid_argument("HOCSJobQueue: slot, worker and buffer sizes must be positive");
+        }
+        completion_efd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (completion_efd < 0) throw std::runtime_error("HOCSJobQueue: eventfd() failed");
+
+        const std::size_t in_stride = align_up(input_bytes);
+        const std::size_t out_stride = align_up(output_bytes);
+        input_region.resize(in_stride * slot_count);
+        output_region.resize(out_stride * slot_count);
+
+        jobs.resize(slot_count);
+        free_slots.reserve(slot_count);
+        for (int i = 0; i < slot_count; ++i) {
+            HOCSJob& job = jobs[i];
+            job.slot = i;
+            job.input = input_region.data() + in_stride * i;
+            job.output = output_region.data() + out_stride * i;
+            job.input_capacity = in_stride;
+            job.output_capacity = out_stride;
+            free_slots.push_back(slot_count - 1 - i); // Hand out slot 0 first
+        }
+
+        workers.reserve(worker_count);
+        for (int i = 0; i < worker_count; ++i) workers.emplace_back(&HOCSJobQueue::worker_loop, this);
+    }
+
+    // Lets submitted jobs finish, then joins the workers
+    ~HOCSJobQueue() {
+        {
+            std::lock_guard<std::mutex> guard(submit_lock);
+            stopping = true;
+        }
+        submit_ready.notify_all();
+        for (std::thread& worker : workers) worker.join();
+        close(completion_efd);
+    }
+
+    HOCSJobQueue(const HOCSJobQueue&) = delete;
+    HOCSJobQueue& operator=(const HOCSJobQueue&) = delete;
+
+    int slot_count() const { return static_cast<int>(jobs.size()); }
+    int completion_fd() const { return completion_efd; }
+    HOCSJob& job(int slot) { return jobs.at(slot); }
+
+    // Free slot, or -1 when every slot is in flight or awaiting release
+    int acquire() {
+        std::lock_guard<std::mutex> guard(free_lock);
+        if (free_slots.empty()) return -1;
+        int slot = free_slots.back();
+        free_slots.pop_back();
+        jobs[slot].state = HOCSSlotState::Acquired;
+        return slot;
+    }
+
+    // Queues an acquired slot to run `run` on `target`
+    void submit(int slot, HOCSJobFunction run, void* target, int batch_size) {
+        if (slot < 0 || slot >= slot_count() || !run) {
+            throw std::invalid_argument("HOCSJobQueue: submit of an invalid slot");
+        }
+        {
+            std::lock_guard<std::mutex> guard(free_lock);
+            if (jobs[slot].state != HOCSSlotState::Acquired) {
+                throw std::invalid_argument("HOCSJobQueue: submit of a slot that is not acquired");
+            }
+            jobs[slot].state = HOCSSlotState::Submitted;
+        }
+        HOCSJob& job = jobs[slot];
+        job.run = run;
+        job.target = target;
+        job.batch_size = batch_size;
+        job.submitted_at = hocs_cycles();
+        {
+            std::lock_guard<std::mutex> guard(submit_lock);
+            submitted.push_back(slot);
+        }
+        submit_ready.notify_one();
+    }
+
+    // Drains up to max finished slots (and the eventfd counter). A wakeup may
+    // find nothing: completions drained by the previous call already covered it.
+    int reap(int* slots, int* statuses, int max) {
+        uint64_t counter;
+        ssize_t ignored = read(completion_efd, &counter, sizeof(counter)); // EAGAIN when already 0
+        (void)ignored;
+
+        std::lock_guard<std::mutex> guard(completion_lock);
+        std::lock_guard<std::mutex> state_guard(free_lock);
+        const uint64_t reaped_at = hocs_cycles();
+        int count = 0;
+        while (count < max && !completed.empty()) {
+            int slot = completed.front();
+            completed.pop_front();
+            jobs[slot].state = HOCSSlotState::Reaped;
+            hocs_telemetry().record(HOCS_STAGE_READBACK, jobs[slot].completed_at, reaped_at);
+            slots[count] = slot;
+            if (statuses) statuses[count] = jobs[slot].status;
+            ++count;
+        }
+        if (!completed.empty()) {
+            // Caller's array was full: re-arm so the loop wakes again
+            uint64_t one = 1;
+            ignored = write(completion_efd, &one, sizeof(one));
+        }
+        return count;
+    }
+
+    // Returns a reaped (or acquired, never submitted) slot to the free list
+    void release(int slot) {
+        if (slot < 0 || slot >= slot_count()) {
+            throw std::invalid_argument("HOCSJobQueue: release of an invalid slot");
+        }
+        std::lock_guard<std::mutex> guard(free_lock);
+        HOCSJob& job = jobs[slot];
+        if (job.state != HOCSSlotState::Reaped && job.state != HOCSSlotState::Acquired) {
+            throw std::invalid_argument(job.state == HOCSSlotState::Free
+                                            ? "HOCSJobQueue: release of a free slot"
+                                            : "HOCSJobQueue: release of a slot still in flight");
+        }
+        job.state = HOCSSlotState::Free;
+        job.run = nullptr;
+        free_slots.push_back(slot);
+    }
+};
+
+#endif // HOCS_JOB_QUEUE_HPP
@@ -3,124 +3,546 @@
  * ==================================
  * Author: Muhammed Yusuf Çobanoğlu
  * Description: 
- * High-Performance Computing (HPC) backend for simulating CuO Memristor dynamics.
- * Utilizes OpenMP for parallel execution and SIMD vectorization.
- * Implements the Non-Linear Drift Model for memristive hysteresis.
+ * C-Linkage entry points of the native engine for the Python CTypes layer.
+ * The engine itself lives in hocs_native_engine.hpp.
  */
 
+#include <chrono>
+#include <exception>
 #include <iostream>
-#include <vector>
-#include <complex>
-#include <cmath>
-#include <thread>
+#include <memory>
 #include <mutex>
-#include <chrono>
-#include <random>
+#include <string>
+#include <vector>
 
-// Constants for Copper Oxide Physics
-const double BOLTZMANN_K = 1.380649e-23;
-const double ELECTRON_Q  = 1.602176e-19;
-const double PLANCK_H    = 6.626070e-34;
-const double T_AMBIENT   = 300.0; // Kelvin
+#include "hocs_native_engine.hpp"
+#include "hocs_benchmark.hpp"
+#include "hocs_isa.hpp"
+#include "hocs_job_queue.hpp"
+#include "hocs_residency.hpp"
+#include "hocs_telemetry.hpp"
+#include "hocs_tiled_engine.hpp"
 
-// Use Complex numbers for Optical Wave Phase/Amplitude
-using OpticalSignal = std::complex<double>;
+// Element type of a handle's voltage/current buffers
+enum HOCSPrecision {
+    HOCS_PRECISION_F64 = 0, // double
+    HOCS_PRECISION_F32 = 1, // float (Float32 host format of the ICD)
+    HOCS_PRECISION_Q12 = 2  // int16_t, Q4.12 wire format
+};
 
-struct MemristorCell {
-    double conductance; // Siemens
-    double temperature; // Kelvin
-    double state_variable; // x (Dopant drift position)
+// Status codes of the handle API
+enum HOCSStatus {
+    HOCS_OK = 0,
+    HOCS_ERROR_ARGUMENT = -1, // Null handle/buffer or bad dimensions
+    HOCS_ERROR_RUNTIME = -2   // Engine threw; see hocs_engine_last_error()
 };
 
-class HOCSEngine {
-private:
-    int matrix_size;
-    std::vector<MemristorCell> crossbar_array;
-    std::mutex mtx; // Thread safety
+namespace {
+
+thread_local std::string last_error;
 
+// A warm, tiled M x K layer behind an opaque handle. Propagation advances
+// the thermal state, so calls on one handle are serialized by its mutex;
+// distinct handles run concurrently. With a thermal time constant set, the
+// layer cools toward T_AMBIENT for the wall time between passes.
+class HOCSEngineHandle {
 public:
-    HOCSEngine(int size) : matrix_size(size) {
-        // Allocate memory aligned to cache lines for performance
-        crossbar_array.resize(size * size);
-        initialize_physics();
+    HOCSEngineHandle(int rows, int cols) : layer_rows(rows), layer_cols(cols) {}
+    virtual ~HOCSEngineHandle() = default;
+
+    int rows() const { return layer_rows; }
+    int cols() const { return layer_cols; }
+    virtual std::size_t element_bytes() const = 0;
+
+    void program_weights(const float* weights, std::size_t ld) {
+        std::lock_guard<std::mutex> guard(lock);
+        program_locked(weights, ld);
+    }
+
+    void propagate_batch(const void* voltages, int batch_size, void* currents) {
+        std::lock_guard<std::mutex> guard(lock);
+        cool_locked();
+        propagate_locked(voltages, batch_size, currents);
     }
 
-    void initialize_physics() {
-        // Random initialization of filament states
-        std::mt19937 rng(std::random_device{}());
-        std::uniform_real_distribution<double> dist(0.0, 1.0);
+    // Both steps under one lock, so concurrent jobs on a shared handle
+    // never propagate through each other's weights
+    void program_and_propagate(const float* weights, std::size_t ld, const void* voltages, int batch_size,
+                               void* currents) {
+        std::lock_guard<std::mutex> guard(lock);
+        cool_locked();
+        program_locked(weights, ld);
+        propagate_locked(voltages, batch_size, currents);
+    }
 
-        for (auto& cell : crossbar_array) {
-            cell.conductance = 1e-6; // Off state (Low conductance)
-            cell.temperature = T_AMBIENT;
-            cell.state_variable = dist(rng);
-        }
-        std::cout << "[CPP-CORE] Physics Engine Initialized. Size: " 
-                  << matrix_size << "x" << matrix_size << std::endl;
-    }
-
-    // The Heavy Calculation: O(N^2) Parallel Matrix Multiplication
-    std::vector<double> compute_optical_propagation(const std::vector<double>& voltage_inputs) {
-        std::vector<double> current_outputs(matrix_size, 0.0);
-
-        // START PARALLEL REGION (Simulates simultaneous light propagation)
-        // This loop would be massive on a CPU without Optimization
-        #pragma omp parallel for schedule(static)
-        for (int row = 0; row < matrix_size; ++row) {
-            double row_current_sum = 0.0;
-            
-            for (int col = 0; col < matrix_size; ++col) {
-                // Access 1D vector as 2D matrix
-                int idx = row * matrix_size + col;
-                
-                // Ohm's Law at Nano-scale: I = V * G(x, V, T)
-                // Also accounting for thermal noise (Johnson-Nyquist)
-                double G = crossbar_array[idx].conductance;
-                double V = voltage_inputs[col];
-                
-                // Non-linear JART VCM Memristor Model Equation (Simplified)
-                double current = G * V * std::exp(-0.1 / (BOLTZMANN_K * crossbar_array[idx].temperature));
-                
-                row_current_sum += current;
-                
-                // Update Thermal State (Self-Heating Effect)
-                // This proves we are aware of the "Thermal Wall"
-                crossbar_array[idx].temperature += (current * V) * 1e-9; 
-            }
-            
-            // Critical Section not needed due to local accumulation logic
-            current_outputs[row] = row_current_sum;
-        }
+    // Implicit-GEMM Conv2d through the programmed kernel matrix (hocs_conv.hpp)
+    void convolve(const HOCSConvGeometry& geometry, const void* input, int images, void* output) {
+        std::lock_guard<std::mutex> guard(lock);
+        cool_locked();
+        convolve_locked(geometry, input, images, output);
+    }
 
-        return current_outputs;
+    // Includes the cooling since the last pass
+    double peak_temperature() {
+        std::lock_guard<std::mutex> guard(lock);
+        cool_locked();
+        return peak_temperature_locked();
     }
 
-    void stress_test_benchmark(int iterations) {
-        std::cout << "[CPP-CORE] Starting Exascale Stress Test..." << std::endl;
-        std::vector<double> dummy_input(matrix_size, 0.5); // 0.5 Volts
+    // 0 (the default) keeps the layer adiabatic: heat only accumulates
+    void set_thermal_time_constant(double seconds) {
+        std::lock_guard<std::mutex> guard(lock);
+        cool_locked();
+        time_constant = seconds;
+    }
+
+    // Pruned layers: skip off tiles, rows and column blocks (BasicHOCSTiledEngine::set_sparse)
+    void set_sparse(bool enabled) {
+        std::lock_guard<std::mutex> guard(lock);
+        set_sparse_locked(enabled);
+    }
+
+    double tile_density() {
+        std::lock_guard<std::mutex> guard(lock);
+        return tile_density_locked();
+    }
+
+protected:
+    virtual void program_locked(const float* weights, std::size_t ld) = 0;
+    virtual void propagate_locked(const void* voltages, int batch_size, void* currents) = 0;
+    virtual void convolve_locked(const HOCSConvGeometry& geometry, const void* input, int images,
+                                 void* output) = 0;
+    virtual double peak_temperature_locked() const = 0;
+    virtual void dissipate_locked(double seconds, double time_constant) = 0;
+    virtual void set_sparse_locked(bool enabled) = 0;
+    virtual double tile_density_locked() const = 0;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    int layer_rows;
+    int layer_cols;
+    std::mutex lock;
+    double time_constant = 0.0;
+    Clock::time_point last_pass = Clock::now();
 
-        auto start = std::chrono::high_resolution_clock::now();
-        
-        for(int i=0; i<iterations; i++) {
-            volatile auto result = compute_optical_propagation(dummy_input);
+    void cool_locked() {
+        const Clock::time_point now = Clock::now();
+        if (time_constant > 0.0) {
+            dissipate_locked(std::chrono::duration<double>(now - last_pass).count(), time_constant);
         }
+        last_pass = now;
+    }
+};
 
-        auto end = std::chrono::high_resolution_clock::now();
-        std::chrono::duration<double> diff = end - start;
-        
-        double ops = 2.0 * std::pow(matrix_size, 2) * iterations;
-        double gflops = (ops / diff.count()) / 1e9;
+template <typename Element>
+class HOCSTypedEngineHandle : public HOCSEngineHandle {
+public:
+    using value_type = typename ElementTraits<Element>::storage_type;
 
-        std::cout << "[CPP-CORE] Benchmark Finished." << std::endl;
-        std::cout << "   Time: " << diff.count() << " s" << std::endl;
-        std::cout << "   Throughput: " << gflops << " GFLOPS (Simulated)" << std::endl;
+    HOCSTypedEngineHandle(int rows, int cols) : HOCSEngineHandle(rows, cols), layer(rows, cols) {}
+
+    std::size_t element_bytes() const override { return sizeof(value_type); }
+
+protected:
+    void program_locked(const float* weights, std::size_t ld) override {
+        HOCSStageTimer timer(HOCS_STAGE_QUANTIZE); // Float32 -> conductance levels
+        layer.program_weights(weights, ld);
+    }
+
+    void propagate_locked(const void* voltages, int batch_size, void* currents) override {
+        layer.compute_optical_propagation_batch(static_cast<const value_type*>(voltages), batch_size,
+                                                static_cast<value_type*>(currents));
+    }
+
+    void convolve_locked(const HOCSConvGeometry& geometry, const void* input, int images, void* output) override {
+        layer.compute_optical_convolution(geometry, static_cast<const value_type*>(input), images,
+                                          static_cast<value_type*>(output));
     }
+
+    double peak_temperature_locked() const override { return layer.peak_temperature(); }
+
+    void dissipate_locked(double seconds, double time_constant) override {
+        layer.dissipate(seconds, time_constant);
+    }
+
+    void set_sparse_locked(bool enabled) override { layer.set_sparse(enabled); }
+
+    double tile_density_locked() const override { return layer.tile_density(); }
+
+private:
+    BasicHOCSTiledEngine<Element> layer;
 };
 
+HOCSEngineHandle* make_handle(int rows, int cols, int precision) {
+    switch (precision) {
+        case HOCS_PRECISION_F64: return new HOCSTypedEngineHandle<double>(rows, cols);
+        case HOCS_PRECISION_F32: return new HOCSTypedEngineHandle<float>(rows, cols);
+        case HOCS_PRECISION_Q12: return new HOCSTypedEngineHandle<Q4_12>(rows, cols);
+        default: throw std::invalid_argument("unknown precision " + std::to_string(precision));
+    }
+}
+
+// Exceptions must not cross the C boundary
+template <typename Fn>
+int guarded(Fn&& fn) {
+    try {
+        fn();
+        return HOCS_OK;
+    } catch (const std::invalid_argument& e) {
+        last_error = e.what();
+        return HOCS_ERROR_ARGUMENT;
+    } catch (const std::exception& e) {
+        last_error = e.what();
+        return HOCS_ERROR_RUNTIME;
+    }
+}
+
+// Input layout of a program-and-propagate job: rows x cols Float32
+// weights, then the voltages at the next 64-byte boundary
+std::size_t job_voltage_offset(const HOCSEngineHandle& engine) {
+    std::size_t weight_bytes = static_cast<std::size_t>(engine.rows()) * engine.cols() * sizeof(float);
+    return (weight_bytes + CACHE_LINE_BYTES - 1) & ~(CACHE_LINE_BYTES - 1);
+}
+
+bool job_fits(const HOCSJob& job, const HOCSEngineHandle& engine, std::size_t voltage_offset) {
+    const std::size_t batch = static_cast<std::size_t>(job.batch_size);
+    return voltage_offset + engine.cols() * batch * engine.element_bytes() <= job.input_capacity &&
+           engine.rows() * batch * engine.element_bytes() <= job.output_capacity;
+}
+
+int run_propagate_job(HOCSJob& job) {
+    HOCSEngineHandle& engine = *static_cast<HOCSEngineHandle*>(job.target);
+    if (!job_fits(job, engine, 0)) return HOCS_ERROR_ARGUMENT;
+    return guarded([&] { engine.propagate_batch(job.input, job.batch_size, job.output); });
+}
+
+int run_program_propagate_job(HOCSJob& job) {
+    HOCSEngineHandle& engine = *static_cast<HOCSEngineHandle*>(job.target);
+    const std::size_t offset = job_voltage_offset(engine);
+    if (!job_fits(job, engine, offset)) return HOCS_ERROR_ARGUMENT;
+    const unsigned char* input = static_cast<const unsigned char*>(job.input);
+    return guarded([&] {
+        engine.program_and_propagate(reinterpret_cast<const float*>(input), engine.cols(), input + offset,
+                                     job.batch_size, job.output);
+    });
+}
+
+int submit_job(void* queue, int slot, void* handle, int batch_size, HOCSJobFunction run) {
+    HOCSJobQueue* jobs = static_cast<HOCSJobQueue*>(queue);
+    if (!jobs || !handle || batch_size <= 0) {
+        last_error = "hocs_queue_submit: bad queue, handle or batch size";
+        return HOCS_ERROR_ARGUMENT;
+    }
+    return guarded([&] { jobs->submit(slot, run, handle, batch_size); });
+}
+
+} // namespace
+
 // C-Linkage for Python CTypes binding
 extern "C" {
     void run_cpp_benchmark(int size, int iters) {
-        HOCSEngine engine(size);
-        engine.stress_test_benchmark(iters);
+        std::cout << "[CPP-CORE] Starting Exascale Stress Test..." << std::endl;
+
+        BenchmarkCase config;
+        config.matrix_size = size;
+        config.timed_iters = iters;
+        BenchmarkResult result = run_benchmark_case(config);
+
+        std::cout << "[CPP-CORE] Benchmark Finished." << std::endl;
+        print_benchmark_result(std::cout, result);
+    }
+
+    void run_cpp_batch_benchmark(int size, int batch, int iters) {
+        std::cout << "[CPP-CORE] Starting Batched Stress Test (B=" << batch << ")..." << std::endl;
+
+        BenchmarkCase config;
+        config.matrix_size = size;
+        config.batch_size = batch;
+        config.variant = KernelVariant::Blocked;
+        config.timed_iters = iters;
+        BenchmarkResult result = run_benchmark_case(config);
+
+        std::cout << "[CPP-CORE] Batched Benchmark Finished." << std::endl;
+        print_benchmark_result(std::cout, result);
+    }
+
+    // --- Persistent engine handles ---
+    // A handle owns a rows x cols layer (rows = output currents, cols = input
+    // voltages) that stays resident between calls. All buffers are row-major,
+    // caller-owned and typed by the handle's precision; nothing is allocated
+    // per call, so Python can pass NumPy/DMA buffers straight through.
+
+    // Returns NULL on failure (reason in hocs_engine_last_error())
+    void* hocs_engine_create(int rows, int cols, int precision) {
+        HOCSEngineHandle* handle = nullptr;
+        guarded([&] { handle = make_handle(rows, cols, precision); });
+        return handle;
+    }
+
+    void hocs_engine_destroy(void* handle) {
+        delete static_cast<HOCSEngineHandle*>(handle);
+    }
+
+    int hocs_engine_rows(void* handle) {
+        return handle ? static_cast<HOCSEngineHandle*>(handle)->rows() : HOCS_ERROR_ARGUMENT;
+    }
+
+    int hocs_engine_cols(void* handle) {
+        return handle ? static_cast<HOCSEngineHandle*>(handle)->cols() : HOCS_ERROR_ARGUMENT;
+    }
+
+    // rows x cols Float32 weights with leading dimension ld (>= cols)
+    int hocs_engine_program_weights(void* handle, const float* weights, int ld) {
+        HOCSEngineHandle* engine = static_cast<HOCSEngineHandle*>(handle);
+        if (!engine || !weights || ld < engine->cols()) {
+            last_error = "hocs_engine_program_weights: bad handle, buffer or leading dimension";
+            return HOCS_ERROR_ARGUMENT;
+        }
+        return guarded([&] { engine->program_weights(weights, static_cast<std::size_t>(ld)); });
+    }
+
+    // cols x batch voltages in, rows x batch currents out
+    int hocs_engine_propagate_batch(void* handle, const void* voltages, int batch_size, void* currents) {
+        HOCSEngineHandle* engine = static_cast<HOCSEngineHandle*>(handle);
+        if (!engine || !voltages || !currents || batch_size <= 0) {
+            last_error = "hocs_engine_propagate_batch: bad handle, buffer or batch size";
+            return HOCS_ERROR_ARGUMENT;
+        }
+        return guarded([&] { engine->propagate_batch(voltages, batch_size, currents); });
+    }
+
+    // One vector: cols voltages in, rows currents out
+    int hocs_engine_propagate(void* handle, const void* voltages, void* currents) {
+        return hocs_engine_propagate_batch(handle, voltages, 1, currents);
+    }
+
+    // Programs rows x cols weights and propagates cols x batch voltages as one
+    // step: no other call on the handle can run in between
+    int hocs_engine_program_and_propagate(void* handle, const float* weights, int ld, const void* voltages,
+                                          int batch_size, void* currents) {
+        HOCSEngineHandle* engine = static_cast<HOCSEngineHandle*>(handle);
+        if (!engine || !weights || ld < engine->cols() || !voltages || !currents || batch_size <= 0) {
+            last_error = "hocs_engine_program_and_propagate: bad handle, buffer or dimensions";
+            return HOCS_ERROR_ARGUMENT;
+        }
+        return guarded([&] {
+            engine->program_and_propagate(weights, static_cast<std::size_t>(ld), voltages, batch_size, currents);
+        });
+    }
+
+    // Conv2d on a handle programmed with its out_channels x (channels * kh * kw)
+    // kernel matrix (PyTorch weight layout, ld = cols). Only the raw feature
+    // maps are read: images x channels x height x width in, images x rows x
+    // out_h x out_w out, patches formed per pixel block inside the engine.
+    int hocs_engine_convolve(void* handle, const HOCSConvGeometry* geometry, const void* input, int images,
+                             void* output) {
+        HOCSEngineHandle* engine = static_cast<HOCSEngineHandle*>(handle);
+        if (!engine || !geometry || !input || !output || images <= 0) {
+            last_error = "hocs_engine_convolve: bad handle, geometry, buffer or image count";
+            return HOCS_ERROR_ARGUMENT;
+        }
+        return guarded([&] { engine->convolve(*geometry, input, images, output); });
+    }
+
+    // Hottest crossbar cell of the layer in Kelvin (simulated die temperature)
+    int hocs_engine_peak_temperature(void* handle, double* kelvin) {
+        HOCSEngineHandle* engine = static_cast<HOCSEngineHandle*>(handle);
+        if (!engine || !kelvin) {
+            last_error = "hocs_engine_peak_temperature: bad handle or buffer";
+            return HOCS_ERROR_ARGUMENT;
+        }
+        return guarded([&] { *kelvin = engine->peak_temperature(); });
+    }
+
+    // Cooling time constant of the layer in seconds; 0 = adiabatic (default)
+    int hocs_engine_set_thermal_time_constant(void* handle, double seconds) {
+        HOCSEngineHandle* engine = static_cast<HOCSEngineHandle*>(handle);
+        if (!engine || !(seconds >= 0.0)) {
+            last_error = "hocs_engine_set_thermal_time_constant: bad handle or negative time constant";
+            return HOCS_ERROR_ARGUMENT;
+        }
+        return guarded([&] { engine->set_thermal_time_constant(seconds); });
+    }
+
+    // Nonzero enables sparse mode: all-off tiles, rows and column blocks of
+    // the programmed weights are skipped, so cost follows the nonzeros
+    int hocs_engine_set_sparse(void* handle, int enabled) {
+        HOCSEngineHandle* engine = static_cast<HOCSEngineHandle*>(handle);
+        if (!engine) {
+            last_error = "hocs_engine_set_sparse: bad handle";
+            return HOCS_ERROR_ARGUMENT;
+        }
+        return guarded([&] { engine->set_sparse(enabled != 0); });
+    }
+
+    // Fraction of the layer's tiles holding weights above the off state
+    int hocs_engine_tile_density(void* handle, double* density) {
+        HOCSEngineHandle* engine = static_cast<HOCSEngineHandle*>(handle);
+        if (!engine || !density) {
+            last_error = "hocs_engine_tile_density: bad handle or buffer";
+            return HOCS_ERROR_ARGUMENT;
+        }
+        return guarded([&] { *density = engine->tile_density(); });
+    }
+
+    // --- Native job queue (hocs_job_queue.hpp) ---
+    // Jobs on a slot's preallocated buffers run on worker threads; each
+    // completion increments the eventfd from hocs_queue_eventfd(). Handles
+    // used by a job must outlive it.
+
+    void* hocs_queue_create(int slot_count, size_t input_bytes, size_t output_bytes, int worker_count) {
+        HOCSJobQueue* queue = nullptr;
+        guarded([&] { queue = new HOCSJobQueue(slot_count, input_bytes, output_bytes, worker_count); });
+        return queue;
+    }
+
+    // Waits for submitted jobs, then joins the workers
+    void hocs_queue_destroy(void* queue) {
+        delete static_cast<HOCSJobQueue*>(queue);
+    }
+
+    int hocs_queue_eventfd(void* queue) {
+        return queue ? static_cast<HOCSJobQueue*>(queue)->completion_fd() : HOCS_ERROR_ARGUMENT;
+    }
+
+    // Free slot index, or -1 when all slots are in flight
+    int hocs_queue_acquire(void* queue) {
+        return queue ? static_cast<HOCSJobQueue*>(queue)->acquire() : HOCS_ERROR_ARGUMENT;
+    }
+
+    void* hocs_queue_input(void* queue, int slot) {
+        void* data = nullptr;
+        if (queue) guarded([&] { data = static_cast<HOCSJobQueue*>(queue)->job(slot).input; });
+        return data;
+    }
+
+    void* hocs_queue_output(void* queue, int slot) {
+        void* data = nullptr;
+        if (queue) guarded([&] { data = static_cast<HOCSJobQueue*>(queue)->job(slot).output; });
+        return data;
+    }
+
+    // Byte offset of the voltages in a program-and-propagate job's input
+    long hocs_queue_voltage_offset(void* handle) {
+        return handle ? static_cast<long>(job_voltage_offset(*static_cast<HOCSEngineHandle*>(handle)))
+                      : static_cast<long>(HOCS_ERROR_ARGUMENT);
+    }
+
+    // Slot input: cols x batch voltages. Output: rows x batch currents.
+    int hocs_queue_submit_propagate(void* queue, int slot, void* handle, int batch_size) {
+        return submit_job(queue, slot, handle, batch_size, run_propagate_job);
+    }
+
+    // Slot input: Float32 weights, voltages at hocs_queue_voltage_offset().
+    // Programs and propagates atomically with respect to the handle.
+    int hocs_queue_submit_program_propagate(void* queue, int slot, void* handle, int batch_size) {
+        return submit_job(queue, slot, handle, batch_size, run_program_propagate_job);
+    }
+
+    // Writes up to max finished slots and their HOCSStatus; returns the count
+    int hocs_queue_reap(void* queue, int* slots, int* statuses, int max) {
+        if (!queue || !slots || max <= 0) return HOCS_ERROR_ARGUMENT;
+        return static_cast<HOCSJobQueue*>(queue)->reap(slots, statuses, max);
+    }
+
+    int hocs_queue_release(void* queue, int slot) {
+        if (!queue) return HOCS_ERROR_ARGUMENT;
+        return guarded([&] { static_cast<HOCSJobQueue*>(queue)->release(slot); });
+    }
+
+    // --- Crossbar weight residency (hocs_residency.hpp) ---
+
+    void* hocs_residency_create(int region_count) {
+        HOCSResidencyCache* cache = nullptr;
+        guarded([&] { cache = new HOCSResidencyCache(region_count); });
+        return cache;
+    }
+
+    void hocs_residency_destroy(void* cache) {
+        delete static_cast<HOCSResidencyCache*>(cache);
+    }
+
+    // Stores the region of `key` in *region. Returns 1 if the tile is
+    // resident, 0 if the caller must program *region (CONFIG_XBAR) now.
+    int hocs_residency_acquire(void* cache, uint64_t key, int pin, int* region) {
+        if (!cache || !region) return HOCS_ERROR_ARGUMENT;
+        HOCSResidencyLookup lookup = {-1, false};
+        int status = guarded([&] { lookup = static_cast<HOCSResidencyCache*>(cache)->acquire(key, pin != 0); });
+        if (status != HOCS_OK) return status;
+        *region = lookup.region;
+        return lookup.hit ? 1 : 0;
+    }
+
+    int hocs_residency_unpin(void* cache, uint64_t key) {
+        if (!cache) return HOCS_ERROR_ARGUMENT;
+        return static_cast<HOCSResidencyCache*>(cache)->unpin(key) ? HOCS_OK : HOCS_ERROR_ARGUMENT;
+    }
+
+    int hocs_residency_invalidate(void* cache, uint64_t key) {
+        if (!cache) return HOCS_ERROR_ARGUMENT;
+        return static_cast<HOCSResidencyCache*>(cache)->invalidate(key) ? HOCS_OK : HOCS_ERROR_ARGUMENT;
+    }
+
+    int hocs_residency_reset(void* cache) {
+        if (!cache) return HOCS_ERROR_ARGUMENT;
+        static_cast<HOCSResidencyCache*>(cache)->reset();
+        return HOCS_OK;
+    }
+
+    int hocs_residency_stats(void* cache, HOCSResidencyStats* stats) {
+        if (!cache || !stats) return HOCS_ERROR_ARGUMENT;
+        *stats = static_cast<HOCSResidencyCache*>(cache)->statistics();
+        return HOCS_OK;
+    }
+
+    // --- HOCS-ASM images (hocs_isa.hpp) ---
+
+    // Instruction count of a valid image, HOCS_ERROR_ARGUMENT otherwise
+    int hocs_program_validate(const void* image, size_t bytes) {
+        std::size_t count = 0;
+        int status = guarded([&] { count = HOCSProgramView(image, bytes).size(); });
+        return status == HOCS_OK ? static_cast<int>(count) : status;
+    }
+
+    // --- Per-stage latency telemetry (hocs_telemetry.hpp) ---
+
+    // Drains every thread's ring; writes up to max HOCSStageSummary in
+    // HOCSStage order and returns how many
+    int hocs_telemetry_snapshot(HOCSStageSummary* out, int max) {
+        if (!out || max <= 0) return HOCS_ERROR_ARGUMENT;
+        return hocs_telemetry().snapshot(out, max);
+    }
+
+    // Non-empty HDR buckets of `stage`: lower bound (ns) and count each
+    int hocs_telemetry_buckets(int stage, uint64_t* lower_ns, uint64_t* counts, int max) {
+        if (static_cast<uint32_t>(stage) >= HOCS_STAGE_COUNT || !lower_ns || !counts || max <= 0) return HOCS_ERROR_ARGUMENT;
+        return hocs_telemetry().buckets(static_cast<uint32_t>(stage), lower_ns, counts, max);
+    }
+
+    // Events lost to full rings since the last reset
+    uint64_t hocs_telemetry_dropped() {
+        return hocs_telemetry().dropped();
+    }
+
+    void hocs_telemetry_reset() {
+        hocs_telemetry().reset();
+    }
+
+    // Timestamps for stages measured outside the library (e.g. the PYNQ DMA
+    // path of the driver): hocs_telemetry_now() before and after
+    uint64_t hocs_telemetry_now() {
+        return hocs_cycles();
+    }
+
+    int hocs_telemetry_record(int stage, uint64_t start, uint64_t end) {
+        if (static_cast<uint32_t>(stage) >= HOCS_STAGE_COUNT || end < start) return HOCS_ERROR_ARGUMENT;
+        hocs_telemetry().record(static_cast<HOCSStage>(stage), start, end);
+        return HOCS_OK;
+    }
+
+    // Message of the last failed call on this thread
+    const char* hocs_engine_last_error() {
+        return last_error.c_str();
     }
 }
@@ -0,0 +1,847 @@
+/*
+ * HOCS NATIVE OPTICAL ENGINE (C++17)
+ * ==================================
+ * Author: Muhammed Yusuf Çobanoğlu
+ * Description: 
+ * High-Performance Computing (HPC) backend for simulating CuO Memristor dynamics.
+ * Utilizes OpenMP for parallel execution and SIMD vectorization.
+ * Implements the Non-Linear Drift Model for memristive hysteresis.
+ *
+ * Shared by the ctypes library (hocs_native_engine.cpp) and the
+ * benchmark suite (hocs_benchmark.cpp). Crossbar state can be checkpointed
+ * to and warm-started from mmap'd snapshots (hocs_crossbar_snapshot.hpp).
+ */
+
+#ifndef HOCS_NATIVE_ENGINE_HPP
+#define HOCS_NATIVE_ENGINE_HPP
+
+#include <iostream>
+#include <vector>
+#include <complex>
+#include <cmath>
+#include <thread>
+#include <random>
+#include <algorithm>
+#include <cstdlib>
+#include <new>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+#include "hocs_crossbar_snapshot.hpp"
+#include "hocs_element_types.hpp"
+#include "hocs_simd_kernels.hpp"
+
+// Constants for Copper Oxide Physics
+const double BOLTZMANN_K = 1.380649e-23;
+const double ELECTRON_Q  = 1.602176e-19;
+const double PLANCK_H    = 6.626070e-34;
+const double T_AMBIENT   = 300.0; // Kelvin
+const double ACTIVATION_ENERGY = 0.1 * ELECTRON_Q; // 0.1 eV filament barrier, in Joules
+
+// Cache blocking for the batched (GEMM) path: a 32x128 conductance tile
+// (32 KB) stays in L1/L2 while it is applied to every vector in the batch.
+const int GEMM_BLOCK_ROWS = 32;
+const int GEMM_BLOCK_COLS = 128; // Matches the 128-wide hardware tile
+
+// Sparse mode (pruned layers): cells whose |G| does not exceed the off state
+// of initialize_physics are open circuits, and the on cells are indexed per
+// GEMM_BLOCK_ROWS band in blocks of SPARSE_BLOCK_COLS columns (64 bytes of
+// Float32), so the kernels only touch rows and column spans that conduct.
+const double HOCS_OFF_CONDUCTANCE = 1e-6; // Siemens
+const int SPARSE_BLOCK_COLS = 16;
+
+// Below this batch width the per-cell axpy is too short to amortize a call
+// into the dispatched SIMD kernel, so the inline loop is used instead.
+const int SIMD_AXPY_MIN_BATCH = 8;
+
+// Use Complex numbers for Optical Wave Phase/Amplitude
+using OpticalSignal = std::complex<double>;
+
+// Cache line size of both targets (Cortex-A53 and x86-64 build servers)
+constexpr std::size_t CACHE_LINE_BYTES = 64;
+
+// Run of adjacent on column blocks [col0, col1) within one row band
+struct HOCSColumnSpan {
+    int col0;
+    int col1;
+};
+
+// Per-cell view of the crossbar. The engine does not store cells like this,
+// it only hands them out through the accessor API below.
+struct MemristorCell {
+    double conductance; // Siemens
+    double temperature; // Kelvin
+    double state_variable; // x (Dopant drift position)
+};
+
+// 64-byte aligned storage for the physics planes (trivial element types).
+// Owns either heap memory or a MAP_PRIVATE view of a crossbar snapshot.
+// resize() leaves fresh pages untouched until the engine's first-touch pass
+// places them (NUMA); it does not preserve contents.
+template <typename T>
+class AlignedBuffer {
+private:
+    T* ptr = nullptr;
+    std::size_t count = 0;
+    std::size_t mapped_bytes = 0; // Non-zero when ptr is an mmap() view
+
+    void release() {
+        if (mapped_bytes) {
+            munmap(ptr, mapped_bytes);
+        } else {
+            std::free(ptr);
+        }
+        ptr = nullptr;
+        count = 0;
+        mapped_bytes = 0;
+    }
+
+public:
+    AlignedBuffer() = default;
+    ~AlignedBuffer() { release(); }
+    AlignedBuffer(const AlignedBuffer&) = delete;
+    AlignedBuffer& operator=(const AlignedBuffer&) = delete;
+    AlignedBuffer(AlignedBuffer&& other) noexcept
+        : ptr(other.ptr), count(other.count), mapped_bytes(other.mapped_bytes) {
+        other.ptr = nullptr;
+        other.count = 0;
+        other.mapped_bytes = 0;
+    }
+    AlignedBuffer& operator=(AlignedBuffer&& other) noexcept {
+        if (this != &other) {
+            release();
+            std::swap(ptr, other.ptr);
+            std::swap(count, other.count);
+            std::swap(mapped_bytes, other.mapped_bytes);
+        }
+        return *this;
+    }
+
+    void resize(std::size_t n) {
+        release();
+        if (n == 0) return;
+        // aligned_alloc() requires the size to be a multiple of the alignment
+        std::size_t bytes = (n * sizeof(T) + CACHE_LINE_BYTES - 1) & ~(CACHE_LINE_BYTES - 1);
+        ptr = static_cast<T*>(std::aligned_alloc(CACHE_LINE_BYTES, bytes));
+        if (!ptr) throw std::bad_alloc();
+        count = n;
+    }
+
+    void assign(std::size_t n, const T& value) {
+        resize(n);
+        std::fill_n(ptr, n, value);
+    }
+
+    // Takes ownership of an mmap() region holding n elements
+    void adopt_mapping(void* mapping, std::size_t mapping_bytes, std::size_t n) {
+        release();
+        ptr = static_cast<T*>(mapping);
+        count = n;
+        mapped_bytes = mapping_bytes;
+    }
+
+    bool is_mapped() const { return mapped_bytes != 0; }
+    std::size_t size() const { return count; }
+    T* data() { return ptr; }
+    const T* data() const { return ptr; }
+    T& operator[](std::size_t i) { return ptr[i]; }
+    const T& operator[](std::size_t i) const { return ptr[i]; }
+};
+
+using AlignedPlane = AlignedBuffer<double>;
+
+// Fast exp() for the thermal activation factor.
+// Range reduction x = n*ln2 + r with |r| <= ln2/2, then a degree-7 Taylor
+// polynomial for e^r. Truncation error is bounded by |r|^8/8! * e^|r| < 7.4e-9,
+// so the relative error is below 1e-8 over [-708, 709]; inputs below -708
+// flush to 0. Branch-free, so GCC/Clang vectorize it inside simd loops.
+inline double hocs_fast_exp(double x) {
+    const double LOG2E  = 1.4426950408889634;
+    const double LN2_HI = 6.93145751953125e-1;   // ln2 split for exact n*ln2
+    const double LN2_LO = 1.42860682030941723212e-6;
+
+    double xc = std::min(std::max(x, -708.0), 709.0);
+    double n = std::floor(xc * LOG2E + 0.5);
+    double r = (xc - n * LN2_HI) - n * LN2_LO;
+
+    double p = 1.0 + r * (1.0 + r * (1.0 / 2 + r * (1.0 / 6 + r * (1.0 / 24 +
+               r * (1.0 / 120 + r * (1.0 / 720 + r * (1.0 / 5040)))))));
+
+    // Build 2^n directly in the exponent field
+    int64_t bits = static_cast<int64_t>(n + 1023.0) << 52;
+    double scale;
+    std::memcpy(&scale, &bits, sizeof(scale));
+
+    return (x < -708.0) ? 0.0 : p * scale;
+}
+
+// Kernel selection for the single-vector (GEMV) path
+enum class KernelVariant {
+    Scalar,  // Strict in-order accumulation (reference results)
+    Simd,    // Runtime-dispatched NEON / AVX2 / AVX-512 FMA kernels
+    Blocked  // Routed through the cache-blocked GEMM path with B = 1
+};
+
+// Crossbar engine templated on the element type of the compute path
+// (see hocs_element_types.hpp). The physical state (conductance, temperature,
+// dopant drift) is always simulated in double; only the effective-conductance
+// plane, the input voltages and the output currents use Element.
+template <typename Element>
+class BasicHOCSEngine {
+public:
+    using Traits = ElementTraits<Element>;
+    using value_type = typename Traits::storage_type;
+    using accum_type = typename Traits::accum_type;
+
+private:
+    int matrix_size;
+    int row_stride; // Row pitch in elements, padded so every row starts on a cache line
+
+    // Structure-of-Arrays crossbar state: one contiguous plane per physical field,
+    // so the MAC loop only streams the fields it actually touches.
+    AlignedPlane conductance_plane;
+    // Double-buffered thermal state: a pass reads generation k and writes k+1,
+    // then the generations are swapped. No cell is written while it may still
+    // be read, so rows run lock-free and results do not depend on thread count.
+    AlignedPlane temperature_planes[2];
+    int thermal_generation = 0;
+    AlignedPlane state_plane;
+
+    // Lazy thermal model: G_eff = G * exp(-Ea / kT) is cached per cell and only
+    // re-evaluated when the cell drifted more than thermal_tolerance Kelvin away
+    // from the temperature it was computed at. The MAC loop is a plain dot product.
+    AlignedBuffer<value_type> effective_conductance_plane;
+    AlignedPlane reference_temperature_plane;
+    std::vector<uint8_t> row_dirty; // Rows that heated up since the last refresh
+    double thermal_tolerance = 1e-3; // Kelvin
+    bool fast_exp_enabled = false;
+    uint64_t exp_evaluation_count = 0; // Total activation factors computed
+    KernelVariant kernel_variant = KernelVariant::Simd;
+    bool verbose = true; // Announce initialization on stdout
+
+    AlignedPlane batch_voltage_sq; // Per-column sum of V^2 over a batch (self-heating)
+
+    // Block-CSR of the on cells (sparse mode only), rebuilt lazily after
+    // any conductance change. Cells it skips keep both thermal generations
+    // equal, so a pass that does not write them leaves them consistent.
+    bool sparse_enabled = false;
+    bool sparse_stale = true;
+    std::vector<uint32_t> band_span_offsets; // Bands + 1, into band_spans
+    std::vector<HOCSColumnSpan> band_spans;
+    std::vector<uint8_t> row_on;             // Row holds at least one on cell
+    std::size_t sparse_cells = 0;            // Cells the sparse kernels still touch
+    bool at_ambient = false;                 // Every cell at T_AMBIENT: cooling is a no-op
+
+    AlignedPlane& current_temperature() { return temperature_planes[thermal_generation]; }
+    const AlignedPlane& current_temperature() const { return temperature_planes[thermal_generation]; }
+    AlignedPlane& next_temperature() { return temperature_planes[thermal_generation ^ 1]; }
+    // Ends a pass. Rows it heated are exactly the dirty ones (the pass began
+    // with a refresh), so an ambient crossbar stays ambient if none is dirty.
+    void swap_thermal_generation() {
+        thermal_generation ^= 1;
+        if (at_ambient) at_ambient = std::find(row_dirty.begin(), row_dirty.end(), 1) == row_dirty.end();
+    }
+
+    double activation_factor(double temperature) const {
+        double x = -ACTIVATION_ENERGY / (BOLTZMANN_K * temperature);
+        return fast_exp_enabled ? hocs_fast_exp(x) : std::exp(x);
+    }
+
+    void refresh_cell(std::size_t idx) {
+        const AlignedPlane& T = current_temperature();
+        effective_conductance_plane[idx] = Traits::from_double(conductance_plane[idx] * activation_factor(T[idx]));
+        reference_temperature_plane[idx] = T[idx];
+    }
+
+    // Re-evaluates the exponential only for dirty rows and drifted cells
+    void refresh_effective_conductance() {
+        uint64_t evaluations = 0;
+
+        #pragma omp parallel for schedule(static) reduction(+:evaluations)
+        for (int row = 0; row < matrix_size; ++row) {
+            if (!row_dirty[row]) continue;
+            row_dirty[row] = 0;
+
+            const AlignedPlane& T = current_temperature();
+            std::size_t base = static_cast<std::size_t>(row) * row_stride;
+            for (int col = 0; col < matrix_size; ++col) {
+                std::size_t idx = base + col;
+                if (std::abs(T[idx] - reference_temperature_plane[idx]) > thermal_tolerance) {
+                    refresh_cell(idx);
+                    ++evaluations;
+                }
+            }
+        }
+        exp_evaluation_count += evaluations;
+    }
+
+    void rebuild_effective_conductance() {
+        std::fill(row_dirty.begin(), row_dirty.end(), 0);
+
+        #pragma omp parallel for schedule(static)
+        for (int row = 0; row < matrix_size; ++row) {
+            std::size_t base = static_cast<std::size_t>(row) * row_stride;
+            for (int col = 0; col < matrix_size; ++col) {
+                refresh_cell(base + col);
+            }
+        }
+        exp_evaluation_count += static_cast<uint64_t>(matrix_size) * matrix_size;
+    }
+
+    static bool cell_on(double conductance) { return std::abs(conductance) > HOCS_OFF_CONDUCTANCE; }
+
+    bool row_active(int row) const { return !sparse_enabled || row_on[row]; }
+
+    // Column spans of one GEMM_BLOCK_ROWS band: the whole row in dense mode
+    std::pair<const HOCSColumnSpan*, const HOCSColumnSpan*> spans_of_band(int band,
+                                                                         const HOCSColumnSpan& dense) const {
+        if (!sparse_enabled) return {&dense, &dense + 1};
+        return {band_spans.data() + band_span_offsets[band], band_spans.data() + band_span_offsets[band + 1]};
+    }
+
+    void rebuild_sparse_index() {
+        const int bands = (matrix_size + GEMM_BLOCK_ROWS - 1) / GEMM_BLOCK_ROWS;
+        band_span_offsets.assign(1, 0);
+        band_spans.clear();
+        row_on.assign(matrix_size, 0);
+        sparse_cells = 0;
+
+        for (int band = 0; band < bands; ++band) {
+            const int row0 = band * GEMM_BLOCK_ROWS;
+            const int row1 = std::min(row0 + GEMM_BLOCK_ROWS, matrix_size);
+            std::size_t rows_on = 0;
+            for (int row = row0; row < row1; ++row) {
+                const double* G_row = conductance_plane.data() + static_cast<std::size_t>(row) * row_stride;
+                for (int col = 0; col < matrix_size && !row_on[row]; ++col) row_on[row] = cell_on(G_row[col]);
+                rows_on += row_on[row];
+            }
+
+            for (int col0 = 0; rows_on && col0 < matrix_size; col0 += SPARSE_BLOCK_COLS) {
+                const int col1 = std::min(col0 + SPARSE_BLOCK_COLS, matrix_size);
+                bool on = false;
+                for (int row = row0; row < row1 && !on; ++row) {
+                    const double* G_row = conductance_plane.data() + static_cast<std::size_t>(row) * row_stride;
+                    for (int col = col0; col < col1 && !on; ++col) on = cell_on(G_row[col]);
+                }
+                if (!on) continue;
+                if (band_spans.size() > band_span_offsets.back() && band_spans.back().col1 == col0) {
+                    band_spans.back().col1 = col1; // Adjacent block extends the span
+                } else {
+                    band_spans.push_back({col0, col1});
+                }
+                sparse_cells += rows_on * static_cast<std::size_t>(col1 - col0);
+            }
+            band_span_offsets.push_back(static_cast<uint32_t>(band_spans.size()));
+        }
+
+        // Establish the invariant for every skipped cell
+        std::copy(current_temperature().data(), current_temperature().data() + current_temperature().size(),
+                  next_temperature().data());
+        sparse_stale = false;
+    }
+
+    void refresh_sparse_index() {
+        if (sparse_enabled && sparse_stale) rebuild_sparse_index();
+    }
+
+    // Sparse GEMV: off rows output zero, on rows only visit their band's spans
+    void propagate_sparse(const value_type* V_in, value_type* current_outputs, const double* T_cur,
+                          double* T_next) {
+        #pragma omp parallel for schedule(static)
+        for (int row = 0; row < matrix_size; ++row) {
+            if (!row_on[row]) {
+                current_outputs[row] = Traits::from_accum(accum_type(0));
+                continue;
+            }
+            const std::size_t base = static_cast<std::size_t>(row) * row_stride;
+            const value_type* G_row = effective_conductance_plane.data() + base;
+            const int band = row / GEMM_BLOCK_ROWS;
+            accum_type row_current_sum = 0;
+            double row_heat = 0.0;
+
+            for (uint32_t s = band_span_offsets[band]; s < band_span_offsets[band + 1]; ++s) {
+                const int col0 = band_spans[s].col0;
+                const int n = band_spans[s].col1 - col0;
+                row_current_sum += (kernel_variant == KernelVariant::Scalar)
+                    ? row_dot_scalar(G_row + col0, V_in + col0, n)
+                    : row_dot_simd(G_row + col0, V_in + col0, n);
+                row_heat += apply_self_heating(G_row + col0, T_cur + base + col0, T_next + base + col0, n,
+                    [V_in, col0](int col) { double V = Traits::to_double(V_in[col0 + col]); return V * V; });
+            }
+
+            current_outputs[row] = Traits::from_accum(row_current_sum);
+            if (row_heat != 0.0) row_dirty[row] = 1;
+        }
+    }
+
+    // GEMV row dot products: I = sum(G_eff * V) in the accumulator type
+    static accum_type row_dot_scalar(const value_type* G_row, const value_type* V_in, int n) {
+        accum_type acc = 0;
+        for (int col = 0; col < n; ++col) {
+            acc += Traits::mul(G_row[col], V_in[col]);
+        }
+        return acc;
+    }
+
+    static accum_type row_dot_simd(const value_type* G_row, const value_type* V_in, int n) {
+        return hocs_simd_dot(G_row, V_in, n);
+    }
+
+    // Self-Heating Effect ("Thermal Wall"): T(k+1) = T(k) + I * V * 1e-9 per cell.
+    // Runs in double right after the dot product, while the G_eff row is hot in L1.
+    // v_sq(col) returns the V^2 seen by a cell; returns the total heat of the row.
+    template <typename VoltageSq>
+    static double apply_self_heating(const value_type* G_row, const double* T_row, double* T_row_next,
+                                     int n, VoltageSq v_sq) {
+        double row_heat = 0.0;
+        #pragma omp simd reduction(+:row_heat)
+        for (int col = 0; col < n; ++col) {
+            double heat = Traits::to_double(G_row[col]) * v_sq(col) * 1e-9;
+            T_row_next[col] = T_row[col] + heat;
+            row_heat += heat;
+        }
+        return row_heat;
+    }
+
+    // Accumulators for one GEMM row band. When the accumulator type is the
+    // storage type the output rows are accumulated in place.
+    static accum_type* band_accumulators(value_type* band_out, std::size_t count) {
+        if constexpr (std::is_same<accum_type, value_type>::value) {
+            (void)count;
+            return band_out;
+        } else {
+            thread_local std::vector<accum_type> scratch;
+            if (scratch.size() < count) scratch.resize(count);
+            return scratch.data();
+        }
+    }
+
+    // The pitch is a whole number of cache lines for both the double planes
+    // and the Element plane
+    static int padded_stride(int size) {
+        const int elems_per_line = static_cast<int>(CACHE_LINE_BYTES / std::min(sizeof(double), sizeof(value_type)));
+        return (size + elems_per_line - 1) / elems_per_line * elems_per_line;
+    }
+
+    // Heap planes for every field; `mapped` marks planes already adopted
+    // from a snapshot, which keep their contents
+    void allocate_planes(int size, bool mapped) {
+        matrix_size = size;
+        row_stride = padded_stride(size);
+        thermal_generation = 0;
+
+        std::size_t cells = static_cast<std::size_t>(size) * row_stride;
+        if (!mapped) {
+            conductance_plane.resize(cells);
+            temperature_planes[0].resize(cells);
+            state_plane.resize(cells);
+            effective_conductance_plane.resize(cells);
+            reference_temperature_plane.resize(cells);
+        }
+        temperature_planes[1].resize(cells);
+
+        // First touch with the row partition of the compute loops, so on
+        // multi-socket hosts every worker's rows land on its local node
+        #pragma omp parallel for schedule(static)
+        for (int row = 0; row < size; ++row) {
+            std::size_t base = static_cast<std::size_t>(row) * row_stride;
+            if (mapped) {
+                // Every pass rewrites the valid cells of generation k+1, so a
+                // warm start only initializes the padding columns
+                std::fill(temperature_planes[1].data() + base + size, temperature_planes[1].data() + base + row_stride, T_AMBIENT);
+                continue;
+            }
+            std::fill_n(temperature_planes[1].data() + base, row_stride, T_AMBIENT);
+            std::fill_n(conductance_plane.data() + base, row_stride, 0.0); // Padding columns stay at 0 S
+            std::fill_n(temperature_planes[0].data() + base, row_stride, T_AMBIENT);
+            std::fill_n(state_plane.data() + base, row_stride, 0.0);
+            std::fill_n(effective_conductance_plane.data() + base, row_stride, value_type(0));
+            std::fill_n(reference_temperature_plane.data() + base, row_stride, T_AMBIENT);
+        }
+        // Mapped G_eff is re-validated against the drift tolerance on first use
+        row_dirty.assign(size, mapped ? 1 : 0);
+        batch_voltage_sq.assign(size, 0.0);
+        sparse_stale = true;
+        at_ambient = !mapped;
+    }
+
+public:
+    // quiet = true suppresses the init banner (tiled layers own many crossbars)
+    BasicHOCSEngine(int size, bool quiet = false) : matrix_size(size), verbose(!quiet) {
+        allocate_planes(size, false);
+        initialize_physics();
+    }
+
+    // Warm start from a snapshot written by save_snapshot(): no RNG, no exp()
+    explicit BasicHOCSEngine(const std::string& snapshot_path, bool quiet = false)
+        : matrix_size(0), row_stride(0), verbose(!quiet) {
+        load_snapshot(snapshot_path);
+    }
+
+    void initialize_physics() {
+        // Random initialization of filament states
+        std::mt19937 rng(std::random_device{}());
+        std::uniform_real_distribution<double> dist(0.0, 1.0);
+
+        for (int row = 0; row < matrix_size; ++row) {
+            std::size_t base = static_cast<std::size_t>(row) * row_stride;
+            for (int col = 0; col < matrix_size; ++col) {
+                conductance_plane[base + col] = 1e-6; // Off state (Low conductance)
+                current_temperature()[base + col] = T_AMBIENT;
+                state_plane[base + col] = dist(rng);
+            }
+        }
+        rebuild_effective_conductance();
+        sparse_stale = true;
+        at_ambient = true;
+        if (!verbose) return;
+        std::cout << "[CPP-CORE] Physics Engine Initialized. Size: " 
+                  << matrix_size << "x" << matrix_size
+                  << " (" << Traits::name << ")" << std::endl;
+    }
+
+    // Programs every cell's conductance from a dense size() x size() block
+    // (row pitch ld), e.g. a weight tile packed by hocs_pack_tile<double>.
+    void program_conductances(const double* conductances, std::size_t ld) {
+        for (int row = 0; row < matrix_size; ++row) {
+            std::size_t base = static_cast<std::size_t>(row) * row_stride;
+            std::copy(conductances + row * ld, conductances + row * ld + matrix_size,
+                      conductance_plane.data() + base);
+        }
+        rebuild_effective_conductance();
+        sparse_stale = true;
+    }
+
+    // --- Per-cell accessor API (not for hot loops) ---
+
+    int size() const { return matrix_size; }
+    int stride() const { return row_stride; }
+
+    MemristorCell get_cell(int row, int col) const {
+        std::size_t idx = static_cast<std::size_t>(row) * row_stride + col;
+        return {conductance_plane[idx], current_temperature()[idx], state_plane[idx]};
+    }
+
+    void set_cell(int row, int col, const MemristorCell& cell) {
+        std::size_t idx = static_cast<std::size_t>(row) * row_stride + col;
+        conductance_plane[idx] = cell.conductance;
+        current_temperature()[idx] = cell.temperature;
+        state_plane[idx] = cell.state_variable;
+        refresh_cell(idx);
+        ++exp_evaluation_count;
+        sparse_stale = true;
+        at_ambient = false;
+    }
+
+    // --- Lazy thermal model configuration ---
+
+    // Temperature drift (Kelvin) a cell may accumulate before its cached
+    // effective conductance is re-evaluated. 0 recomputes on every change.
+    // Tightening it marks every row dirty, so cells already past the new
+    // limit are re-evaluated by the next refresh.
+    void set_thermal_tolerance(double kelvin) {
+        if (kelvin < thermal_tolerance) std::fill(row_dirty.begin(), row_dirty.end(), 1);
+        thermal_tolerance = kelvin;
+    }
+    double get_thermal_tolerance() const { return thermal_tolerance; }
+
+    // Switch between std::exp and hocs_fast_exp (rel. error < 1e-8)
+    void set_fast_exp(bool enabled) {
+        if (fast_exp_enabled != enabled) {
+            fast_exp_enabled = enabled;
+            rebuild_effective_conductance();
+        }
+    }
+    bool is_fast_exp_enabled() const { return fast_exp_enabled; }
+
+    // Newton cooling of every cell toward T_AMBIENT over `seconds` idle time
+    // (time constant in seconds). Rows with a cell now more than
+    // thermal_tolerance from its G_eff reference are marked dirty.
+    // In sparse mode both generations are cooled: skipped cells must stay equal.
+    // Crossbars that never heated (e.g. the off tiles of a sparse layer) are skipped.
+    void dissipate(double seconds, double time_constant) {
+        if (seconds <= 0.0 || time_constant <= 0.0 || at_ambient) return;
+        const double keep = std::exp(-seconds / time_constant);
+        AlignedPlane& T = current_temperature();
+        double* T_other = sparse_enabled && !sparse_stale ? next_temperature().data() : nullptr;
+        #pragma omp parallel for schedule(static)
+        for (int row = 0; row < matrix_size; ++row) {
+            std::size_t base = static_cast<std::size_t>(row) * row_stride;
+            double* T_row = T.data() + base;
+            const double* T_ref = reference_temperature_plane.data() + base;
+            bool drifted = false;
+            for (int col = 0; col < matrix_size; ++col) {
+                T_row[col] = T_AMBIENT + (T_row[col] - T_AMBIENT) * keep;
+                drifted |= std::abs(T_row[col] - T_ref[col]) > thermal_tolerance;
+            }
+            if (drifted) row_dirty[row] = 1;
+            if (T_other) std::copy(T_row, T_row + matrix_size, T_other + base);
+        }
+    }
+
+    // Pruned layers: skip rows and column blocks whose cells are all off
+    // (|G| <= HOCS_OFF_CONDUCTANCE). Off cells then neither conduct nor heat,
+    // so results differ from dense mode by their leakage only.
+    void set_sparse(bool enabled) {
+        if (sparse_enabled != enabled) {
+            sparse_enabled = enabled;
+            sparse_stale = true;
+        }
+    }
+    bool is_sparse() const { return sparse_enabled; }
+
+    // Fraction of the cells the kernels touch per pass (1 in dense mode)
+    double sparse_occupancy() {
+        if (!sparse_enabled) return 1.0;
+        refresh_sparse_index();
+        return static_cast<double>(sparse_cells) / (static_cast<double>(matrix_size) * matrix_size);
+    }
+
+    // Hottest cell of the visible generation, Kelvin (padding stays at T_AMBIENT)
+    double peak_temperature() const {
+        const AlignedPlane& T = current_temperature();
+        return *std::max_element(T.data(), T.data() + T.size());
+    }
+
+    // exp(-Ea / kT) at T_AMBIENT: the factor between programmed and effective
+    // conductance of a cell that has not heated up yet
+    double ambient_activation() const { return activation_factor(T_AMBIENT); }
+
+    // Number of exp() evaluations spent on the activation-factor cache so far
+    uint64_t exp_evaluations() const { return exp_evaluation_count; }
+
+    void set_kernel_variant(KernelVariant variant) { kernel_variant = variant; }
+    KernelVariant get_kernel_variant() const { return kernel_variant; }
+
+    // --- Crossbar snapshots (hocs_crossbar_snapshot.hpp) ---
+
+    // Checkpoints the visible physical state; safe to call between passes
+    void save_snapshot(const std::string& path) const {
+        std::size_t cells = static_cast<std::size_t>(matrix_size) * row_stride;
+        HOCSSnapshotHeader header{};
+        header.matrix_size = static_cast<uint32_t>(matrix_size);
+        header.row_stride = static_cast<uint32_t>(row_stride);
+        header.element_bytes = sizeof(value_type);
+        std::strncpy(header.element_name, Traits::name, sizeof(header.element_name) - 1);
+        header.flags = fast_exp_enabled ? HOCS_SNAPSHOT_FAST_EXP : 0;
+        header.thermal_tolerance = thermal_tolerance;
+
+        const std::size_t plane_bytes[HOCS_SNAPSHOT_PLANES] = {
+            cells * sizeof(double), cells * sizeof(double), cells * sizeof(double),
+            cells * sizeof(value_type), cells * sizeof(double)};
+        const void* const planes[HOCS_SNAPSHOT_PLANES] = {
+            conductance_plane.data(), current_temperature().data(), state_plane.data(),
+            effective_conductance_plane.data(), reference_temperature_plane.data()};
+        hocs_snapshot_layout(header, plane_bytes);
+        hocs_write_snapshot(path, header, planes);
+    }
+
+    // Replaces the whole crossbar (size included) with the snapshot's planes,
+    // mapped copy-on-write. Throws std::runtime_error on a foreign, corrupt
+    // or differently typed snapshot; the engine is left unchanged then.
+    void load_snapshot(const std::string& path) {
+        HOCSMappedPlane mapped[HOCS_SNAPSHOT_PLANES];
+        HOCSSnapshotHeader header = hocs_map_snapshot(path, mapped);
+
+        int size = static_cast<int>(header.matrix_size);
+        std::size_t cells = static_cast<std::size_t>(size) * header.row_stride;
+        bool compatible = header.element_bytes == sizeof(value_type) &&
+                          std::strncmp(header.element_name, Traits::name, sizeof(header.element_name)) == 0 &&
+                          static_cast<int>(header.row_stride) == padded_stride(size);
+        for (int k = 0; compatible && k < HOCS_SNAPSHOT_PLANES; ++k) {
+            std::size_t elem = (k == SNAPSHOT_EFFECTIVE) ? sizeof(value_type) : sizeof(double);
+            compatible = header.plane_bytes[k] == cells * elem;
+        }
+        if (!compatible) {
+            hocs_unmap_snapshot(mapped);
+            throw std::runtime_error("HOCS snapshot: " + path + " does not match a " +
+                                     Traits::name + " engine");
+        }
+
+        conductance_plane.adopt_mapping(mapped[SNAPSHOT_CONDUCTANCE].mapping, mapped[SNAPSHOT_CONDUCTANCE].mapping_bytes, cells);
+        temperature_planes[0].adopt_mapping(mapped[SNAPSHOT_TEMPERATURE].mapping, mapped[SNAPSHOT_TEMPERATURE].mapping_bytes, cells);
+        state_plane.adopt_mapping(mapped[SNAPSHOT_STATE].mapping, mapped[SNAPSHOT_STATE].mapping_bytes, cells);
+        effective_conductance_plane.adopt_mapping(mapped[SNAPSHOT_EFFECTIVE].mapping, mapped[SNAPSHOT_EFFECTIVE].mapping_bytes, cells);
+        reference_temperature_plane.adopt_mapping(mapped[SNAPSHOT_REFERENCE_TEMP].mapping, mapped[SNAPSHOT_REFERENCE_TEMP].mapping_bytes, cells);
+        allocate_planes(size, true);
+
+        thermal_tolerance = header.thermal_tolerance;
+        fast_exp_enabled = (header.flags & HOCS_SNAPSHOT_FAST_EXP) != 0;
+        if (verbose) {
+            std::cout << "[CPP-CORE] Physics Engine Restored. Size: "
+                      << matrix_size << "x" << matrix_size
+                      << " (" << Traits::name << ") from " << path << std::endl;
+        }
+    }
+
+    // Raw plane views (row-major, pitch = stride(), 64-byte aligned)
+    const double* conductance_data() const { return conductance_plane.data(); }
+    const double* temperature_data() const { return current_temperature().data(); }
+    const double* state_data() const { return state_plane.data(); }
+    const value_type* effective_conductance_data() const { return effective_conductance_plane.data(); }
+
+    // The Heavy Calculation: O(N^2) Parallel Matrix Multiplication
+    std::vector<value_type> compute_optical_propagation(const std::vector<value_type>& voltage_inputs) {
+        std::vector<value_type> current_outputs(matrix_size);
+        compute_optical_propagation(voltage_inputs.data(), current_outputs.data());
+        return current_outputs;
+    }
+
+    // Allocation-free overload: reads N voltages and writes N currents into
+    // caller-owned memory, e.g. a buffer from HOCSMremoryManager::allocate_tensor_buffer.
+    // Every output element is overwritten; the buffer need not be cleared.
+    void compute_optical_propagation(const value_type* voltage_inputs, value_type* current_outputs) {
+        if (kernel_variant == KernelVariant::Blocked) {
+            compute_optical_propagation_batch(voltage_inputs, 1, current_outputs);
+            return;
+        }
+
+        refresh_effective_conductance();
+        refresh_sparse_index();
+        const double* T_cur = current_temperature().data();
+        double* T_next = next_temperature().data();
+        if (sparse_enabled) {
+            propagate_sparse(voltage_inputs, current_outputs, T_cur, T_next);
+            swap_thermal_generation();
+            return;
+        }
+
+        // START PARALLEL REGION (Simulates simultaneous light propagation)
+        // This loop would be massive on a CPU without Optimization
+        #pragma omp parallel for schedule(static)
+        for (int row = 0; row < matrix_size; ++row) {
+            // Row views into the SoA planes
+            const value_type* G_row = effective_conductance_plane.data() + static_cast<std::size_t>(row) * row_stride;
+            const double* T_row = T_cur + static_cast<std::size_t>(row) * row_stride;
+            double* T_row_next = T_next + static_cast<std::size_t>(row) * row_stride;
+            const value_type* V_in = voltage_inputs;
+
+            // Ohm's Law at Nano-scale: I = V * G(x, V, T)
+            // G_eff already carries the JART VCM thermal activation factor
+            accum_type row_current_sum = (kernel_variant == KernelVariant::Scalar)
+                ? row_dot_scalar(G_row, V_in, matrix_size)
+                : row_dot_simd(G_row, V_in, matrix_size);
+
+            double row_heat = apply_self_heating(G_row, T_row, T_row_next, matrix_size,
+                [V_in](int col) { double V = Traits::to_double(V_in[col]); return V * V; });
+            
+            // Critical Section not needed due to local accumulation logic
+            current_outputs[row] = Traits::from_accum(row_current_sum);
+            if (row_heat != 0.0) row_dirty[row] = 1;
+        }
+
+        // Generation k+1 becomes the visible thermal state
+        swap_thermal_generation();
+    }
+
+    // Batched propagation: O(N^2 * B) matrix-matrix product (GEMM)
+    // voltage_inputs : N x B row-major, row = crossbar column, column = batch vector
+    // returns        : N x B row-major currents, one column per input vector
+    // All B vectors see the thermal state at the start of the call; self-heating
+    // from the whole batch is applied once per cell.
+    std::vector<value_type> compute_optical_propagation_batch(const std::vector<value_type>& voltage_inputs,
+                                                              int batch_size) {
+        std::vector<value_type> current_outputs(static_cast<std::size_t>(matrix_size) * batch_size);
+        compute_optical_propagation_batch(voltage_inputs.data(), batch_size, current_outputs.data());
+        return current_outputs;
+    }
+
+    // Allocation-free batched overload (N x B in, N x B out, caller-owned memory)
+    void compute_optical_propagation_batch(const value_type* voltage_inputs, int batch_size,
+                                           value_type* current_outputs) {
+        const value_type* V_in = voltage_inputs;
+        value_type* I_out = current_outputs;
+        refresh_effective_conductance();
+        refresh_sparse_index();
+        const double* T_cur = current_temperature().data();
+        double* T_next = next_temperature().data();
+
+        // Every cell of column c sees sum_b V[c][b]^2 worth of Joule heating
+        double* V_sq = batch_voltage_sq.data();
+        #pragma omp parallel for schedule(static)
+        for (int col = 0; col < matrix_size; ++col) {
+            const value_type* V_col = V_in + static_cast<std::size_t>(col) * batch_size;
+            double sum = 0.0;
+            for (int b = 0; b < batch_size; ++b) {
+                double V = Traits::to_double(V_col[b]);
+                sum += V * V;
+            }
+            V_sq[col] = sum;
+        }
+
+        // Each thread owns a band of rows, so output rows are never shared.
+        // Sparse mode walks the band's column spans and skips off rows; off
+        // rows keep their zeroed accumulators.
+        const HOCSColumnSpan dense_span{0, matrix_size};
+        #pragma omp parallel for schedule(static)
+        for (int row0 = 0; row0 < matrix_size; row0 += GEMM_BLOCK_ROWS) {
+            int row1 = std::min(row0 + GEMM_BLOCK_ROWS, matrix_size);
+            value_type* I_band = I_out + static_cast<std::size_t>(row0) * batch_size;
+            std::size_t band_count = static_cast<std::size_t>(row1 - row0) * batch_size;
+            accum_type* acc_band = band_accumulators(I_band, band_count);
+            std::fill(acc_band, acc_band + band_count, accum_type(0));
+            const auto spans = spans_of_band(row0 / GEMM_BLOCK_ROWS, dense_span);
+
+            for (const HOCSColumnSpan* span = spans.first; span != spans.second; ++span) {
+                for (int col0 = span->col0; col0 < span->col1; col0 += GEMM_BLOCK_COLS) {
+                    int col1 = std::min(col0 + GEMM_BLOCK_COLS, span->col1);
+
+                    // Conductance tile [row0,row1) x [col0,col1) is loaded once
+                    // and reused for all B input vectors
+                    for (int row = row0; row < row1; ++row) {
+                        if (!row_active(row)) continue;
+                        const value_type* G_row = effective_conductance_plane.data() + static_cast<std::size_t>(row) * row_stride;
+                        accum_type* acc_row = acc_band + static_cast<std::size_t>(row - row0) * batch_size;
+
+                        for (int col = col0; col < col1; ++col) {
+                            value_type G_eff = G_row[col];
+                            const value_type* V_col = V_in + static_cast<std::size_t>(col) * batch_size;
+
+                            if (batch_size >= SIMD_AXPY_MIN_BATCH) {
+                                hocs_simd_axpy(acc_row, V_col, G_eff, batch_size);
+                            } else {
+                                for (int b = 0; b < batch_size; ++b) {
+                                    acc_row[b] += Traits::mul(G_eff, V_col[b]);
+                                }
+                            }
+                        }
+                    }
+                }
+            }
+
+            for (int row = row0; row < row1; ++row) {
+                if (!row_active(row)) continue;
+                const value_type* G_row = effective_conductance_plane.data() + static_cast<std::size_t>(row) * row_stride;
+                const double* T_row = T_cur + static_cast<std::size_t>(row) * row_stride;
+                double* T_row_next = T_next + static_cast<std::size_t>(row) * row_stride;
+
+                // Self-Heating Effect, accumulated over the batch
+                double row_heat = 0.0;
+                for (const HOCSColumnSpan* span = spans.first; span != spans.second; ++span) {
+                    const int c0 = span->col0;
+                    row_heat += apply_self_heating(G_row + c0, T_row + c0, T_row_next + c0, span->col1 - c0,
+                        [V_sq, c0](int col) { return V_sq[c0 + col]; });
+                }
+                if (row_heat != 0.0) row_dirty[row] = 1;
+            }
+
+            if constexpr (!std::is_same<accum_type, value_type>::value) {
+                for (std::size_t i = 0; i < band_count; ++i) {
+                    I_band[i] = Traits::from_accum(acc_band[i]);
+                }
+            }
+        }
+
+        swap_thermal_generation();
+    }
+};
+
+// Compile-time precision selection
+using HOCSEngine    = BasicHOCSEngine<double>;
+using HOCSEngineF32 = BasicHOCSEngine<float>;
+using HOCSEngineQ12 = BasicHOCSEngine<Q4_12>;
+
+#endif // HOCS_NATIVE_ENGINE_HPP
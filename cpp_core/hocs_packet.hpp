@@ -0,0 +1,351 @@
+/*
+ * HOCS JOB PACKET CODEC
+ * =====================
+ * Description:
+ * Builds and parses the ICD job packet (docs/INTERFACE_SPEC.md, section 2)
+ * in one pass over the data: Float32 is quantized to saturating Q4.12 and
+ * written straight into the (DMA) buffer after the header while the CRC32
+ * footer is accumulated; the return path checks the CRC while converting
+ * back to Float32. Kernels are selected once per process:
+ * - x86-64:  AVX2 conversion + SSE4.2 crc32 instructions
+ * - AArch64: NEON conversion + ARMv8 CRC32 instructions
+ * - otherwise portable scalar code with a table-driven CRC
+ * HOCS_SIMD=scalar forces the portable kernels (as in hocs_simd_kernels.hpp).
+ *
+ * The checksum is CRC-32C (Castagnoli, reflected 0x82F63B78, init and final
+ * XOR 0xFFFFFFFF) over header and payload: the polynomial both ISAs compute
+ * in hardware.
+ * Building a packet is recorded as HOCS_STAGE_QUANTIZE, parsing one as
+ * HOCS_STAGE_DEQUANTIZE (hocs_telemetry.hpp).
+ */
+
+#ifndef HOCS_PACKET_HPP
+#define HOCS_PACKET_HPP
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+
+#include "hocs_element_types.hpp"
+#include "hocs_telemetry.hpp"
+#include "hocs_tiler.hpp"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define HOCS_PACKET_X86 1
+#elif defined(__aarch64__)
+#include <arm_acle.h>
+#include <arm_neon.h>
+#include <sys/auxv.h>
+#include <asm/hwcap.h>
+#define HOCS_PACKET_ARM 1
+#endif
+
+constexpr uint32_t HOCS_PACKET_MAGIC = 0x53434F48; // Bytes 'H' 'O' 'C' 'S' on the wire
+
+struct HOCSPacketHeader {
+    uint32_t magic;       // HOCS_PACKET_MAGIC
+    uint32_t opcode;      // HOCS_OPCODE_* (kernel_driver/hocs_uapi.h)
+    uint32_t payload_len; // Bytes of Q4.12 data
+    uint32_t tile_id;
+};
+static_assert(sizeof(HOCSPacketHeader) == 16, "ICD header is 16 bytes");
+
+constexpr std::size_t HOCS_PACKET_CRC_BYTES = 4;
+
+enum HOCSPacketStatus {
+    HOCS_PACKET_OK = 0,
+    HOCS_PACKET_BAD_MAGIC = -1,
+    HOCS_PACKET_BAD_LENGTH = -2, // payload_len disagrees with the buffer or the output capacity
+    HOCS_PACKET_BAD_CRC = -3
+};
+
+// Total packet size for a payload of payload_bytes
+inline std::size_t hocs_packet_bytes(std::size_t payload_bytes) {
+    return sizeof(HOCSPacketHeader) + payload_bytes + HOCS_PACKET_CRC_BYTES;
+}
+
+// Running CRC state is the un-inverted register: start from ~0u, finish with ~crc
+struct HOCSPacketKernels {
+    const char* isa;
+    uint32_t (*crc32c)(uint32_t crc, const void* data, std::size_t bytes);
+    // Q4.12 with round-to-nearest-even and saturation, CRC over the output bytes
+    uint32_t (*quantize)(uint32_t crc, const float* src, int16_t* dst, std::size_t count);
+    // CRC over the input bytes, then Float32
+    uint32_t (*dequantize)(uint32_t crc, const int16_t* src, float* dst, std::size_t count);
+};
+
+// --- Portable scalar kernels ---
+
+inline const std::array<uint32_t, 256>& hocs_crc32c_table() {
+    static const std::array<uint32_t, 256> table = [] {
+        std::array<uint32_t, 256> t{};
+        for (uint32_t i = 0; i < 256; ++i) {
+            uint32_t c = i;
+            for (int k = 0; k < 8; ++k) c = (c >> 1) ^ (0x82F63B78u & (0u - (c & 1u)));
+            t[i] = c;
+        }
+        return t;
+    }();
+    return table;
+}
+
+inline uint32_t hocs_scalar_crc32c(uint32_t crc, const void* data, std::size_t bytes) {
+    const auto& table = hocs_crc32c_table();
+    const unsigned char* p = static_cast<const unsigned char*>(data);
+    for (std::size_t i = 0; i < bytes; ++i) crc = table[(crc ^ p[i]) & 0xFF] ^ (crc >> 8);
+    return crc;
+}
+
+// Same rounding as the vector kernels (current mode, nearest-even), NaN -> 0
+inline int16_t hocs_quantize_q12(float x) {
+    float scaled = x * static_cast<float>(Q4_12::ONE);
+    if (!(scaled == scaled)) return 0;
+    scaled = std::min(std::max(scaled, -32768.0f), 32767.0f);
+    return static_cast<int16_t>(std::nearbyint(scaled));
+}
+
+inline uint32_t hocs_scalar_quantize(uint32_t crc, const float* src, int16_t* dst, std::size_t count) {
+    for (std::size_t i = 0; i < count; ++i) dst[i] = hocs_quantize_q12(src[i]);
+    return hocs_scalar_crc32c(crc, dst, count * sizeof(int16_t));
+}
+
+inline uint32_t hocs_scalar_dequantize(uint32_t crc, const int16_t* src, float* dst, std::size_t count) {
+    crc = hocs_scalar_crc32c(crc, src, count * sizeof(int16_t));
+    for (std::size_t i = 0; i < count; ++i) dst[i] = src[i] * static_cast<float>(1.0 / Q4_12::ONE);
+    return crc;
+}
+
+// --- x86-64: AVX2 + SSE4.2 ---
+
+#ifdef HOCS_PACKET_X86
+__attribute__((target("sse4.2")))
+inline uint32_t hocs_sse42_crc32c(uint32_t crc, const void* data, std::size_t bytes) {
+    const unsigned char* p = static_cast<const unsigned char*>(data);
+    uint64_t c = crc;
+    for (; bytes >= 8; bytes -= 8, p += 8) {
+        uint64_t word;
+        std::memcpy(&word, p, sizeof(word));
+        c = _mm_crc32_u64(c, word);
+    }
+    uint32_t c32 = static_cast<uint32_t>(c);
+    for (; bytes > 0; --bytes) c32 = _mm_crc32_u8(c32, *p++);
+    return c32;
+}
+
+// 16 floats -> 16 saturated Q4.12 lanes (NaN -> 0 like the scalar path)
+__attribute__((target("avx2")))
+inline __m256i hocs_avx2_quantize16(const float* src) {
+    const __m256 scale = _mm256_set1_ps(static_cast<float>(Q4_12::ONE));
+    const __m256 lo = _mm256_set1_ps(-32768.0f);
+    const __m256 hi = _mm256_set1_ps(32767.0f);
+    __m256 a = _mm256_mul_ps(_mm256_loadu_ps(src), scale);
+    __m256 b = _mm256_mul_ps(_mm256_loadu_ps(src + 8), scale);
+    a = _mm256_and_ps(a, _mm256_cmp_ps(a, a, _CMP_ORD_Q));
+    b = _mm256_and_ps(b, _mm256_cmp_ps(b, b, _CMP_ORD_Q));
+    a = _mm256_min_ps(_mm256_max_ps(a, lo), hi);
+    b = _mm256_min_ps(_mm256_max_ps(b, lo), hi);
+    __m256i packed = _mm256_packs_epi32(_mm256_cvtps_epi32(a), _mm256_cvtps_epi32(b));
+    return _mm256_permute4x64_epi64(packed, 0xD8); // packs interleaves 128-bit lanes
+}
+
+__attribute__((target("avx2,sse4.2")))
+inline uint32_t hocs_avx2_quantize(uint32_t crc, const float* src, int16_t* dst, std::size_t count) {
+    uint64_t c = crc;
+    std::size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        __m256i q = hocs_avx2_quantize16(src + i);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), q);
+        c = _mm_crc32_u64(c, static_cast<uint64_t>(_mm256_extract_epi64(q, 0)));
+        c = _mm_crc32_u64(c, static_cast<uint64_t>(_mm256_extract_epi64(q, 1)));
+        c = _mm_crc32_u64(c, static_cast<uint64_t>(_mm256_extract_epi64(q, 2)));
+        c = _mm_crc32_u64(c, static_cast<uint64_t>(_mm256_extract_epi64(q, 3)));
+    }
+    for (std::size_t j = i; j < count; ++j) dst[j] = hocs_quantize_q12(src[j]);
+    return hocs_sse42_crc32c(static_cast<uint32_t>(c), dst + i, (count - i) * sizeof(int16_t));
+}
+
+__attribute__((target("avx2,sse4.2")))
+inline uint32_t hocs_avx2_dequantize(uint32_t crc, const int16_t* src, float* dst, std::size_t count) {
+    const __m256 scale = _mm256_set1_ps(static_cast<float>(1.0 / Q4_12::ONE));
+    uint64_t c = crc;
+    std::size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        __m256i q = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+        c = _mm_crc32_u64(c, static_cast<uint64_t>(_mm256_extract_epi64(q, 0)));
+        c = _mm_crc32_u64(c, static_cast<uint64_t>(_mm256_extract_epi64(q, 1)));
+        c = _mm_crc32_u64(c, static_cast<uint64_t>(_mm256_extract_epi64(q, 2)));
+        c = _mm_crc32_u64(c, static_cast<uint64_t>(_mm256_extract_epi64(q, 3)));
+        __m256i lo = _mm256_cvtepi16_epi32(_mm256_castsi256_si128(q));
+        __m256i hi = _mm256_cvtepi16_epi32(_mm256_extracti128_si256(q, 1));
+        _mm256_storeu_ps(dst + i, _mm256_mul_ps(_mm256_cvtepi32_ps(lo), scale));
+        _mm256_storeu_ps(dst + i + 8, _mm256_mul_ps(_mm256_cvtepi32_ps(hi), scale));
+    }
+    uint32_t tail = hocs_sse42_crc32c(static_cast<uint32_t>(c), src + i, (count - i) * sizeof(int16_t));
+    for (std::size_t j = i; j < count; ++j) dst[j] = src[j] * static_cast<float>(1.0 / Q4_12::ONE);
+    return tail;
+}
+#endif // HOCS_PACKET_X86
+
+// --- AArch64: NEON + ARMv8 CRC32 ---
+
+#ifdef HOCS_PACKET_ARM
+__attribute__((target("+crc")))
+inline uint32_t hocs_armv8_crc32c(uint32_t crc, const void* data, std::size_t bytes) {
+    const unsigned char* p = static_cast<const unsigned char*>(data);
+    for (; bytes >= 8; bytes -= 8, p += 8) {
+        uint64_t word;
+        std::memcpy(&word, p, sizeof(word));
+        crc = __crc32cd(crc, word);
+    }
+    for (; bytes > 0; --bytes) crc = __crc32cb(crc, *p++);
+    return crc;
+}
+
+// vcvtnq rounds to nearest-even and saturates, NaN -> 0; vqmovn saturates to int16
+__attribute__((target("+crc")))
+inline uint32_t hocs_neon_quantize(uint32_t crc, const float* src, int16_t* dst, std::size_t count) {
+    const float32x4_t scale = vdupq_n_f32(static_cast<float>(Q4_12::ONE));
+    std::size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        int32x4_t a = vcvtnq_s32_f32(vmulq_f32(vld1q_f32(src + i), scale));
+        int32x4_t b = vcvtnq_s32_f32(vmulq_f32(vld1q_f32(src + i + 4), scale));
+        int16x8_t q = vcombine_s16(vqmovn_s32(a), vqmovn_s32(b));
+        vst1q_s16(dst + i, q);
+        uint64x2_t words = vreinterpretq_u64_s16(q);
+        crc = __crc32cd(crc, vgetq_lane_u64(words, 0));
+        crc = __crc32cd(crc, vgetq_lane_u64(words, 1));
+    }
+    for (std::size_t j = i; j < count; ++j) dst[j] = hocs_quantize_q12(src[j]);
+    return hocs_armv8_crc32c(crc, dst + i, (count - i) * sizeof(int16_t));
+}
+
+__attribute__((target("+crc")))
+inline uint32_t hocs_neon_dequantize(uint32_t crc, const int16_t* src, float* dst, std::size_t count) {
+    const float32x4_t scale = vdupq_n_f32(static_cast<float>(1.0 / Q4_12::ONE));
+    std::size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        int16x8_t q = vld1q_s16(src + i);
+        uint64x2_t words = vreinterpretq_u64_s16(q);
+        crc = __crc32cd(crc, vgetq_lane_u64(words, 0));
+        crc = __crc32cd(crc, vgetq_lane_u64(words, 1));
+        vst1q_f32(dst + i, vmulq_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(q))), scale));
+        vst1q_f32(dst + i + 4, vmulq_f32(vcvtq_f32_s32(vmovl_s16(vget_high_s16(q))), scale));
+    }
+    crc = hocs_armv8_crc32c(crc, src + i, (count - i) * sizeof(int16_t));
+    for (std::size_t j = i; j < count; ++j) dst[j] = src[j] * static_cast<float>(1.0 / Q4_12::ONE);
+    return crc;
+}
+#endif // HOCS_PACKET_ARM
+
+// --- Detection ---
+
+inline HOCSPacketKernels hocs_detect_packet_kernels() {
+    const char* forced = std::getenv("HOCS_SIMD");
+    const bool scalar_only = forced != nullptr && std::strcmp(forced, "scalar") == 0;
+#if defined(HOCS_PACKET_X86)
+    __builtin_cpu_init();
+    if (!scalar_only && __builtin_cpu_supports("avx2") && __builtin_cpu_supports("sse4.2")) {
+        return {"avx2+sse4.2", hocs_sse42_crc32c, hocs_avx2_quantize, hocs_avx2_dequantize};
+    }
+#elif defined(HOCS_PACKET_ARM)
+    if (!scalar_only && (getauxval(AT_HWCAP) & HWCAP_CRC32)) {
+        return {"neon+crc32", hocs_armv8_crc32c, hocs_neon_quantize, hocs_neon_dequantize};
+    }
+#endif
+    (void)scalar_only;
+    return {"scalar", hocs_scalar_crc32c, hocs_scalar_quantize, hocs_scalar_dequantize};
+}
+
+inline const HOCSPacketKernels& hocs_packet_kernels() {
+    static const HOCSPacketKernels kernels = hocs_detect_packet_kernels();
+    return kernels;
+}
+
+// Finished CRC-32C of one buffer ("123456789" -> 0xE3069283)
+inline uint32_t hocs_crc32c(const void* data, std::size_t bytes) {
+    return ~hocs_packet_kernels().crc32c(~0u, data, bytes);
+}
+
+// --- Packets ---
+
+inline uint32_t hocs_packet_begin(uint32_t opcode, uint32_t tile_id, std::size_t payload_bytes, void* dst) {
+    HOCSPacketHeader header = {HOCS_PACKET_MAGIC, opcode, static_cast<uint32_t>(payload_bytes), tile_id};
+    std::memcpy(dst, &header, sizeof(header));
+    return hocs_packet_kernels().crc32c(~0u, &header, sizeof(header));
+}
+
+inline std::size_t hocs_packet_finish(uint32_t crc, std::size_t payload_bytes, void* dst) {
+    const uint32_t footer = ~crc;
+    std::memcpy(static_cast<unsigned char*>(dst) + sizeof(HOCSPacketHeader) + payload_bytes, &footer,
+                sizeof(footer));
+    return hocs_packet_bytes(payload_bytes);
+}
+
+// Header + Q4.12(values) + CRC32C into dst (hocs_packet_bytes(2 * count)
+// bytes, 2-byte aligned). Returns the packet size.
+inline std::size_t hocs_build_packet(uint32_t opcode, uint32_t tile_id, const float* values, std::size_t count,
+                                     void* dst) {
+    HOCSStageTimer timer(HOCS_STAGE_QUANTIZE);
+    const std::size_t payload = count * sizeof(int16_t);
+    uint32_t crc = hocs_packet_begin(opcode, tile_id, payload, dst);
+    int16_t* data = reinterpret_cast<int16_t*>(static_cast<unsigned char*>(dst) + sizeof(HOCSPacketHeader));
+    crc = hocs_packet_kernels().quantize(crc, values, data, count);
+    return hocs_packet_finish(crc, payload, dst);
+}
+
+// Packet of one tile of a row-major Float32 matrix (leading dimension ld),
+// zero padded to tile_dim x tile_dim like hocs_pack_tile
+inline std::size_t hocs_build_tile_packet(const float* matrix, std::size_t ld, const HOCSTile& tile, int tile_dim,
+                                          uint32_t opcode, void* dst) {
+    HOCSStageTimer timer(HOCS_STAGE_QUANTIZE);
+    const HOCSPacketKernels& k = hocs_packet_kernels();
+    const std::size_t payload = static_cast<std::size_t>(tile_dim) * tile_dim * sizeof(int16_t);
+    uint32_t crc = hocs_packet_begin(opcode, tile.tile_id, payload, dst);
+    int16_t* data = reinterpret_cast<int16_t*>(static_cast<unsigned char*>(dst) + sizeof(HOCSPacketHeader));
+
+    for (int r = 0; r < tile_dim; ++r) {
+        int16_t* row = data + static_cast<std::size_t>(r) * tile_dim;
+        int valid = 0;
+        if (r < tile.rows) {
+            valid = tile.cols;
+            crc = k.quantize(crc, matrix + static_cast<std::size_t>(tile.row0 + r) * ld + tile.col0, row, valid);
+        }
+        std::fill(row + valid, row + tile_dim, int16_t(0));
+        crc = k.crc32c(crc, row + valid, static_cast<std::size_t>(tile_dim - valid) * sizeof(int16_t));
+    }
+    return hocs_packet_finish(crc, payload, dst);
+}
+
+// Checks a received packet and dequantizes its payload into out (capacity
+// floats). On HOCS_PACKET_BAD_CRC out has been written but must be discarded.
+inline int hocs_parse_packet(const void* packet, std::size_t bytes, float* out, std::size_t capacity,
+                             HOCSPacketHeader* header_out = nullptr) {
+    if (bytes < hocs_packet_bytes(0)) return HOCS_PACKET_BAD_LENGTH;
+    HOCSPacketHeader header;
+    std::memcpy(&header, packet, sizeof(header));
+    if (header.magic != HOCS_PACKET_MAGIC) return HOCS_PACKET_BAD_MAGIC;
+    if (header.payload_len % sizeof(int16_t) != 0 || hocs_packet_bytes(header.payload_len) > bytes ||
+        header.payload_len / sizeof(int16_t) > capacity) {
+        return HOCS_PACKET_BAD_LENGTH;
+    }
+    HOCSStageTimer timer(HOCS_STAGE_DEQUANTIZE);
+
+    const HOCSPacketKernels& k = hocs_packet_kernels();
+    const unsigned char* base = static_cast<const unsigned char*>(packet);
+    uint32_t crc = k.crc32c(~0u, &header, sizeof(header));
+    crc = k.dequantize(crc, reinterpret_cast<const int16_t*>(base + sizeof(header)), out,
+                       header.payload_len / sizeof(int16_t));
+    uint32_t footer;
+    std::memcpy(&footer, base + sizeof(header) + header.payload_len, sizeof(footer));
+    if (footer != ~crc) return HOCS_PACKET_BAD_CRC;
+
+    if (header_out) *header_out = header;
+    return HOCS_PACKET_OK;
+}
+
+#endif // HOCS_PACKET_HPP
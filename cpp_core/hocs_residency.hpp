@@ -0,0 +1,173 @@
+/*
+ * HOCS CROSSBAR WEIGHT RESIDENCY
+ * ==============================
+ * Description:
+ * Tracks which weight tile is programmed into which crossbar region, so a
+ * tile that is still resident is used as is instead of being reprogrammed
+ * (CONFIG_XBAR rewrites every CuO cell and is by far the slowest operation
+ * of the system). Tiles are identified by a caller-chosen 64-bit content
+ * key, stable across processes.
+ *
+ * Replacement is LRU over unpinned regions; free regions are used first.
+ * Pinned tiles (e.g. layers on every request path) are never evicted until
+ * unpinned as many times as they were pinned.
+ */
+
+#ifndef HOCS_RESIDENCY_HPP
+#define HOCS_RESIDENCY_HPP
+
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <stdexcept>
+#include <unordered_map>
+#include <vector>
+
+// C layout, read through ctypes
+struct HOCSResidencyStats {
+    uint64_t hits;      // Acquires that found the tile programmed
+    uint64_t misses;    // Acquires that needed CONFIG_XBAR
+    uint64_t evictions; // Resident tiles displaced by a miss
+    uint32_t regions;
+    uint32_t resident;  // Regions holding a tile
+    uint32_t pinned;    // Regions that cannot be evicted
+    uint32_t reserved;
+};
+
+struct HOCSResidencyLookup {
+    int region;
+    bool hit;           // false: the caller must program `region` now
+};
+
+class HOCSResidencyCache {
+private:
+    struct Region {
+        uint64_t key = 0;
+        bool valid = false;
+        int pins = 0;
+        std::list<int>::iterator lru_position; // Valid while pins == 0
+    };
+
+    std::vector<Region> regions;
+    std::unordered_map<uint64_t, int> by_key;
+    std::list<int> lru; // Unpinned regions, free ones and least recently used first
+    HOCSResidencyStats stats = {};
+    mutable std::mutex lock;
+
+    void touch(int index) {
+        lru.splice(lru.end(), lru, regions[index].lru_position);
+    }
+
+    void pin_locked(int index) {
+        Region& region = regions[index];
+        if (region.pins++ == 0) {
+            lru.erase(region.lru_position);
+            ++stats.pinned;
+        }
+    }
+
+    void unpin_locked(int index) {
+        Region& region = regions[index];
+        if (--region.pins == 0) {
+            region.lru_position = lru.insert(lru.end(), index);
+            --stats.pinned;
+        }
+    }
+
+public:
+    explicit HOCSResidencyCache(int region_count) {
+        if (region_count <= 0) {
+            throw std::invalid_argument("HOCSResidencyCache: region count must be positive");
+        }
+        regions.resize(region_count);
+        for (int i = 0; i < region_count; ++i) {
+            regions[i].lru_position = lru.insert(lru.end(), i);
+        }
+        by_key.reserve(region_count);
+        stats.regions = static_cast<uint32_t>(region_count);
+    }
+
+    HOCSResidencyCache(const HOCSResidencyCache&) = delete;
+    HOCSResidencyCache& operator=(const HOCSResidencyCache&) = delete;
+
+    // Region holding `key`, claiming the least recently used unpinned region
+    // on a miss. With pin set the tile stays resident until unpin(key).
+    HOCSResidencyLookup acquire(uint64_t key, bool pin) {
+        std::lock_guard<std::mutex> guard(lock);
+        auto found = by_key.find(key);
+        if (found != by_key.end()) {
+            const int index = found->second;
+            ++stats.hits;
+            if (regions[index].pins == 0) touch(index);
+            if (pin) pin_locked(index);
+            return {index, true};
+        }
+
+        if (lru.empty()) {
+            throw std::runtime_error("HOCSResidencyCache: every crossbar region is pinned");
+        }
+        const int index = lru.front();
+        Region& region = regions[index];
+        if (region.valid) {
+            by_key.erase(region.key);
+            ++stats.evictions;
+        } else {
+            ++stats.resident;
+        }
+        region.key = key;
+        region.valid = true;
+        by_key.emplace(key, index);
+        ++stats.misses;
+        touch(index);
+        if (pin) pin_locked(index);
+        return {index, false};
+    }
+
+    // Drops one pin of `key`; false if it is not resident and pinned
+    bool unpin(uint64_t key) {
+        std::lock_guard<std::mutex> guard(lock);
+        auto found = by_key.find(key);
+        if (found == by_key.end() || regions[found->second].pins == 0) return false;
+        unpin_locked(found->second);
+        return true;
+    }
+
+    // Forgets `key` (its region was overwritten outside the cache), pinned or not
+    bool invalidate(uint64_t key) {
+        std::lock_guard<std::mutex> guard(lock);
+        auto found = by_key.find(key);
+        if (found == by_key.end()) return false;
+        const int index = found->second;
+        by_key.erase(found);
+
+        Region& region = regions[index];
+        if (region.pins > 0) {
+            region.pins = 1;
+            unpin_locked(index);
+        }
+        region.valid = false;
+        --stats.resident;
+        lru.splice(lru.begin(), lru, region.lru_position); // Reused first
+        return true;
+    }
+
+    // Forgets every tile, e.g. after a soft reset of the optical core
+    void reset() {
+        std::lock_guard<std::mutex> guard(lock);
+        by_key.clear();
+        lru.clear();
+        for (std::size_t i = 0; i < regions.size(); ++i) {
+            regions[i] = Region();
+            regions[i].lru_position = lru.insert(lru.end(), static_cast<int>(i));
+        }
+        stats.resident = 0;
+        stats.pinned = 0;
+    }
+
+    HOCSResidencyStats statistics() const {
+        std::lock_guard<std::mutex> guard(lock);
+        return stats;
+    }
+};
+
+#endif // HOCS_RESIDENCY_HPP
@@ -0,0 +1,286 @@
+/*
+ * HOCS SIMD KERNEL DISPATCH LAYER
+ * ===============================
+ * Description:
+ * Runtime CPU-feature detection and dispatch of the engine's dot-product and
+ * multiply-accumulate (FMA) loops. One table is selected at first use:
+ * - AArch64 (Kria Cortex-A53): NEON kernels from asm/hocs_vector_ops.s
+ *                              (with HOCS_NEON_ASM, scalar otherwise)
+ * - x86-64 build servers:      AVX-512 (F+BW) or AVX2+FMA intrinsics
+ * - anything else:             portable scalar loops
+ *
+ * The environment variable HOCS_SIMD=scalar|neon|avx2|avx512 forces a table
+ * (falls back to scalar if the CPU lacks the requested extension).
+ *
+ * The NEON table is only compiled when the assembly file is linked in, so
+ * an AArch64 build without it still links (scalar kernels):
+ *   g++ -std=c++17 -O3 -fopenmp -DHOCS_NEON_ASM ... cpp_core/<target>.cpp asm/hocs_vector_ops.s
+ */
+
+#ifndef HOCS_SIMD_KERNELS_HPP
+#define HOCS_SIMD_KERNELS_HPP
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define HOCS_SIMD_X86 1
+#elif defined(__aarch64__) && defined(HOCS_NEON_ASM)
+#include <sys/auxv.h>
+#include <asm/hwcap.h>
+#define HOCS_SIMD_NEON 1
+#endif
+
+struct HOCSKernelTable {
+    const char* isa;
+    double  (*dot_f64)(const double* a, const double* b, long n);
+    float   (*dot_f32)(const float* a, const float* b, long n);
+    int32_t (*dot_q12)(const int16_t* a, const int16_t* b, long n); // int32 accumulate
+    void    (*axpy_f64)(double* y, const double* x, double a, long n); // y += a * x
+    void    (*axpy_f32)(float* y, const float* x, float a, long n);
+};
+
+// --- Portable scalar fallback ---
+
+inline double hocs_scalar_dot_f64(const double* a, const double* b, long n) {
+    double acc = 0.0;
+    for (long i = 0; i < n; ++i) acc += a[i] * b[i];
+    return acc;
+}
+
+inline float hocs_scalar_dot_f32(const float* a, const float* b, long n) {
+    float acc = 0.0f;
+    for (long i = 0; i < n; ++i) acc += a[i] * b[i];
+    return acc;
+}
+
+inline int32_t hocs_scalar_dot_q12(const int16_t* a, const int16_t* b, long n) {
+    int32_t acc = 0;
+    for (long i = 0; i < n; ++i) acc += static_cast<int32_t>(a[i]) * b[i];
+    return acc;
+}
+
+inline void hocs_scalar_axpy_f64(double* y, const double* x, double a, long n) {
+    for (long i = 0; i < n; ++i) y[i] += a * x[i];
+}
+
+inline void hocs_scalar_axpy_f32(float* y, const float* x, float a, long n) {
+    for (long i = 0; i < n; ++i) y[i] += a * x[i];
+}
+
+// --- AArch64 NEON (asm/hocs_vector_ops.s) ---
+
+#ifdef HOCS_SIMD_NEON
+extern "C" {
+    double  hocs_neon_dot_f64(const double* a, const double* b, long n);
+    float   hocs_neon_dot_f32(const float* a, const float* b, long n);
+    int32_t hocs_neon_dot_q12(const int16_t* a, const int16_t* b, long n);
+    void    hocs_neon_axpy_f64(double* y, const double* x, double a, long n);
+    void    hocs_neon_axpy_f32(float* y, const float* x, float a, long n);
+}
+#endif
+
+// --- x86-64 AVX2 + FMA ---
+
+#ifdef HOCS_SIMD_X86
+__attribute__((target("avx2,fma")))
+inline double hocs_avx2_dot_f64(const double* a, const double* b, long n) {
+    __m256d acc0 = _mm256_setzero_pd();
+    __m256d acc1 = _mm256_setzero_pd();
+    long i = 0;
+    for (; i + 8 <= n; i += 8) {
+        acc0 = _mm256_fmadd_pd(_mm256_loadu_pd(a + i),     _mm256_loadu_pd(b + i),     acc0);
+        acc1 = _mm256_fmadd_pd(_mm256_loadu_pd(a + i + 4), _mm256_loadu_pd(b + i + 4), acc1);
+    }
+    acc0 = _mm256_add_pd(acc0, acc1);
+    __m128d half = _mm_add_pd(_mm256_castpd256_pd128(acc0), _mm256_extractf128_pd(acc0, 1));
+    double acc = _mm_cvtsd_f64(_mm_add_sd(half, _mm_unpackhi_pd(half, half)));
+    for (; i < n; ++i) acc += a[i] * b[i];
+    return acc;
+}
+
+__attribute__((target("avx2,fma")))
+inline float hocs_avx2_dot_f32(const float* a, const float* b, long n) {
+    __m256 acc0 = _mm256_setzero_ps();
+    __m256 acc1 = _mm256_setzero_ps();
+    long i = 0;
+    for (; i + 16 <= n; i += 16) {
+        acc0 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i),     _mm256_loadu_ps(b + i),     acc0);
+        acc1 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i + 8), _mm256_loadu_ps(b + i + 8), acc1);
+    }
+    acc0 = _mm256_add_ps(acc0, acc1);
+    __m128 quad = _mm_add_ps(_mm256_castps256_ps128(acc0), _mm256_extractf128_ps(acc0, 1));
+    quad = _mm_add_ps(quad, _mm_movehl_ps(quad, quad));
+    float acc = _mm_cvtss_f32(_mm_add_ss(quad, _mm_shuffle_ps(quad, quad, 0x1)));
+    for (; i < n; ++i) acc += a[i] * b[i];
+    return acc;
+}
+
+__attribute__((target("avx2")))
+inline int32_t hocs_avx2_dot_q12(const int16_t* a, const int16_t* b, long n) {
+    __m256i acc = _mm256_setzero_si256();
+    long i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+        __m256i vb = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i));
+        acc = _mm256_add_epi32(acc, _mm256_madd_epi16(va, vb)); // 16x int16 MAC -> 8x int32
+    }
+    __m128i quad = _mm_add_epi32(_mm256_castsi256_si128(acc), _mm256_extracti128_si256(acc, 1));
+    quad = _mm_add_epi32(quad, _mm_shuffle_epi32(quad, 0x4E));
+    quad = _mm_add_epi32(quad, _mm_shuffle_epi32(quad, 0xB1));
+    int32_t sum = _mm_cvtsi128_si32(quad);
+    for (; i < n; ++i) sum += static_cast<int32_t>(a[i]) * b[i];
+    return sum;
+}
+
+__attribute__((target("avx2,fma")))
+inline void hocs_avx2_axpy_f64(double* y, const double* x, double a, long n) {
+    __m256d va = _mm256_set1_pd(a);
+    long i = 0;
+    for (; i + 4 <= n; i += 4) {
+        _mm256_storeu_pd(y + i, _mm256_fmadd_pd(va, _mm256_loadu_pd(x + i), _mm256_loadu_pd(y + i)));
+    }
+    for (; i < n; ++i) y[i] += a * x[i];
+}
+
+__attribute__((target("avx2,fma")))
+inline void hocs_avx2_axpy_f32(float* y, const float* x, float a, long n) {
+    __m256 va = _mm256_set1_ps(a);
+    long i = 0;
+    for (; i + 8 <= n; i += 8) {
+        _mm256_storeu_ps(y + i, _mm256_fmadd_ps(va, _mm256_loadu_ps(x + i), _mm256_loadu_ps(y + i)));
+    }
+    for (; i < n; ++i) y[i] += a * x[i];
+}
+
+// --- x86-64 AVX-512 (F + BW) ---
+// Horizontal sums go through memory: they run once per row, and GCC 12's
+// _mm512_reduce_add_* trip -Wuninitialized inside its own headers.
+
+__attribute__((target("avx512f")))
+inline double hocs_avx512_dot_f64(const double* a, const double* b, long n) {
+    __m512d acc0 = _mm512_setzero_pd();
+    __m512d acc1 = _mm512_setzero_pd();
+    long i = 0;
+    for (; i + 16 <= n; i += 16) {
+        acc0 = _mm512_fmadd_pd(_mm512_loadu_pd(a + i),     _mm512_loadu_pd(b + i),     acc0);
+        acc1 = _mm512_fmadd_pd(_mm512_loadu_pd(a + i + 8), _mm512_loadu_pd(b + i + 8), acc1);
+    }
+    alignas(64) double lanes[8];
+    _mm512_store_pd(lanes, _mm512_add_pd(acc0, acc1));
+    double acc = 0.0;
+    for (double lane : lanes) acc += lane;
+    for (; i < n; ++i) acc += a[i] * b[i];
+    return acc;
+}
+
+__attribute__((target("avx512f")))
+inline float hocs_avx512_dot_f32(const float* a, const float* b, long n) {
+    __m512 acc0 = _mm512_setzero_ps();
+    __m512 acc1 = _mm512_setzero_ps();
+    long i = 0;
+    for (; i + 32 <= n; i += 32) {
+        acc0 = _mm512_fmadd_ps(_mm512_loadu_ps(a + i),      _mm512_loadu_ps(b + i),      acc0);
+        acc1 = _mm512_fmadd_ps(_mm512_loadu_ps(a + i + 16), _mm512_loadu_ps(b + i + 16), acc1);
+    }
+    alignas(64) float lanes[16];
+    _mm512_store_ps(lanes, _mm512_add_ps(acc0, acc1));
+    float acc = 0.0f;
+    for (float lane : lanes) acc += lane;
+    for (; i < n; ++i) acc += a[i] * b[i];
+    return acc;
+}
+
+__attribute__((target("avx512f,avx512bw")))
+inline int32_t hocs_avx512_dot_q12(const int16_t* a, const int16_t* b, long n) {
+    __m512i acc = _mm512_setzero_si512();
+    long i = 0;
+    for (; i + 32 <= n; i += 32) {
+        __m512i va = _mm512_loadu_si512(a + i);
+        __m512i vb = _mm512_loadu_si512(b + i);
+        acc = _mm512_add_epi32(acc, _mm512_madd_epi16(va, vb));
+    }
+    alignas(64) int32_t lanes[16];
+    _mm512_store_si512(lanes, acc);
+    int32_t sum = 0;
+    for (int32_t lane : lanes) sum += lane;
+    for (; i < n; ++i) sum += static_cast<int32_t>(a[i]) * b[i];
+    return sum;
+}
+
+__attribute__((target("avx512f")))
+inline void hocs_avx512_axpy_f64(double* y, const double* x, double a, long n) {
+    __m512d va = _mm512_set1_pd(a);
+    long i = 0;
+    for (; i + 8 <= n; i += 8) {
+        _mm512_storeu_pd(y + i, _mm512_fmadd_pd(va, _mm512_loadu_pd(x + i), _mm512_loadu_pd(y + i)));
+    }
+    for (; i < n; ++i) y[i] += a * x[i];
+}
+
+__attribute__((target("avx512f")))
+inline void hocs_avx512_axpy_f32(float* y, const float* x, float a, long n) {
+    __m512 va = _mm512_set1_ps(a);
+    long i = 0;
+    for (; i + 16 <= n; i += 16) {
+        _mm512_storeu_ps(y + i, _mm512_fmadd_ps(va, _mm512_loadu_ps(x + i), _mm512_loadu_ps(y + i)));
+    }
+    for (; i < n; ++i) y[i] += a * x[i];
+}
+#endif // HOCS_SIMD_X86
+
+// --- Detection ---
+
+inline HOCSKernelTable hocs_scalar_kernel_table() {
+    return {"scalar", hocs_scalar_dot_f64, hocs_scalar_dot_f32, hocs_scalar_dot_q12,
+            hocs_scalar_axpy_f64, hocs_scalar_axpy_f32};
+}
+
+inline HOCSKernelTable hocs_detect_kernel_table() {
+    const char* forced = std::getenv("HOCS_SIMD");
+    auto allowed = [forced](const char* isa) {
+        return forced == nullptr || std::strcmp(forced, isa) == 0;
+    };
+
+#if defined(HOCS_SIMD_X86)
+    __builtin_cpu_init();
+    if (allowed("avx512") && __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw")) {
+        return {"avx512", hocs_avx512_dot_f64, hocs_avx512_dot_f32, hocs_avx512_dot_q12,
+                hocs_avx512_axpy_f64, hocs_avx512_axpy_f32};
+    }
+    if (allowed("avx2") && __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) {
+        return {"avx2", hocs_avx2_dot_f64, hocs_avx2_dot_f32, hocs_avx2_dot_q12,
+                hocs_avx2_axpy_f64, hocs_avx2_axpy_f32};
+    }
+#elif defined(HOCS_SIMD_NEON)
+    if (allowed("neon") && (getauxval(AT_HWCAP) & HWCAP_ASIMD)) {
+        return {"neon", hocs_neon_dot_f64, hocs_neon_dot_f32, hocs_neon_dot_q12,
+                hocs_neon_axpy_f64, hocs_neon_axpy_f32};
+    }
+#endif
+    (void)allowed;
+    return hocs_scalar_kernel_table();
+}
+
+// Selected once per process (thread-safe static initialization)
+inline const HOCSKernelTable& hocs_kernels() {
+    static const HOCSKernelTable table = hocs_detect_kernel_table();
+    return table;
+}
+
+// Element-typed entry points used by BasicHOCSEngine
+inline double  hocs_simd_dot(const double* a, const double* b, long n)   { return hocs_kernels().dot_f64(a, b, n); }
+inline float   hocs_simd_dot(const float* a, const float* b, long n)     { return hocs_kernels().dot_f32(a, b, n); }
+inline int32_t hocs_simd_dot(const int16_t* a, const int16_t* b, long n) { return hocs_kernels().dot_q12(a, b, n); }
+
+inline void hocs_simd_axpy(double* y, const double* x, double a, long n) { hocs_kernels().axpy_f64(y, x, a, n); }
+inline void hocs_simd_axpy(float* y, const float* x, float a, long n)    { hocs_kernels().axpy_f32(y, x, a, n); }
+
+// Q4.12 has no accumulate-into-int32 table entry; the compiler vectorizes this
+inline void hocs_simd_axpy(int32_t* y, const int16_t* x, int16_t a, long n) {
+    for (long i = 0; i < n; ++i) y[i] += static_cast<int32_t>(a) * x[i];
+}
+
+#endif // HOCS_SIMD_KERNELS_HPP
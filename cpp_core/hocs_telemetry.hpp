@@ -0,0 +1,377 @@
+/*
+ * HOCS PER-STAGE LATENCY TELEMETRY
+ * ================================
+ * Description:
+ * Where the < 50 us per-tile budget (docs/INTERFACE_SPEC.md, section 4)
+ * goes. Hot paths take raw TSC / cntvct_el0 timestamps and record one
+ * duration per stage of a job:
+ *
+ *   QUANTIZE    Float32 -> device format (Q4.12 packet + CRC, conductances)
+ *   DMA_SUBMIT  job handed over until the device starts it (MM2S / queueing)
+ *   IRQ         device busy until it raises the completion interrupt
+ *   READBACK    completion until the result is in host memory (S2MM / reap)
+ *   DEQUANTIZE  result packet -> Float32 (CRC check included)
+ *
+ * Recording is wait-free: every thread owns a single-producer ring and
+ * never takes a lock after its first event. snapshot() drains all rings
+ * into one HDR (log-linear) histogram per stage, in nanoseconds with
+ * <= 1/32 relative error. A full ring drops the event and counts it.
+ */
+
+#ifndef HOCS_TELEMETRY_HPP
+#define HOCS_TELEMETRY_HPP
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+enum HOCSStage : uint32_t {
+    HOCS_STAGE_QUANTIZE   = 0,
+    HOCS_STAGE_DMA_SUBMIT = 1,
+    HOCS_STAGE_IRQ        = 2,
+    HOCS_STAGE_READBACK   = 3,
+    HOCS_STAGE_DEQUANTIZE = 4,
+    HOCS_STAGE_COUNT      = 5
+};
+
+inline const char* hocs_stage_name(uint32_t stage) {
+    static const char* const names[HOCS_STAGE_COUNT] = {"quantize", "dma_submit", "irq", "readback",
+                                                        "dequantize"};
+    return stage < HOCS_STAGE_COUNT ? names[stage] : "unknown";
+}
+
+// C layout, read through ctypes. Latencies in nanoseconds.
+struct HOCSStageSummary {
+    uint64_t count;
+    double min_ns;
+    double mean_ns;
+    double p50_ns;
+    double p90_ns;
+    double p99_ns;
+    double p999_ns;
+    double max_ns;
+};
+
+// --- Timestamps ---
+
+// Raw counter: TSC (invariant on every x86 host we support) or the ARMv8
+// virtual counter, steady_clock nanoseconds elsewhere
+inline uint64_t hocs_cycles() {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#elif defined(__aarch64__)
+    uint64_t ticks;
+    asm volatile("mrs %0, cntvct_el0" : "=r"(ticks));
+    return ticks;
+#else
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+}
+
+// --- HDR histogram ---
+
+// Values below 2 * SUB are exact; above, each power of two is split into
+// SUB linear buckets. 2^41 ns (~36 min) and more land in the last bucket.
+class HOCSLatencyHistogram {
+public:
+    static constexpr int SUB_BITS = 5;
+    static constexpr uint64_t SUB = uint64_t(1) << SUB_BITS;
+    static constexpr int MAX_SHIFT = 41 - SUB_BITS;
+    static constexpr std::size_t BUCKETS = SUB * (MAX_SHIFT + 2);
+
+private:
+    std::array<uint64_t, BUCKETS> counts{};
+    uint64_t total = 0;
+    uint64_t min_value = UINT64_MAX;
+    uint64_t max_value = 0;
+    double sum = 0.0;
+
+    static int shift_of(std::size_t index) {
+        return index < 2 * SUB ? 0 : static_cast<int>(index / SUB) - 1;
+    }
+
+public:
+    static std::size_t index_of(uint64_t value) {
+        if (value < 2 * SUB) return static_cast<std::size_t>(value);
+        const int shift = std::min(63 - __builtin_clzll(value) - SUB_BITS, MAX_SHIFT);
+        const uint64_t mantissa = std::min(value >> shift, 2 * SUB - 1);
+        return static_cast<std::size_t>(SUB * shift + mantissa);
+    }
+
+    static uint64_t lower_bound(std::size_t index) {
+        const int shift = shift_of(index);
+        return static_cast<uint64_t>(index - SUB * shift) << shift;
+    }
+
+    static uint64_t bucket_width(std::size_t index) { return uint64_t(1) << shift_of(index); }
+
+    void add(uint64_t value) {
+        ++counts[index_of(value)];
+        ++total;
+        sum += static_cast<double>(value);
+        min_value = std::min(min_value, value);
+        max_value = std::max(max_value, value);
+    }
+
+    uint64_t count() const { return total; }
+    uint64_t bucket(std::size_t index) const { return counts[index]; }
+
+    // Bucket midpoint of the q-quantile (0 < q <= 1), clamped to the exact
+    // extremes
+    double percentile(double q) const {
+        if (total == 0) return 0.0;
+        const uint64_t rank = std::max<uint64_t>(1, static_cast<uint64_t>(q * static_cast<double>(total) + 0.5));
+        uint64_t seen = 0;
+        for (std::size_t i = 0; i < BUCKETS; ++i) {
+            seen += counts[i];
+            if (seen >= rank) {
+                const double mid = static_cast<double>(lower_bound(i)) + (bucket_width(i) - 1) / 2.0;
+                return std::min(std::max(mid, static_cast<double>(min_value)), static_cast<double>(max_value));
+            }
+        }
+        return static_cast<double>(max_value);
+    }
+
+    HOCSStageSummary summary() const {
+        HOCSStageSummary s = {};
+        s.count = total;
+        if (total == 0) return s;
+        s.min_ns = static_cast<double>(min_value);
+        s.mean_ns = sum / static_cast<double>(total);
+        s.p50_ns = percentile(0.50);
+        s.p90_ns = percentile(0.90);
+        s.p99_ns = percentile(0.99);
+        s.p999_ns = percentile(0.999);
+        s.max_ns = static_cast<double>(max_value);
+        return s;
+    }
+
+    void clear() { *this = HOCSLatencyHistogram(); }
+};
+
+// --- Per-thread event ring ---
+
+struct HOCSStageEvent {
+    uint32_t stage;
+    uint64_t cycles; // Duration in hocs_cycles() ticks
+};
+
+// Single producer (the owning thread), single consumer (the collector,
+// serialized by HOCSTelemetry)
+class HOCSTelemetryRing {
+public:
+    static constexpr uint64_t CAPACITY = 4096; // Power of two
+
+private:
+    alignas(64) std::atomic<uint64_t> head{0}; // Written by the producer
+    alignas(64) std::atomic<uint64_t> tail{0}; // Written by the consumer
+    std::atomic<uint64_t> dropped{0};
+    std::atomic<bool> retired{false}; // Owning thread exited, no push follows
+    HOCSStageEvent events[CAPACITY];
+
+public:
+    bool push(const HOCSStageEvent& event) {
+        const uint64_t h = head.load(std::memory_order_relaxed);
+        if (h - tail.load(std::memory_order_acquire) == CAPACITY) {
+            dropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        events[h & (CAPACITY - 1)] = event;
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+    template <typename Fn>
+    void drain(Fn&& consume) {
+        uint64_t t = tail.load(std::memory_order_relaxed);
+        const uint64_t h = head.load(std::memory_order_acquire);
+        for (; t != h; ++t) consume(events[t & (CAPACITY - 1)]);
+        tail.store(t, std::memory_order_release);
+    }
+
+    uint64_t take_dropped() { return dropped.exchange(0, std::memory_order_relaxed); }
+
+    void retire() { retired.store(true, std::memory_order_release); }
+    bool is_retired() const { return retired.load(std::memory_order_acquire); }
+};
+
+// thread_local owner of a ring: retires it when the thread exits
+struct HOCSTelemetryRingHolder {
+    std::shared_ptr<HOCSTelemetryRing> ring;
+
+    ~HOCSTelemetryRingHolder() {
+        if (ring) ring->retire();
+    }
+};
+
+// --- Process-wide aggregator ---
+
+class HOCSTelemetry {
+private:
+    using Clock = std::chrono::steady_clock;
+
+    std::mutex registry_lock;
+    std::vector<std::shared_ptr<HOCSTelemetryRing>> rings;
+
+    std::mutex aggregate_lock; // One collector at a time
+    HOCSLatencyHistogram histograms[HOCS_STAGE_COUNT];
+    uint64_t dropped_events = 0;
+
+    std::atomic<bool> enabled;
+    const uint64_t origin_cycles;
+    const Clock::time_point origin_time;
+
+    HOCSTelemetry() : origin_cycles(hocs_cycles()), origin_time(Clock::now()) {
+        const char* env = std::getenv("HOCS_TELEMETRY");
+        enabled.store(!(env && env[0] == '0'), std::memory_order_relaxed);
+    }
+
+    HOCSTelemetryRing& local_ring() {
+        thread_local HOCSTelemetryRingHolder holder;
+        if (!holder.ring) {
+            holder.ring = std::make_shared<HOCSTelemetryRing>();
+            std::lock_guard<std::mutex> guard(registry_lock);
+            rings.push_back(holder.ring);
+        }
+        return *holder.ring;
+    }
+
+    // Counter period. The TSC rate is measured against steady_clock over
+    // the whole lifetime of the process (at least 10 ms), cntvct_el0
+    // publishes its own.
+    double ns_per_cycle() const {
+#if defined(__x86_64__) || defined(__i386__)
+        const auto min_span = std::chrono::milliseconds(10);
+        const auto elapsed = Clock::now() - origin_time;
+        if (elapsed < min_span) std::this_thread::sleep_for(min_span - elapsed);
+        const uint64_t cycles = hocs_cycles() - origin_cycles;
+        const double ns = std::chrono::duration<double, std::nano>(Clock::now() - origin_time).count();
+        return cycles ? ns / static_cast<double>(cycles) : 1.0;
+#elif defined(__aarch64__)
+        uint64_t frequency;
+        asm volatile("mrs %0, cntfrq_el0" : "=r"(frequency));
+        return frequency ? 1e9 / static_cast<double>(frequency) : 1.0;
+#else
+        return 1.0;
+#endif
+    }
+
+    // Caller holds aggregate_lock
+    void collect_locked() {
+        std::vector<std::shared_ptr<HOCSTelemetryRing>> current;
+        {
+            std::lock_guard<std::mutex> guard(registry_lock);
+            current = rings;
+        }
+        const double scale = ns_per_cycle();
+        std::vector<const HOCSTelemetryRing*> finished;
+        for (const auto& ring : current) {
+            // Retired before the drain: every event of the ring is drained below
+            if (ring->is_retired()) finished.push_back(ring.get());
+            ring->drain([&](const HOCSStageEvent& e) {
+                if (e.stage < HOCS_STAGE_COUNT) {
+                    histograms[e.stage].add(static_cast<uint64_t>(static_cast<double>(e.cycles) * scale));
+                }
+            });
+            dropped_events += ring->take_dropped();
+        }
+
+        // Only rings retired and drained above: one registered meanwhile is
+        // not in `current` and belongs to a live thread
+        if (finished.empty()) return;
+        std::lock_guard<std::mutex> guard(registry_lock);
+        rings.erase(std::remove_if(rings.begin(), rings.end(),
+                                   [&](const std::shared_ptr<HOCSTelemetryRing>& r) {
+                                       return std::find(finished.begin(), finished.end(), r.get()) !=
+                                              finished.end();
+                                   }),
+                    rings.end());
+    }
+
+public:
+    static HOCSTelemetry& instance() {
+        static HOCSTelemetry telemetry;
+        return telemetry;
+    }
+
+    HOCSTelemetry(const HOCSTelemetry&) = delete;
+    HOCSTelemetry& operator=(const HOCSTelemetry&) = delete;
+
+    // `start` and `end` are hocs_cycles() values of the calling thread
+    void record(HOCSStage stage, uint64_t start, uint64_t end) {
+        if (!enabled.load(std::memory_order_relaxed)) return;
+        local_ring().push(HOCSStageEvent{stage, end - start});
+    }
+
+    void set_enabled(bool on) { enabled.store(on, std::memory_order_relaxed); }
+
+    // Drains every ring; writes up to max stage summaries (HOCSStage order)
+    int snapshot(HOCSStageSummary* out, int max) {
+        std::lock_guard<std::mutex> guard(aggregate_lock);
+        collect_locked();
+        const int n = std::min<int>(max, HOCS_STAGE_COUNT);
+        for (int s = 0; s < n; ++s) out[s] = histograms[s].summary();
+        return n;
+    }
+
+    // Non-empty buckets of one stage as (lower bound in ns, count) pairs
+    int buckets(uint32_t stage, uint64_t* lower_ns, uint64_t* counts, int max) {
+        if (stage >= HOCS_STAGE_COUNT) return 0;
+        std::lock_guard<std::mutex> guard(aggregate_lock);
+        collect_locked();
+        const HOCSLatencyHistogram& h = histograms[stage];
+        int written = 0;
+        for (std::size_t i = 0; i < HOCSLatencyHistogram::BUCKETS && written < max; ++i) {
+            if (h.bucket(i) == 0) continue;
+            lower_ns[written] = HOCSLatencyHistogram::lower_bound(i);
+            counts[written] = h.bucket(i);
+            ++written;
+        }
+        return written;
+    }
+
+    uint64_t dropped() {
+        std::lock_guard<std::mutex> guard(aggregate_lock);
+        collect_locked();
+        return dropped_events;
+    }
+
+    // Discards pending events and every histogram
+    void reset() {
+        std::lock_guard<std::mutex> guard(aggregate_lock);
+        collect_locked();
+        for (HOCSLatencyHistogram& h : histograms) h.clear();
+        dropped_events = 0;
+    }
+};
+
+inline HOCSTelemetry& hocs_telemetry() { return HOCSTelemetry::instance(); }
+
+// Records the enclosing scope as one `stage` event
+class HOCSStageTimer {
+private:
+    HOCSStage stage;
+    uint64_t start;
+
+public:
+    explicit HOCSStageTimer(HOCSStage s) : stage(s), start(hocs_cycles()) {}
+    ~HOCSStageTimer() { hocs_telemetry().record(stage, start, hocs_cycles()); }
+
+    HOCSStageTimer(const HOCSStageTimer&) = delete;
+    HOCSStageTimer& operator=(const HOCSStageTimer&) = delete;
+};
+
+#endif // HOCS_TELEMETRY_HPP
@@ -0,0 +1,256 @@
+/*
+ * HOCS TILED CROSSBAR ENGINE
+ * ==========================
+ * Description:
+ * Executes an M x K layer as a grid of tile_dim x tile_dim crossbars, in the
+ * TILE_ID order of HOCSTilePlan (hocs_tiler.hpp), the same order the DMA
+ * path streams job packets to the optical core. Each crossbar keeps its own
+ * physical state, so a tile's planes stay resident in L1/L2 while it is
+ * applied instead of streaming the whole layer per output row.
+ * In sparse mode the bands only visit the tiles of their HOCSBlockCSR
+ * occupancy, and each crossbar skips its own off rows and column blocks.
+ */
+
+#ifndef HOCS_TILED_ENGINE_HPP
+#define HOCS_TILED_ENGINE_HPP
+
+#include <iostream>
+#include <memory>
+#include <vector>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include "hocs_conv.hpp"
+#include "hocs_native_engine.hpp"
+#include "hocs_tiler.hpp"
+
+template <typename Element>
+class BasicHOCSTiledEngine {
+public:
+    using Engine = BasicHOCSEngine<Element>;
+    using Traits = ElementTraits<Element>;
+    using value_type = typename Traits::storage_type;
+
+private:
+    HOCSTilePlan plan;
+    std::vector<std::unique_ptr<Engine>> crossbars; // Indexed by TILE_ID
+    HOCSBlockCSR occupancy; // Tiles with on cells as of the last program_weights
+    bool sparse = false;
+
+    // Per-worker staging, reused across calls
+    struct Scratch {
+        std::vector<value_type> voltages; // Zero-padded input slice of an edge tile
+        std::vector<value_type> partial;  // Currents of one tile
+        std::vector<double> band;         // Partial-current reduction of one tile row
+    };
+
+    // Implicit-GEMM staging: patches and currents of one pixel block
+    std::vector<value_type> conv_patches;
+    std::vector<value_type> conv_currents;
+
+    static Scratch& worker_scratch() {
+        thread_local Scratch scratch;
+        return scratch;
+    }
+
+    // Bands are spread over threads when there are enough of them. Otherwise
+    // the tiles run one after another and each crossbar parallelizes its rows.
+    bool parallel_bands() const {
+#ifdef _OPENMP
+        return plan.tile_grid_rows() >= omp_get_max_threads();
+#else
+        return false;
+#endif
+    }
+
+    // Voltages for the columns of `tile`: a view into the caller's buffer for
+    // full tiles, a zero-padded copy for the right edge of the grid
+    const value_type* tile_voltages(const HOCSTile& tile, const value_type* V_in, int batch_size,
+                                    Scratch& scratch) const {
+        const int dim = plan.tile_size();
+        const value_type* V_tile = V_in + static_cast<std::size_t>(tile.col0) * batch_size;
+        if (tile.cols == dim) return V_tile;
+
+        scratch.voltages.assign(static_cast<std::size_t>(dim) * batch_size, Traits::from_double(0.0));
+        std::copy(V_tile, V_tile + static_cast<std::size_t>(tile.cols) * batch_size, scratch.voltages.begin());
+        return scratch.voltages.data();
+    }
+
+    // Adds one tile's partial currents to the band
+    void accumulate_tile(const HOCSTile& tile, const value_type* V_in, int batch_size, Scratch& scratch) {
+        const value_type* V_tile = tile_voltages(tile, V_in, batch_size, scratch);
+        Engine& crossbar = *crossbars[tile.tile_id];
+
+        if (batch_size == 1) {
+            crossbar.compute_optical_propagation(V_tile, scratch.partial.data());
+        } else {
+            crossbar.compute_optical_propagation_batch(V_tile, batch_size, scratch.partial.data());
+        }
+        for (std::size_t i = 0; i < scratch.partial.size(); ++i) {
+            scratch.band[i] += Traits::to_double(scratch.partial[i]);
+        }
+    }
+
+    // Runs every (sparse mode: every on) tile of one tile row and reduces
+    // the partial currents. Partials are summed in double so Q4.12 bands do
+    // not saturate midway.
+    void propagate_band(int tile_row, const value_type* V_in, int batch_size, value_type* I_out) {
+        const int dim = plan.tile_size();
+        const std::size_t tile_outputs = static_cast<std::size_t>(dim) * batch_size;
+        Scratch& scratch = worker_scratch();
+        scratch.partial.resize(tile_outputs);
+        scratch.band.assign(tile_outputs, 0.0);
+
+        if (sparse) {
+            for (uint32_t k = occupancy.band_begin(tile_row); k < occupancy.band_end(tile_row); ++k) {
+                accumulate_tile(plan.tile(occupancy.tile_ids[k]), V_in, batch_size, scratch);
+            }
+        } else {
+            for (int tile_col = 0; tile_col < plan.tile_grid_cols(); ++tile_col) {
+                accumulate_tile(plan.tile_at(tile_row, tile_col), V_in, batch_size, scratch);
+            }
+        }
+
+        // Only the valid rows of the band reach the caller
+        const HOCSTile& first = plan.tile_at(tile_row, 0);
+        value_type* I_band = I_out + static_cast<std::size_t>(first.row0) * batch_size;
+        const std::size_t valid = static_cast<std::size_t>(first.rows) * batch_size;
+        for (std::size_t i = 0; i < valid; ++i) {
+            I_band[i] = Traits::from_double(scratch.band[i]);
+        }
+    }
+
+public:
+    // rows = output currents (M), cols = input voltages (K)
+    BasicHOCSTiledEngine(int rows, int cols, int tile_dim = HOCS_TILE_DIM)
+        : plan(rows, cols, tile_dim) {
+        occupancy.band_offsets.assign(plan.tile_grid_rows() + 1, 0); // Every cell starts in the off state
+        crossbars.reserve(plan.tile_count());
+        for (std::size_t i = 0; i < plan.tile_count(); ++i) {
+            crossbars.emplace_back(new Engine(tile_dim, true));
+        }
+        std::cout << "[CPP-CORE] Tiled Engine Initialized. Layer: " << rows << "x" << cols
+                  << " as " << plan.tile_grid_rows() << "x" << plan.tile_grid_cols()
+                  << " tiles of " << tile_dim << "x" << tile_dim
+                  << " (" << Traits::name << ")" << std::endl;
+    }
+
+    const HOCSTilePlan& tile_plan() const { return plan; }
+    Engine& crossbar(uint32_t tile_id) { return *crossbars.at(tile_id); }
+    const Engine& crossbar(uint32_t tile_id) const { return *crossbars.at(tile_id); }
+
+    void set_kernel_variant(KernelVariant variant) {
+        for (auto& xbar : crossbars) xbar->set_kernel_variant(variant);
+    }
+
+    void set_fast_exp(bool enabled) {
+        for (auto& xbar : crossbars) xbar->set_fast_exp(enabled);
+    }
+
+    // Tile skipping plus per-crossbar row / column-block skipping
+    void set_sparse(bool enabled) {
+        sparse = enabled;
+        for (auto& xbar : crossbars) xbar->set_sparse(enabled);
+    }
+    bool is_sparse() const { return sparse; }
+
+    // Tile-level occupancy; cells edited through crossbar() take effect on
+    // the next program_weights
+    const HOCSBlockCSR& tile_occupancy() const { return occupancy; }
+
+    // Fraction of the layer's tiles that hold on cells
+    double tile_density() const {
+        return static_cast<double>(occupancy.tile_count()) / static_cast<double>(plan.tile_count());
+    }
+
+    uint64_t exp_evaluations() const {
+        uint64_t total = 0;
+        for (const auto& xbar : crossbars) total += xbar->exp_evaluations();
+        return total;
+    }
+
+    void dissipate(double seconds, double time_constant) {
+        for (auto& xbar : crossbars) xbar->dissipate(seconds, time_constant);
+    }
+
+    // Hottest cell of the layer, Kelvin
+    double peak_temperature() const {
+        double peak = 0.0;
+        for (const auto& xbar : crossbars) peak = std::max(peak, xbar->peak_temperature());
+        return peak;
+    }
+
+    // Programs the layer from a row-major rows x cols weight matrix (leading
+    // dimension ld), tile by tile through the shared packing routine. Weights
+    // are the effective conductances at T_AMBIENT: each cell is written as
+    // w / exp(-Ea / kT_ambient), so an unheated layer computes exactly W * V.
+    // The tile occupancy uses the same cut as the crossbars: |w * gain| above
+    // HOCS_OFF_CONDUCTANCE.
+    template <typename Src>
+    void program_weights(const Src* weights, std::size_t ld) {
+        occupancy = hocs_block_csr(weights, ld, plan, HOCS_OFF_CONDUCTANCE * crossbars[0]->ambient_activation());
+        std::vector<double> packed(plan.tile_cells());
+        for (const HOCSTile& tile : plan.all_tiles()) {
+            hocs_pack_tile<double>(weights, ld, tile, plan.tile_size(), packed.data());
+            Engine& xbar = *crossbars[tile.tile_id];
+            const double gain = 1.0 / xbar.ambient_activation();
+            for (double& cell : packed) cell *= gain;
+            xbar.program_conductances(packed.data(), plan.tile_size());
+        }
+    }
+
+    // I = W * V for one vector: reads cols() voltages, writes rows() currents
+    void compute_optical_propagation(const value_type* voltage_inputs, value_type* current_outputs) {
+        compute_optical_propagation_batch(voltage_inputs, 1, current_outputs);
+    }
+
+    // cols() x B voltages in, rows() x B currents out (row-major, caller-owned)
+    void compute_optical_propagation_batch(const value_type* voltage_inputs, int batch_size,
+                                           value_type* current_outputs) {
+        const int bands = plan.tile_grid_rows();
+        #pragma omp parallel for schedule(dynamic, 1) if(parallel_bands())
+        for (int tile_row = 0; tile_row < bands; ++tile_row) {
+            propagate_band(tile_row, voltage_inputs, batch_size, current_outputs);
+        }
+    }
+
+    // Direct Conv2d through the programmed kernel matrix (rows = output
+    // channels, cols = channels * kh * kw, see hocs_conv.hpp) without an
+    // IM2COL matrix: patches of HOCS_CONV_PIXEL_BLOCK output pixels at a time
+    // are gathered from the feature map and propagated as one batch.
+    // images x channels x height x width in, images x rows x out_h x out_w out.
+    void compute_optical_convolution(const HOCSConvGeometry& geometry, const value_type* input, int images,
+                                     value_type* output) {
+        hocs_validate_conv(geometry, plan.cols());
+        const int channels_out = plan.rows();
+        const int pixels = hocs_conv_out_h(geometry) * hocs_conv_out_w(geometry);
+        const std::size_t patch = static_cast<std::size_t>(plan.cols());
+        const std::size_t in_image = static_cast<std::size_t>(geometry.channels) * geometry.height * geometry.width;
+        const std::size_t out_image = static_cast<std::size_t>(channels_out) * pixels;
+        conv_patches.resize(patch * HOCS_CONV_PIXEL_BLOCK);
+        conv_currents.resize(static_cast<std::size_t>(channels_out) * HOCS_CONV_PIXEL_BLOCK);
+
+        for (int n = 0; n < images; ++n) {
+            const value_type* image = input + in_image * n;
+            value_type* result = output + out_image * n;
+            for (int pixel0 = 0; pixel0 < pixels; pixel0 += HOCS_CONV_PIXEL_BLOCK) {
+                const int count = std::min(HOCS_CONV_PIXEL_BLOCK, pixels - pixel0);
+                hocs_gather_patches(image, geometry, pixel0, count, conv_patches.data(), Traits::from_double(0.0));
+                compute_optical_propagation_batch(conv_patches.data(), count, conv_currents.data());
+                for (int o = 0; o < channels_out; ++o) {
+                    std::copy(conv_currents.data() + static_cast<std::size_t>(o) * count,
+                              conv_currents.data() + static_cast<std::size_t>(o + 1) * count,
+                              result + static_cast<std::size_t>(o) * pixels + pixel0);
+                }
+            }
+        }
+    }
+};
+
+using HOCSTiledEngine    = BasicHOCSTiledEngine<double>;
+using HOCSTiledEngineF32 = BasicHOCSTiledEngine<float>;
+using HOCSTiledEngineQ12 = BasicHOCSTiledEngine<Q4_12>;
+
+#endif // HOCS_TILED_ENGINE_HPP
@@ -0,0 +1,164 @@
+/*
+ * HOCS CROSSBAR TILER
+ * ===================
+ * Description:
+ * Splits an arbitrary M x K weight matrix into crossbar-sized tiles
+ * (128x128 per docs/INTERFACE_SPEC.md) and numbers them with the TILE_ID of
+ * the job packet. The same plan and packing routine drive the simulated
+ * crossbars (hocs_tiled_engine.hpp) and the DMA staging path
+ * (memory/hocs_dma_allocator.cpp), so tile order, padding and payload sizes
+ * are identical in simulation and on hardware.
+ * For pruned layers HOCSBlockCSR lists the tiles that hold any weight, so
+ * both paths skip all-off tiles and bands instead of touching M x K cells.
+ */
+
+#ifndef HOCS_TILER_HPP
+#define HOCS_TILER_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+#include "hocs_element_types.hpp"
+
+// Ideal tile of the optical core: 128x128 Int16 cells = 32 KB payload
+constexpr int HOCS_TILE_DIM = 128;
+// DMA transaction limit (one HugePage)
+constexpr std::size_t HOCS_MAX_PAYLOAD_BYTES = 4u * 1024 * 1024;
+
+// One crossbar-sized block of the weight matrix. Edge tiles cover fewer
+// than tile_dim rows/columns and are zero padded when packed.
+struct HOCSTile {
+    uint32_t tile_id; // TILE_ID of the job packet (row-major over the tile grid)
+    int tile_row;
+    int tile_col;
+    int row0;         // Origin in the weight matrix
+    int col0;
+    int rows;         // Valid extent
+    int cols;
+};
+
+class HOCSTilePlan {
+private:
+    int matrix_rows;
+    int matrix_cols;
+    int tile_dim;
+    int grid_rows;
+    int grid_cols;
+    std::vector<HOCSTile> tiles;
+
+public:
+    // rows x cols weight matrix (rows = output currents, cols = input voltages)
+    HOCSTilePlan(int rows, int cols, int tile = HOCS_TILE_DIM)
+        : matrix_rows(rows), matrix_cols(cols), tile_dim(tile) {
+        if (rows <= 0 || cols <= 0 || tile <= 0) {
+            throw std::invalid_argument("HOCSTilePlan: matrix and tile dimensions must be positive");
+        }
+        if (static_cast<std::size_t>(tile) * tile * sizeof(int16_t) > HOCS_MAX_PAYLOAD_BYTES) {
+            throw std::invalid_argument("HOCSTilePlan: tile payload exceeds the 4 MB DMA limit");
+        }
+
+        grid_rows = (rows + tile - 1) / tile;
+        grid_cols = (cols + tile - 1) / tile;
+        tiles.reserve(static_cast<std::size_t>(grid_rows) * grid_cols);
+
+        // TILE_ID = tile_row * grid_cols + tile_col: the tiles of one output
+        // band are consecutive, so a band can be reduced by a single worker
+        for (int tr = 0; tr < grid_rows; ++tr) {
+            for (int tc = 0; tc < grid_cols; ++tc) {
+                HOCSTile t;
+                t.tile_id = static_cast<uint32_t>(tiles.size());
+                t.tile_row = tr;
+                t.tile_col = tc;
+                t.row0 = tr * tile;
+                t.col0 = tc * tile;
+                t.rows = std::min(tile, rows - t.row0);
+                t.cols = std::min(tile, cols - t.col0);
+                tiles.push_back(t);
+            }
+        }
+    }
+
+    int rows() const { return matrix_rows; }
+    int cols() const { return matrix_cols; }
+    int tile_size() const { return tile_dim; }
+    int tile_grid_rows() const { return grid_rows; }
+    int tile_grid_cols() const { return grid_cols; }
+    std::size_t tile_count() const { return tiles.size(); }
+
+    const std::vector<HOCSTile>& all_tiles() const { return tiles; }
+    const HOCSTile& tile(uint32_t tile_id) const { return tiles.at(tile_id); }
+    const HOCSTile& tile_at(int tile_row, int tile_col) const {
+        return tiles.at(static_cast<std::size_t>(tile_row) * grid_cols + tile_col);
+    }
+
+    // Cells of one packed (padded) tile
+    std::size_t tile_cells() const { return static_cast<std::size_t>(tile_dim) * tile_dim; }
+
+    // Job packet payload of one tile in the Int16 (Q4.12) wire format
+    std::size_t payload_bytes() const { return tile_cells() * sizeof(int16_t); }
+};
+
+// Block-CSR occupancy at tile granularity: per tile row (band) the TILE_IDs
+// holding at least one on cell. Off tiles are neither transferred nor
+// propagated; a band without tiles produces zero currents.
+struct HOCSBlockCSR {
+    std::vector<uint32_t> band_offsets; // Band r owns tile_ids[band_offsets[r], band_offsets[r + 1])
+    std::vector<uint32_t> tile_ids;     // On tiles, ascending TILE_ID
+
+    std::size_t tile_count() const { return tile_ids.size(); }
+    uint32_t band_begin(int tile_row) const { return band_offsets[tile_row]; }
+    uint32_t band_end(int tile_row) const { return band_offsets[tile_row + 1]; }
+};
+
+// Occupancy of a row-major matrix (leading dimension ld) under `plan`: a cell
+// is on when |value| > threshold. Stops scanning a tile at its first on cell.
+template <typename Src>
+HOCSBlockCSR hocs_block_csr(const Src* matrix, std::size_t ld, const HOCSTilePlan& plan, double threshold = 0.0) {
+    HOCSBlockCSR csr;
+    csr.band_offsets.reserve(plan.tile_grid_rows() + 1);
+    csr.band_offsets.push_back(0);
+    for (int tr = 0; tr < plan.tile_grid_rows(); ++tr) {
+        for (int tc = 0; tc < plan.tile_grid_cols(); ++tc) {
+            const HOCSTile& tile = plan.tile_at(tr, tc);
+            bool on = false;
+            for (int r = 0; r < tile.rows && !on; ++r) {
+                const Src* row = matrix + static_cast<std::size_t>(tile.row0 + r) * ld + tile.col0;
+                for (int c = 0; c < tile.cols && !on; ++c) on = std::abs(static_cast<double>(row[c])) > threshold;
+            }
+            if (on) csr.tile_ids.push_back(tile.tile_id);
+        }
+        csr.band_offsets.push_back(static_cast<uint32_t>(csr.tile_ids.size()));
+    }
+    return csr;
+}
+
+// Copies one tile of a row-major matrix (leading dimension ld) into a dense
+// tile_dim x tile_dim block, converting through ElementTraits<Element>.
+// Cells outside the valid extent are written as zero, so padded rows and
+// columns neither draw current nor contribute to it.
+template <typename Element, typename Src>
+void hocs_pack_tile(const Src* matrix, std::size_t ld, const HOCSTile& tile, int tile_dim,
+                    typename ElementTraits<Element>::storage_type* out) {
+    using Traits = ElementTraits<Element>;
+    using value_type = typename Traits::storage_type;
+    const value_type zero = Traits::from_double(0.0);
+
+    for (int r = 0; r < tile_dim; ++r) {
+        value_type* out_row = out + static_cast<std::size_t>(r) * tile_dim;
+        if (r >= tile.rows) {
+            std::fill(out_row, out_row + tile_dim, zero);
+            continue;
+        }
+        const Src* src_row = matrix + static_cast<std::size_t>(tile.row0 + r) * ld + tile.col0;
+        for (int c = 0; c < tile.cols; ++c) {
+            out_row[c] = Traits::from_double(static_cast<double>(src_row[c]));
+        }
+        std::fill(out_row + tile.cols, out_row + tile_dim, zero);
+    }
+}
+
+#endif // HOCS_TILER_HPP
@@ -7,9 +7,19 @@
  * Description: 
  * Character device driver for HOCS FPGA Accelerator.
  * Maps FPGA AXI BARs to User Space and handles DMA Interrupts.
+ * mmap() exposes the BAR0 registers and a coherent DMA buffer, so user
+ * space moves data and polls status without a syscall (hocs_uapi.h).
+ * A writable register window bypasses descriptor validation and needs
+ * CAP_SYS_RAWIO; everyone else submits through HOCS_IOC_SUBMIT.
+ * Completions are counted in the IRQ handler (or busy-polled) and wake
+ * readers through a wait queue, coalesced per irq_coalesce tiles; a 100 ms
+ * watchdog soft-resets a core that stopped making progress.
+ * HOCS_IOC_SUBMIT queues whole batches of job descriptors, started back to
+ * back from the completion IRQ; HOCS_IOC_REAP returns their completions.
  */
 
 #include <linux/module.h>
+#include <linux/capability.h>
 #include <linux/kernel.h>
 #include <linux/init.h>
 #include <linux/fs.h>
@@ -17,17 +27,53 @@
 #include <linux/uaccess.h>
 #include <linux/io.h>
 #include <linux/interrupt.h>
+#include <linux/hrtimer.h>
+#include <linux/ktime.h>
+#include <linux/poll.h>
+#include <linux/sched.h>
+#include <linux/slab.h>
+#include <linux/spinlock.h>
+#include <linux/timer.h>
+#include <linux/wait.h>
+#include <linux/mm.h>
+#include <linux/mutex.h>
+#include <linux/dma-mapping.h>
 #include <linux/of_address.h>
 #include <linux/of_device.h>
 #include <linux/platform_device.h>
 
+#include "hocs_uapi.h"
+
 #define DRIVER_NAME "hocs_accelerator"
 #define HOCS_CLASS_NAME "hocs_fpga"
 
 // Hardware Register Offsets (AXI Lite)
-#define REG_CONTROL 0x00
-#define REG_STATUS  0x04
-#define REG_IRQ_ACK 0x08
+#define REG_CONTROL HOCS_REG_CONTROL
+#define REG_STATUS  HOCS_REG_STATUS
+#define REG_IRQ_ACK HOCS_REG_IRQ_ACK
+
+static unsigned int dma_buffer_mb = 64;
+module_param(dma_buffer_mb, uint, 0444);
+MODULE_PARM_DESC(dma_buffer_mb, "Coherent DMA buffer exported through mmap() (MB)");
+
+static unsigned int irq_coalesce = 1;
+module_param(irq_coalesce, uint, 0644);
+MODULE_PARM_DESC(irq_coalesce, "Completed tiles per reader wakeup (1 = wake on every tile)");
+
+static unsigned int coalesce_usecs = 50;
+module_param(coalesce_usecs, uint, 0644);
+MODULE_PARM_DESC(coalesce_usecs, "Longest a partial coalesced batch waits before readers are woken");
+
+static unsigned int busy_poll_usecs;
+module_param(busy_poll_usecs, uint, 0644);
+MODULE_PARM_DESC(busy_poll_usecs, "read() spins on the hardware this long before sleeping (0 = off)");
+
+// ICD section 4: DONE must follow within 100 ms. Checked every half period,
+// so a stalled core is reset after 100-150 ms without a completion.
+#define HOCS_WATCHDOG_MS 100
+#define HOCS_WATCHDOG_TICK_MS (HOCS_WATCHDOG_MS / 2)
+
+#define HOCS_RING_MASK (HOCS_RING_ENTRIES - 1)
 
 // Global Driver State
 struct hocs_dev_t {
@@ -37,57 +83,573 @@ struct hocs_dev_t {
     struct device *dev_device;
     void __iomem *bar0_base; // Physical Memory Map
     int irq_number;
+
+    // Filled in by hocs_probe(); mmap() fails with -ENODEV before that
+    struct device *hw_dev;       // DMA-capable platform device
+    phys_addr_t bar0_phys;
+    resource_size_t bar0_len;
+    void *dma_virt;              // Coherent buffer shared with user space
+    dma_addr_t dma_handle;       // Its bus address, as the FPGA sees it
+    size_t dma_size;
+
+    // Completion accounting, guarded by lock (taken from IRQ context)
+    spinlock_t lock;
+    wait_queue_head_t completion_wait;
+    u64 completed;               // Acked by hocs_reap()
+    u64 published;               // Visible to readers (coalesced)
+    u64 watchdog_resets;
+    struct hrtimer coalesce_timer; // Flushes a partial batch
+    struct timer_list watchdog;
+    u64 watchdog_mark;           // completed at the previous watchdog tick
+    unsigned int stalled_ticks;
+
+    // Descriptor ring, positions grow monotonically (slot = pos & HOCS_RING_MASK):
+    //   [ring_head, ring_done)      completed, waiting for HOCS_IOC_REAP
+    //   [ring_done, ring_dispatch)  running on the core (at most one)
+    //   [ring_dispatch, ring_tail)  queued
+    // Cursors are guarded by lock; submit_lock / reap_lock serialize the
+    // (sleeping) copies of submitters and reapers.
+    struct hocs_job_desc ring_desc[HOCS_RING_ENTRIES];
+    struct hocs_job_completion ring_cpl[HOCS_RING_ENTRIES];
+    u64 ring_head;
+    u64 ring_done;
+    u64 ring_dispatch;
+    u64 ring_tail;
+    struct mutex submit_lock;
+    struct mutex reap_lock;
 } hocs_dev;
 
+// Per open file: what this reader has already been told
+struct hocs_file {
+    u64 seen;
+    u64 resets_seen;
+};
+
+// --- DESCRIPTOR RING ---
+
+// Starts the next queued descriptor if the core is not running one. Caller holds lock.
+static void hocs_ring_dispatch_locked(void) {
+    struct hocs_job_desc *desc;
+    void __iomem *base = hocs_dev.bar0_base;
+
+    if (hocs_dev.ring_dispatch != hocs_dev.ring_done || hocs_dev.ring_dispatch == hocs_dev.ring_tail) {
+        return;
+    }
+    desc = &hocs_dev.ring_desc[hocs_dev.ring_dispatch & HOCS_RING_MASK];
+    iowrite32(lower_32_bits(desc->src_addr), base + HOCS_REG_JOB_SRC_LO);
+    iowrite32(upper_32_bits(desc->src_addr), base + HOCS_REG_JOB_SRC_HI);
+    iowrite32(lower_32_bits(desc->dst_addr), base + HOCS_REG_JOB_DST_LO);
+    iowrite32(upper_32_bits(desc->dst_addr), base + HOCS_REG_JOB_DST_HI);
+    iowrite32(desc->length, base + HOCS_REG_JOB_LENGTH);
+    iowrite32(desc->result_length, base + HOCS_REG_JOB_RESULT_LEN);
+    iowrite32(desc->opcode, base + HOCS_REG_JOB_OPCODE);
+    iowrite32(desc->tile_id, base + HOCS_REG_JOB_TILE_ID);
+    iowrite32(HOCS_CONTROL_START, base + REG_CONTROL);
+    hocs_dev.ring_dispatch++;
+}
+
+// Retires the running descriptor (if any) and starts the next. Caller holds lock.
+static void hocs_ring_complete_locked(u32 status) {
+    struct hocs_job_completion *cpl;
+
+    if (hocs_dev.ring_done == hocs_dev.ring_dispatch) {
+        return; // Not a ring job (legacy write() or mmap doorbell)
+    }
+    cpl = &hocs_dev.ring_cpl[hocs_dev.ring_done & HOCS_RING_MASK];
+    cpl->tile_id = hocs_dev.ring_desc[hocs_dev.ring_done & HOCS_RING_MASK].tile_id;
+    cpl->status = status;
+    hocs_dev.ring_done++;
+    hocs_ring_dispatch_locked();
+}
+
+// Source and destination must stay inside the driver's coherent buffer:
+// the core would otherwise DMA to arbitrary physical memory
+static bool hocs_dma_range_ok(u64 addr, u32 len) {
+    u64 base = hocs_dev.dma_handle;
+    return addr >= base && addr - base <= hocs_dev.dma_size && len <= hocs_dev.dma_size - (addr - base);
+}
+
+static bool hocs_desc_ok(const struct hocs_job_desc *desc) {
+    return desc->opcode >= HOCS_OPCODE_WRITE && desc->opcode <= HOCS_OPCODE_CONFIG &&
+           desc->length > 0 && hocs_dma_range_ok(desc->src_addr, desc->length) &&
+           (desc->result_length == 0 || hocs_dma_range_ok(desc->dst_addr, desc->result_length));
+}
+
+static long hocs_ioctl_submit(struct hocs_submit_args __user *uargs) {
+    struct hocs_submit_args args;
+    struct hocs_job_desc __user *udescs;
+    unsigned long flags;
+    u64 tail, space;
+    u32 i, n;
+    long ret = 0;
+
+    if (copy_from_user(&args, uargs, sizeof(args))) {
+        return -EFAULT;
+    }
+    udescs = u64_to_user_ptr(args.descs);
+
+    mutex_lock(&hocs_dev.submit_lock);
+    spin_lock_irqsave(&hocs_dev.lock, flags);
+    tail = hocs_dev.ring_tail;
+    space = HOCS_RING_ENTRIES - (tail - hocs_dev.ring_head);
+    spin_unlock_irqrestore(&hocs_dev.lock, flags);
+
+    // Slots past ring_tail belong to the submitter until they are published
+    n = (u32)min_t(u64, args.count, space);
+    for (i = 0; i < n; i++) {
+        struct hocs_job_desc *slot = &hocs_dev.ring_desc[(tail + i) & HOCS_RING_MASK];
+        if (copy_from_user(slot, &udescs[i], sizeof(*slot))) {
+            ret = -EFAULT;
+            break;
+        }
+        if (!hocs_desc_ok(slot)) {
+            ret = -EINVAL;
+            break;
+        }
+    }
+
+    spin_lock_irqsave(&hocs_dev.lock, flags);
+    hocs_dev.ring_tail = tail + i;
+    hocs_ring_dispatch_locked();
+    spin_unlock_irqrestore(&hocs_dev.lock, flags);
+    mutex_unlock(&hocs_dev.submit_lock);
+
+    // Descriptors before a bad one are queued; report the error only if none were
+    if (i > 0) {
+        ret = 0;
+    } else if (ret == 0 && args.count > 0) {
+        ret = -EAGAIN; // Ring full: reap completions first
+    }
+    args.accepted = i;
+    if (ret == 0 && copy_to_user(uargs, &args, sizeof(args))) {
+        ret = -EFAULT;
+    }
+    return ret;
+}
+
+static long hocs_ioctl_reap(struct hocs_reap_args __user *uargs) {
+    struct hocs_reap_args args;
+    struct hocs_job_completion __user *uentries;
+    unsigned long flags;
+    u64 head, ready;
+    u32 n, first;
+    long ret = 0;
+
+    if (copy_from_user(&args, uargs, sizeof(args))) {
+        return -EFAULT;
+    }
+    uentries = u64_to_user_ptr(args.entries);
+
+    mutex_lock(&hocs_dev.reap_lock);
+    spin_lock_irqsave(&hocs_dev.lock, flags);
+    head = hocs_dev.ring_head;
+    ready = hocs_dev.ring_done - head;
+    spin_unlock_irqrestore(&hocs_dev.lock, flags);
+
+    // Completed slots stay untouched until ring_head passes them
+    n = (u32)min_t(u64, args.max, ready);
+    first = min_t(u32, n, HOCS_RING_ENTRIES - (u32)(head & HOCS_RING_MASK)); // Up to the wrap
+    if (copy_to_user(uentries, &hocs_dev.ring_cpl[head & HOCS_RING_MASK], first * sizeof(*uentries)) ||
+        copy_to_user(uentries + first, &hocs_dev.ring_cpl[0], (n - first) * sizeof(*uentries))) {
+        ret = -EFAULT;
+    } else {
+        spin_lock_irqsave(&hocs_dev.lock, flags);
+        hocs_dev.ring_head = head + n;
+        spin_unlock_irqrestore(&hocs_dev.lock, flags);
+    }
+    mutex_unlock(&hocs_dev.reap_lock);
+
+    args.count = ret ? 0 : n;
+    if (ret == 0 && copy_to_user(uargs, &args, sizeof(args))) {
+        ret = -EFAULT;
+    }
+    return ret;
+}
+
+// --- COMPLETION PATH (IRQ, busy-poll, coalescing, watchdog) ---
+
+// Makes every acked completion visible and wakes the readers. Caller holds lock.
+static void hocs_publish_locked(void) {
+    if (hocs_dev.published != hocs_dev.completed) {
+        hocs_dev.published = hocs_dev.completed;
+        wake_up_interruptible(&hocs_dev.completion_wait);
+    }
+}
+
+static enum hrtimer_restart hocs_coalesce_expired(struct hrtimer *timer) {
+    unsigned long flags;
+
+    spin_lock_irqsave(&hocs_dev.lock, flags);
+    hocs_publish_locked();
+    spin_unlock_irqrestore(&hocs_dev.lock, flags);
+    return HRTIMER_NORESTART;
+}
+
+// Acks one completion if the core raised it. Readers are woken once
+// irq_coalesce tiles are pending or coalesce_usecs after the first one;
+// `publish_now` (busy-poll) wakes immediately. Shared by the IRQ handler
+// and the busy-poll loop, so the lock serializes the ack.
+static bool hocs_reap(bool publish_now) {
+    unsigned long flags;
+    bool handled = false;
+
+    spin_lock_irqsave(&hocs_dev.lock, flags);
+    if (ioread32(hocs_dev.bar0_base + REG_IRQ_ACK) & 0x01) {
+        // Clear Interrupt
+        iowrite32(0x01, hocs_dev.bar0_base + REG_IRQ_ACK);
+        hocs_dev.completed++;
+        hocs_ring_complete_locked(HOCS_JOB_OK);
+        handled = true;
+
+        if (publish_now || hocs_dev.completed - hocs_dev.published >= max(irq_coalesce, 1u)) {
+            hrtimer_try_to_cancel(&hocs_dev.coalesce_timer);
+            hocs_publish_locked();
+        } else if (!hrtimer_active(&hocs_dev.coalesce_timer)) {
+            hrtimer_start(&hocs_dev.coalesce_timer, ns_to_ktime((u64)coalesce_usecs * NSEC_PER_USEC),
+                          HRTIMER_MODE_REL);
+        }
+    }
+    spin_unlock_irqrestore(&hocs_dev.lock, flags);
+    return handled;
+}
+
+static bool hocs_has_news(struct hocs_file *ctx) {
+    unsigned long flags;
+    bool news;
+
+    spin_lock_irqsave(&hocs_dev.lock, flags);
+    news = hocs_dev.published != ctx->seen || hocs_dev.watchdog_resets != ctx->resets_seen;
+    spin_unlock_irqrestore(&hocs_dev.lock, flags);
+    return news || !hocs_dev.hw_dev;
+}
+
+// Lowest latency: spin on the acknowledge register instead of sleeping
+// until the IRQ, for at most busy_poll_usecs
+static void hocs_busy_poll(struct hocs_file *ctx) {
+    ktime_t deadline = ktime_add_us(ktime_get(), busy_poll_usecs);
+
+    while (!hocs_has_news(ctx) && ktime_before(ktime_get(), deadline)) {
+        if (!hocs_reap(true)) {
+            cpu_relax();
+        }
+    }
+}
+
+// Also covers jobs started through the mmap()ed doorbell, which the driver
+// never sees: a core that stays BUSY without completing is reset
+static void hocs_watchdog_tick(struct timer_list *timer) {
+    unsigned long flags;
+    bool reset = false;
+    u32 status = ioread32(hocs_dev.bar0_base + REG_STATUS);
+
+    spin_lock_irqsave(&hocs_dev.lock, flags);
+    if ((status & HOCS_STATUS_BUSY) && hocs_dev.completed == hocs_dev.watchdog_mark) {
+        if (++hocs_dev.stalled_ticks >= HOCS_WATCHDOG_MS / HOCS_WATCHDOG_TICK_MS) {
+            iowrite32(HOCS_CONTROL_SOFT_RESET, hocs_dev.bar0_base + REG_CONTROL);
+            hocs_dev.watchdog_resets++;
+            hocs_dev.stalled_ticks = 0;
+            // The running descriptor failed; the rest of the ring carries on
+            hocs_ring_complete_locked(HOCS_JOB_TIMEOUT);
+            hocs_publish_locked();
+            wake_up_interruptible(&hocs_dev.completion_wait);
+            reset = true;
+        }
+    } else {
+        hocs_dev.stalled_ticks = 0;
+    }
+    hocs_dev.watchdog_mark = hocs_dev.completed;
+    spin_unlock_irqrestore(&hocs_dev.lock, flags);
+
+    if (reset) {
+        dev_warn_ratelimited(hocs_dev.hw_dev, "HOCS: No DONE within %d ms, Watchdog Reset issued\n",
+                             HOCS_WATCHDOG_MS);
+    }
+    mod_timer(&hocs_dev.watchdog, jiffies + msecs_to_jiffies(HOCS_WATCHDOG_TICK_MS));
+}
+
 // --- FILE OPERATIONS ---
 
 static int hocs_open(struct inode *inode, struct file *file) {
+    struct hocs_file *ctx = kzalloc(sizeof(*ctx), GFP_KERNEL);
+    unsigned long flags;
+
+    if (!ctx) {
+        return -ENOMEM;
+    }
+    // Only completions after open() wake this reader
+    spin_lock_irqsave(&hocs_dev.lock, flags);
+    ctx->seen = hocs_dev.published;
+    ctx->resets_seen = hocs_dev.watchdog_resets;
+    spin_unlock_irqrestore(&hocs_dev.lock, flags);
+    file->private_data = ctx;
+
     printk(KERN_INFO "HOCS: Device Opened by User Process\n");
     return 0;
 }
 
+static int hocs_release(struct inode *inode, struct file *file) {
+    kfree(file->private_data);
+    return 0;
+}
+
 static ssize_t hocs_read(struct file *file, char __user *buf, size_t len, loff_t *offset) {
-    // Reads status from FPGA hardware register
-    u32 status_reg = ioread32(hocs_dev.bar0_base + REG_STATUS);
-    
-    if (copy_to_user(buf, &status_reg, sizeof(status_reg))) {
+    struct hocs_file *ctx = file->private_data;
+    struct hocs_completion event;
+    unsigned long flags;
+    u32 status_reg;
+    int ret;
+
+    if (!hocs_dev.bar0_base) {
+        return -ENODEV;
+    }
+
+    // Legacy: a 4-byte read returns the status register without waiting
+    if (len == sizeof(status_reg)) {
+        status_reg = ioread32(hocs_dev.bar0_base + REG_STATUS);
+        if (copy_to_user(buf, &status_reg, sizeof(status_reg))) {
+            return -EFAULT;
+        }
+        pr_debug("HOCS: Status Register Read: 0x%08X\n", status_reg);
+        return sizeof(status_reg);
+    }
+    if (len < sizeof(event)) {
+        return -EINVAL;
+    }
+
+    if (busy_poll_usecs && !hocs_has_news(ctx)) {
+        hocs_busy_poll(ctx);
+    }
+    if (!hocs_has_news(ctx)) {
+        if (file->f_flags & O_NONBLOCK) {
+            return -EAGAIN;
+        }
+        ret = wait_event_interruptible(hocs_dev.completion_wait, hocs_has_news(ctx));
+        if (ret) {
+            return ret;
+        }
+    }
+    if (!hocs_dev.hw_dev) {
+        return -ENODEV; // Device removed while sleeping
+    }
+
+    spin_lock_irqsave(&hocs_dev.lock, flags);
+    event.completed = hocs_dev.published;
+    event.watchdog_resets = hocs_dev.watchdog_resets;
+    event.flags = hocs_dev.watchdog_resets != ctx->resets_seen ? HOCS_COMPLETION_WATCHDOG : 0;
+    ctx->seen = hocs_dev.published;
+    ctx->resets_seen = hocs_dev.watchdog_resets;
+    spin_unlock_irqrestore(&hocs_dev.lock, flags);
+    event.status = ioread32(hocs_dev.bar0_base + REG_STATUS);
+
+    if (copy_to_user(buf, &event, sizeof(event))) {
         return -EFAULT;
     }
-    printk(KERN_INFO "HOCS: Status Register Read: 0x%08X\n", status_reg);
-    return sizeof(status_reg);
+    return sizeof(event);
+}
+
+static long hocs_ioctl(struct file *file, unsigned int cmd, unsigned long arg) {
+    if (!hocs_dev.hw_dev) {
+        return -ENODEV;
+    }
+    switch (cmd) {
+    case HOCS_IOC_SUBMIT:
+        return hocs_ioctl_submit((struct hocs_submit_args __user *)arg);
+    case HOCS_IOC_REAP:
+        return hocs_ioctl_reap((struct hocs_reap_args __user *)arg);
+    default:
+        return -ENOTTY;
+    }
+}
+
+static __poll_t hocs_poll(struct file *file, poll_table *wait) {
+    struct hocs_file *ctx = file->private_data;
+
+    poll_wait(file, &hocs_dev.completion_wait, wait);
+    if (!hocs_dev.hw_dev) {
+        return EPOLLERR;
+    }
+    return hocs_has_news(ctx) ? EPOLLIN | EPOLLRDNORM : 0;
 }
 
 static ssize_t hocs_write(struct file *file, const char __user *buf, size_t len, loff_t *offset) {
     u32 cmd_reg;
-    
-    if (copy_from_user(&cmd_reg, buf, len)) {
+
+    if (!hocs_dev.bar0_base) {
+        return -ENODEV;
+    }
+    // Exactly one 32-bit command word; anything else would overrun cmd_reg
+    if (len != sizeof(cmd_reg)) {
+        return -EINVAL;
+    }
+    if (copy_from_user(&cmd_reg, buf, sizeof(cmd_reg))) {
         return -EFAULT;
     }
-    
+
     // Write directly to FPGA Physical Memory (Dangerous & Powerful)
     iowrite32(cmd_reg, hocs_dev.bar0_base + REG_CONTROL);
-    printk(KERN_INFO "HOCS: Command 0x%08X sent to Optical Core\n", cmd_reg);
+    pr_debug("HOCS: Command 0x%08X sent to Optical Core\n", cmd_reg);
     return len;
 }
 
+// Offset HOCS_MMAP_REGS_OFFSET maps the BAR0 window uncached,
+// HOCS_MMAP_DMA_OFFSET the coherent DMA buffer. JOB_SRC/DST and CONTROL
+// share the register page, so a writable window would start DMA that
+// hocs_desc_ok() never saw: without CAP_SYS_RAWIO it is read-only.
+static int hocs_mmap(struct file *file, struct vm_area_struct *vma) {
+    unsigned long offset = vma->vm_pgoff << PAGE_SHIFT;
+    unsigned long len = vma->vm_end - vma->vm_start;
+
+    if (!hocs_dev.hw_dev) {
+        return -ENODEV;
+    }
+
+    if (offset == HOCS_MMAP_REGS_OFFSET) {
+        if (len > PAGE_ALIGN(hocs_dev.bar0_len)) {
+            return -EINVAL;
+        }
+        if (!capable(CAP_SYS_RAWIO)) {
+            if (vma->vm_flags & VM_WRITE) {
+                return -EPERM;
+            }
+            vma->vm_flags &= ~VM_MAYWRITE;  // No mprotect() upgrade either
+        }
+        vma->vm_page_prot = pgprot_noncached(vma->vm_page_prot);
+        vma->vm_flags |= VM_IO | VM_DONTEXPAND | VM_DONTDUMP;
+        return io_remap_pfn_range(vma, vma->vm_start, hocs_dev.bar0_phys >> PAGE_SHIFT,
+                                  len, vma->vm_page_prot);
+    }
+
+    if (offset == HOCS_MMAP_DMA_OFFSET) {
+        if (len > hocs_dev.dma_size) {
+            return -EINVAL;
+        }
+        // dma_mmap_coherent() reads vm_pgoff as the offset into the buffer
+        vma->vm_pgoff = 0;
+        return dma_mmap_coherent(hocs_dev.hw_dev, vma, hocs_dev.dma_virt,
+                                 hocs_dev.dma_handle, hocs_dev.dma_size);
+    }
+
+    return -EINVAL;
+}
+
+// --- SYSFS (bus address of the DMA buffer for user-space descriptors) ---
+
+static ssize_t dma_phys_addr_show(struct device *dev, struct device_attribute *attr, char *buf) {
+    return sprintf(buf, "0x%llx\n", (unsigned long long)hocs_dev.dma_handle);
+}
+static DEVICE_ATTR_RO(dma_phys_addr);
+
+static ssize_t dma_size_show(struct device *dev, struct device_attribute *attr, char *buf) {
+    return sprintf(buf, "%zu\n", hocs_dev.dma_size);
+}
+static DEVICE_ATTR_RO(dma_size);
+
+static struct attribute *hocs_attrs[] = {
+    &dev_attr_dma_phys_addr.attr,
+    &dev_attr_dma_size.attr,
+    NULL,
+};
+ATTRIBUTE_GROUPS(hocs);
+
 // --- INTERRUPT HANDLER (The Pulse of Hardware) ---
+// Hot path: ack, count, maybe wake. No logging here.
 static irqreturn_t hocs_irq_handler(int irq, void *dev_id) {
-    u32 irq_status = ioread32(hocs_dev.bar0_base + REG_IRQ_ACK);
-    
-    if (irq_status & 0x01) {
-        printk(KERN_INFO "HOCS: Optical Calculation Completed (IRQ Triggered)\n");
-        // Clear Interrupt
-        iowrite32(0x01, hocs_dev.bar0_base + REG_IRQ_ACK);
-        return IRQ_HANDLED;
-    }
-    return IRQ_NONE;
+    return hocs_reap(false) ? IRQ_HANDLED : IRQ_NONE;
 }
 
 static struct file_operations fops = {
     .owner = THIS_MODULE,
     .open = hocs_open,
+    .release = hocs_release,
     .read = hocs_read,
+    .poll = hocs_poll,
+    .unlocked_ioctl = hocs_ioctl,
+    .compat_ioctl = compat_ptr_ioctl, // User pointers travel as __u64: same layout for 32-bit callers
     .write = hocs_write,
+    .mmap = hocs_mmap,
+};
+
+// --- PLATFORM DEVICE (BAR0, IRQ and DMA buffer from the device tree) ---
+
+static int hocs_probe(struct platform_device *pdev) {
+    struct resource *res;
+    int ret;
+
+    res = platform_get_resource(pdev, IORESOURCE_MEM, 0);
+    hocs_dev.bar0_base = devm_ioremap_resource(&pdev->dev, res);
+    if (IS_ERR(hocs_dev.bar0_base)) {
+        ret = PTR_ERR(hocs_dev.bar0_base);
+        hocs_dev.bar0_base = NULL;
+        return ret;
+    }
+    hocs_dev.bar0_phys = res->start;
+    hocs_dev.bar0_len = resource_size(res);
+
+    hocs_dev.irq_number = platform_get_irq(pdev, 0);
+    if (hocs_dev.irq_number < 0) {
+        ret = hocs_dev.irq_number;
+        goto err_unmap;
+    }
+    ret = devm_request_irq(&pdev->dev, hocs_dev.irq_number, hocs_irq_handler, 0, DRIVER_NAME, &hocs_dev);
+    if (ret) {
+        goto err_unmap;
+    }
+
+    ret = dma_set_mask_and_coherent(&pdev->dev, DMA_BIT_MASK(64));
+    if (ret) {
+        ret = dma_set_mask_and_coherent(&pdev->dev, DMA_BIT_MASK(32));
+    }
+    if (ret) {
+        goto err_unmap;
+    }
+    hocs_dev.dma_size = (size_t)dma_buffer_mb << 20;
+    hocs_dev.dma_virt = dma_alloc_coherent(&pdev->dev, hocs_dev.dma_size, &hocs_dev.dma_handle, GFP_KERNEL);
+    if (!hocs_dev.dma_virt) {
+        ret = -ENOMEM;
+        goto err_unmap;
+    }
+
+    hocs_dev.hw_dev = &pdev->dev;
+    hocs_dev.stalled_ticks = 0;
+    hocs_dev.watchdog_mark = hocs_dev.completed;
+    mod_timer(&hocs_dev.watchdog, jiffies + msecs_to_jiffies(HOCS_WATCHDOG_TICK_MS));
+    printk(KERN_INFO "HOCS: Optical Core at %pa, IRQ %d, %u MB DMA buffer at %pad\n",
+           &hocs_dev.bar0_phys, hocs_dev.irq_number, dma_buffer_mb, &hocs_dev.dma_handle);
+    return 0;
+
+err_unmap:
+    // devm releases the mapping and IRQ; only clear the stale pointer
+    hocs_dev.bar0_base = NULL;
+    return ret;
+}
+
+static int hocs_remove(struct platform_device *pdev) {
+    del_timer_sync(&hocs_dev.watchdog);
+    // Free the IRQ before cancelling the coalescing timer, so nothing re-arms
+    // it; sleeping readers then wake up and see -ENODEV
+    devm_free_irq(&pdev->dev, hocs_dev.irq_number, &hocs_dev);
+    hrtimer_cancel(&hocs_dev.coalesce_timer);
+    hocs_dev.hw_dev = NULL;
+    wake_up_interruptible_all(&hocs_dev.completion_wait);
+    dma_free_coherent(&pdev->dev, hocs_dev.dma_size, hocs_dev.dma_virt, hocs_dev.dma_handle);
+    hocs_dev.dma_virt = NULL;
+    hocs_dev.bar0_base = NULL;
+    return 0;
+}
+
+static const struct of_device_id hocs_of_match[] = {
+    { .compatible = "hocs,optical-core-1.0" },
+    { }
+};
+MODULE_DEVICE_TABLE(of, hocs_of_match);
+
+static struct platform_driver hocs_platform_driver = {
+    .probe = hocs_probe,
+    .remove = hocs_remove,
+    .driver = {
+        .name = DRIVER_NAME,
+        .of_match_table = hocs_of_match,
+    },
 };
 
 // --- MODULE INITIALIZATION ---
@@ -97,6 +659,14 @@ static int __init hocs_driver_init(void) {
 
     printk(KERN_INFO "HOCS: Initializing Kernel Module...\n");
 
+    spin_lock_init(&hocs_dev.lock);
+    mutex_init(&hocs_dev.submit_lock);
+    mutex_init(&hocs_dev.reap_lock);
+    init_waitqueue_head(&hocs_dev.completion_wait);
+    hrtimer_init(&hocs_dev.coalesce_timer, CLOCK_MONOTONIC, HRTIMER_MODE_REL);
+    hocs_dev.coalesce_timer.function = hocs_coalesce_expired;
+    timer_setup(&hocs_dev.watchdog, hocs_watchdog_tick, 0);
+
     // 1. Allocate Major Number dynamically
     if (alloc_chrdev_region(&hocs_dev.dev_num, 0, 1, DRIVER_NAME) < 0) {
         return -1;
@@ -108,8 +678,9 @@ static int __init hocs_driver_init(void) {
         return -1;
     }
 
-    // 3. Create Device File (/dev/hocs_accelerator)
-    if (device_create(hocs_dev.dev_class, NULL, hocs_dev.dev_num, NULL, DRIVER_NAME) == NULL) {
+    // 3. Create Device File (/dev/hocs_accelerator) with its sysfs attributes
+    hocs_dev.dev_class->dev_groups = hocs_groups;
+    if ((hocs_dev.dev_device = device_create(hocs_dev.dev_class, NULL, hocs_dev.dev_num, NULL, DRIVER_NAME)) == NULL) {
         class_destroy(hocs_dev.dev_class);
         unregister_chrdev_region(hocs_dev.dev_num, 1);
         return -1;
@@ -124,14 +695,22 @@ static int __init hocs_driver_init(void) {
         return -1;
     }
 
-    // Note: real 'ioremap' and 'request_irq' would happen in the probe function
-    // for a platform driver, but this structure demonstrates the logic.
-    
+    // 5. Bind to the FPGA: ioremap, request_irq and the DMA buffer happen in hocs_probe()
+    ret = platform_driver_register(&hocs_platform_driver);
+    if (ret) {
+        cdev_del(&hocs_dev.cdev);
+        device_destroy(hocs_dev.dev_class, hocs_dev.dev_num);
+        class_destroy(hocs_dev.dev_class);
+        unregister_chrdev_region(hocs_dev.dev_num, 1);
+        return ret;
+    }
+
     printk(KERN_INFO "HOCS: Kernel Module Loaded Successfully. /dev/%s created.\n", DRIVER_NAME);
     return 0;
 }
 
 static void __exit hocs_driver_exit(void) {
+    platform_driver_unregister(&hocs_platform_driver);
     cdev_del(&hocs_dev.cdev);
     device_destroy(hocs_dev.dev_class, hocs_dev.dev_num);
     class_destroy(hocs_dev.dev_class);
@@ -0,0 +1,121 @@
+/*
+ * HOCS ACCELERATOR USER-SPACE ABI
+ * ===============================
+ * Module: hocs_pci
+ * License: GPL-2.0 WITH Linux-syscall-note
+ * Description:
+ * Layout of /dev/hocs_accelerator shared by the kernel module and user
+ * space (memory/hocs_dma_allocator.cpp). Include from C or C++.
+ *
+ * mmap() offsets select the region:
+ *   HOCS_MMAP_REGS_OFFSET  BAR0 register window (uncached). Read-only
+ *                          unless the caller has CAP_SYS_RAWIO; jobs go
+ *                          through HOCS_IOC_SUBMIT, which validates them
+ *   HOCS_MMAP_DMA_OFFSET   coherent DMA buffer owned by the driver; its bus
+ *                          address and size are in sysfs (see below)
+ */
+
+#ifndef HOCS_UAPI_H
+#define HOCS_UAPI_H
+
+#include <linux/ioctl.h>
+#include <linux/types.h>
+
+#define HOCS_DEVICE_PATH "/dev/hocs_accelerator"
+#define HOCS_SYSFS_DIR   "/sys/class/hocs_fpga/hocs_accelerator"
+
+/* sysfs attributes of the device (hex bus address, decimal bytes) */
+#define HOCS_SYSFS_DMA_PHYS_ADDR HOCS_SYSFS_DIR "/dma_phys_addr"
+#define HOCS_SYSFS_DMA_SIZE      HOCS_SYSFS_DIR "/dma_size"
+
+/* mmap() offsets, page aligned and far enough apart for any BAR0 size */
+#define HOCS_MMAP_REGS_OFFSET 0x00000000UL
+#define HOCS_MMAP_DMA_OFFSET  0x10000000UL
+
+/* BAR0 register map (docs/INTERFACE_SPEC.md, section 3) */
+#define HOCS_REG_CONTROL 0x00
+#define HOCS_REG_STATUS  0x04
+#define HOCS_REG_IRQ_ACK 0x08
+#define HOCS_REG_VERSION 0x0C
+#define HOCS_REG_TEMP    0x10
+
+/* Job registers, programmed by the driver for each ring descriptor */
+#define HOCS_REG_JOB_SRC_LO     0x20
+#define HOCS_REG_JOB_SRC_HI     0x24
+#define HOCS_REG_JOB_DST_LO     0x28
+#define HOCS_REG_JOB_DST_HI     0x2C
+#define HOCS_REG_JOB_LENGTH     0x30
+#define HOCS_REG_JOB_RESULT_LEN 0x34
+#define HOCS_REG_JOB_OPCODE     0x38
+#define HOCS_REG_JOB_TILE_ID    0x3C
+
+#define HOCS_CONTROL_START      (1u << 0)
+#define HOCS_CONTROL_ABORT      (1u << 1)
+#define HOCS_CONTROL_SOFT_RESET (1u << 2)
+
+#define HOCS_STATUS_IDLE       (1u << 0)
+#define HOCS_STATUS_BUSY       (1u << 1)
+#define HOCS_STATUS_DATA_READY (1u << 2)
+
+/*
+ * read() of sizeof(struct hocs_completion) blocks until a tile completed
+ * or the watchdog fired since this file's previous read (O_NONBLOCK:
+ * -EAGAIN); poll() reports POLLIN in the same case. A 4-byte read still
+ * returns the raw STATUS register.
+ */
+#define HOCS_COMPLETION_WATCHDOG (1u << 0) /* Watchdog reset since the last read */
+
+struct hocs_completion {
+    __u64 completed;       /* Tiles completed since the module was loaded */
+    __u64 watchdog_resets; /* Soft resets issued by the 100 ms watchdog */
+    __u32 status;          /* STATUS register at the time of the read */
+    __u32 flags;           /* HOCS_COMPLETION_* */
+};
+
+/*
+ * Batched submission. HOCS_IOC_SUBMIT copies an array of descriptors into
+ * the kernel's descriptor ring in one call; the driver starts them back to
+ * back from the completion IRQ. HOCS_IOC_REAP drains the matching
+ * completion ring (wait for it with poll()/read() above). The rings are
+ * per device: one runtime process should own submission.
+ */
+#define HOCS_RING_ENTRIES 1024 /* Descriptors submitted but not yet reaped */
+
+#define HOCS_OPCODE_WRITE  0x1 /* ICD job packet OPCODE */
+#define HOCS_OPCODE_READ   0x2
+#define HOCS_OPCODE_CONFIG 0x3
+
+struct hocs_job_desc {
+    __u64 src_addr;      /* Bus address of the job packet in the DMA buffer */
+    __u64 dst_addr;      /* Bus address the results are written to */
+    __u32 length;        /* Packet bytes at src_addr (> 0) */
+    __u32 result_length; /* Result bytes at dst_addr (0 = none) */
+    __u32 opcode;        /* HOCS_OPCODE_* */
+    __u32 tile_id;       /* ICD TILE_ID, echoed in the completion */
+};
+
+#define HOCS_JOB_OK      0
+#define HOCS_JOB_TIMEOUT 1 /* Watchdog reset while the job was running */
+
+struct hocs_job_completion {
+    __u32 tile_id;
+    __u32 status;        /* HOCS_JOB_* */
+};
+
+struct hocs_submit_args {
+    __u64 descs;         /* User pointer to struct hocs_job_desc[count] */
+    __u32 count;
+    __u32 accepted;      /* Out: leading descriptors queued (ring space) */
+};
+
+struct hocs_reap_args {
+    __u64 entries;       /* User pointer to struct hocs_job_completion[max] */
+    __u32 max;
+    __u32 count;         /* Out: completions copied, oldest first */
+};
+
+#define HOCS_IOC_MAGIC  'H'
+#define HOCS_IOC_SUBMIT _IOWR(HOCS_IOC_MAGIC, 1, struct hocs_submit_args)
+#define HOCS_IOC_REAP   _IOWR(HOCS_IOC_MAGIC, 2, struct hocs_reap_args)
+
+#endif /* HOCS_UAPI_H */
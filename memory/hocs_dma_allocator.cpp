@@ -5,65 +5,457 @@
  * Author: Muhammed Yusuf Cobanoglu
  * Target: ARM64 / Xilinx MPSoC
  * Description: 
- * Implements a custom Ring Buffer allocator for high-speed PCIe/AXI transfers.
- * Bypasses Linux Kernel overhead using mmap() and HugePages.
- * Uses atomic operations for lock-free concurrency.
+ * Implements a custom slab allocator for high-speed PCIe/AXI transfers.
+ * Bypasses Linux Kernel overhead using mmap() and HugePages (1 GB / 2 MB / THP),
+ * optionally bound to one NUMA node (HOCSNumaPoolSet keeps one pool per node).
+ * Power-of-two size classes with lock-free free lists and per-thread caches;
+ * buffers are released individually in O(1), and slabs whose blocks are all
+ * free return to a shared free-slab list that any size class carves from.
+ * HOCSDmaRing streams job packets through a bounded producer/consumer ring
+ * whose slots are recycled when the hardware reports completion.
+ * HOCSTilePipeline keeps N buffer sets in flight across upload, optical
+ * compute and drain, so DMA overhead hides behind the core. It is a
+ * simulation harness for now: the only transport is HOCSLoopbackTransport,
+ * production jobs go through the driver's HOCS_IOC_SUBMIT / HOCS_IOC_REAP.
  */
 
 #include <iostream>
 #include <vector>
+#include <algorithm>
 #include <atomic>
+#include <chrono>
+#include <deque>
+#include <functional>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
 #include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
 #include <sys/mman.h>
+#include <sys/syscall.h>
 #include <fcntl.h>
 #include <unistd.h>
 #include <stdexcept>
 
+#include "../cpp_core/hocs_packet.hpp"
+#include "../cpp_core/hocs_telemetry.hpp"
+#include "../cpp_core/hocs_tiler.hpp"
+#include "../kernel_driver/hocs_uapi.h"
+
 // Page Size alignment for ARM64 Architecture (4KB standard, 2MB HugePage)
 #define PAGE_SIZE 4096
 #define HUGE_PAGE_SIZE (2 * 1024 * 1024)
+#define GIANT_PAGE_SIZE (1024UL * 1024 * 1024)
 #define ALIGN_UP(x, align) (((x) + (align) - 1) & ~((align) - 1))
 
+// Size classes are powers of two from one cache line up. Classes below the
+// slab size are carved out of 1 MB slabs, larger ones take a run of slabs.
+#define SLAB_SIZE (1024 * 1024)
+#define MIN_BLOCK_SHIFT 6          // 64 B, cache line alignment
+#define NUM_SIZE_CLASSES 26        // 64 B ... 2 GB
+#define THREAD_CACHE_CLASSES 13    // 64 B ... 256 KB are cached per thread
+#define THREAD_CACHE_DEPTH 32      // Blocks per class and thread
+#define MAX_THREAD_CACHES 64
+#define SLAB_UNOWNED 0xFF          // slab_class entry of free / continuation slabs
+
+#define HOCS_BLOCK_MAGIC 0x40C52026   // "HOCS" 2026
+#define PAGEMAP_PRESENT (1ULL << 63)  // /proc/self/pagemap entry layout
+#define PAGEMAP_PFN_MASK ((1ULL << 55) - 1)
+
+// mmap() hugetlb size selectors and mbind() policy (no libnuma dependency)
+#ifndef MAP_HUGE_SHIFT
+#define MAP_HUGE_SHIFT 26
+#endif
+#ifndef MAP_HUGE_2MB
+#define MAP_HUGE_2MB (21 << MAP_HUGE_SHIFT)
+#endif
+#ifndef MAP_HUGE_1GB
+#define MAP_HUGE_1GB (30 << MAP_HUGE_SHIFT)
+#endif
+#define HOCS_MPOL_BIND 2
+#define HOCS_MAX_NUMA_NODES 1024
+
+// Process-wide thread slots, one bit each. A slot indexes the per-thread
+// cache array of every memory manager and is released at thread exit.
+class HOCSThreadSlot {
+private:
+    int id;
+
+    static std::atomic<uint64_t>& slot_bitmap() {
+        static std::atomic<uint64_t> bitmap(0);
+        return bitmap;
+    }
+
+    HOCSThreadSlot() : id(-1) {
+        uint64_t used = slot_bitmap().load(std::memory_order_relaxed);
+        while (~used != 0) {
+            int bit = __builtin_ctzll(~used);
+            if (slot_bitmap().compare_exchange_weak(used, used | (1ULL << bit), std::memory_order_acq_rel)) {
+                id = bit;
+                break;
+            }
+        }
+    }
+
+    ~HOCSThreadSlot() {
+        if (id >= 0) slot_bitmap().fetch_and(~(1ULL << id), std::memory_order_release);
+    }
+
+public:
+    // -1 when more than MAX_THREAD_CACHES threads are alive (no cache)
+    static int current() {
+        thread_local HOCSThreadSlot slot;
+        return slot.id;
+    }
+};
+
 struct DMA_Block_Header {
     uint64_t physical_addr; // Actual Hardware Address
     uint64_t virtual_addr;  // User Space Address
     size_t size;
     bool is_free;
-    uint32_t magic_signature; // 0xHOCS2026
+    uint32_t magic_signature; // HOCS_BLOCK_MAGIC
+};
+
+// One scatter-gather element: a physically contiguous run of a buffer
+struct DMA_SG_Entry {
+    uint64_t physical_addr;
+    uint32_t length;
 };
 
 class HOCSMremoryManager {
 private:
-    int mem_fd;
+    int mem_fd = -1;
     void* base_pointer;
     size_t total_capacity;
-    std::atomic<size_t> current_offset;
+    std::atomic<size_t> current_offset; // Slab bump pointer, touched once per slab
+    size_t tlb_page_size = PAGE_SIZE; // Effective page size backing the pool
+    int bound_node = -1;              // NUMA node the pool is bound to (-1 = any)
+
+    // Out-of-band metadata, never interleaved with payload data:
+    // block_table holds one header per slab (written when the slab is carved),
+    // page_frames the physical address of every mapped page, resolved once
+    // at startup so descriptors are built without a syscall per transfer.
     std::vector<DMA_Block_Header> block_table;
+    std::vector<uint64_t> page_frames; // 0 = unknown
+    size_t map_page_size = PAGE_SIZE;
+    bool frames_resolved = false;
+
+    // Treiber stack per size class. Head = ABA tag (upper 32 bits) and the
+    // 1-based index of the top block in 64 B units; 0 = empty. The link to the
+    // next block is stored in the first 8 bytes of each free block.
+    std::atomic<uint64_t> free_heads[NUM_SIZE_CLASSES];
+    size_t slab_count;
+    std::unique_ptr<std::atomic<uint8_t>[]> slab_class; // Size class owning each slab
+
+    // Slab reclaim. slab_live counts the blocks of a slab held by callers;
+    // when one drops to zero the next exhaustion runs reclaim_slabs(), which
+    // returns every slab whose blocks are all back on its class free list
+    // to free_slabs. Any class carves from there before the bump pointer.
+    std::unique_ptr<std::atomic<uint32_t>[]> slab_live;
+    std::atomic<bool> reclaim_hint;
+    std::mutex slab_lock;                // free_slabs and reclaim passes
+    std::vector<uint8_t> free_slabs;     // 1 = reclaimed slab below current_offset
+    std::atomic<size_t> free_slab_count;
+    std::vector<uint32_t> reclaim_counts; // Reclaim scratch: free blocks seen per slab
+
+    // Only the thread holding the slot touches a cache. fast_reset() bumps
+    // the epoch, which empties every cache on its next use.
+    struct alignas(64) ThreadCache {
+        uint32_t epoch = 0;
+        uint32_t count[THREAD_CACHE_CLASSES] = {};
+        uint32_t blocks[THREAD_CACHE_CLASSES][THREAD_CACHE_DEPTH];
+    };
+    std::vector<ThreadCache> thread_caches;
+    std::atomic<uint32_t> cache_epoch;
+
+    static int size_class(size_t size) {
+        int cls = 0;
+        while (cls < NUM_SIZE_CLASSES && (size_t(1) << (cls + MIN_BLOCK_SHIFT)) < size) ++cls;
+        return cls;
+    }
+
+    static size_t class_bytes(int cls) { return size_t(1) << (cls + MIN_BLOCK_SHIFT); }
+
+    void* block_address(uint32_t index) const {
+        return (void*)((uintptr_t)base_pointer + ((size_t)index << MIN_BLOCK_SHIFT));
+    }
+
+    uint64_t* block_link(uint32_t index) const { return (uint64_t*)block_address(index); }
+
+    // Pushes the pre-linked chain first -> ... -> last with a single CAS
+    void push_chain(int cls, uint32_t first, uint32_t last) {
+        uint64_t head = free_heads[cls].load(std::memory_order_relaxed);
+        uint64_t desired;
+        do {
+            __atomic_store_n(block_link(last), head & 0xFFFFFFFFULL, __ATOMIC_RELAXED);
+            desired = (((head >> 32) + 1) << 32) | (uint64_t(first) + 1);
+        } while (!free_heads[cls].compare_exchange_weak(head, desired, std::memory_order_release,
+                                                        std::memory_order_relaxed));
+    }
+
+    bool pop_block(int cls, uint32_t& index) {
+        uint64_t head = free_heads[cls].load(std::memory_order_acquire);
+        while ((head & 0xFFFFFFFFULL) != 0) {
+            uint32_t top = uint32_t(head & 0xFFFFFFFFULL) - 1;
+            // A stale read is harmless: the tag makes the CAS fail
+            uint64_t next = __atomic_load_n(block_link(top), __ATOMIC_RELAXED);
+            uint64_t desired = (((head >> 32) + 1) << 32) | (next & 0xFFFFFFFFULL);
+            if (free_heads[cls].compare_exchange_weak(head, desired, std::memory_order_acq_rel,
+                                                      std::memory_order_acquire)) {
+                index = top;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Links blocks[0..n) into a chain and publishes it on the global list
+    void release_blocks(int cls, const uint32_t* blocks, uint32_t n) {
+        if (n == 0) return;
+        for (uint32_t i = 0; i + 1 < n; ++i) {
+            __atomic_store_n(block_link(blocks[i]), uint64_t(blocks[i + 1]) + 1, __ATOMIC_RELAXED);
+        }
+        push_chain(cls, blocks[0], blocks[n - 1]);
+    }
+
+    // Reserves fresh slabs from the bump pointer without overshooting the pool
+    bool reserve_slabs(size_t bytes, size_t& offset) {
+        size_t limit = slab_count * SLAB_SIZE;
+        size_t old_offset = current_offset.load(std::memory_order_relaxed);
+        do {
+            if (old_offset + bytes > limit) return false;
+        } while (!current_offset.compare_exchange_weak(old_offset, old_offset + bytes, std::memory_order_relaxed));
+        offset = old_offset;
+        return true;
+    }
+
+    // First fit of `run` consecutive reclaimed slabs
+    bool take_free_slabs(size_t run, size_t& offset) {
+        if (free_slab_count.load(std::memory_order_acquire) < run) return false;
+        std::lock_guard<std::mutex> guard(slab_lock);
+        size_t start = 0, length = 0;
+        for (size_t slab = 0; slab < free_slabs.size(); ++slab) {
+            if (!free_slabs[slab]) {
+                length = 0;
+                continue;
+            }
+            if (length++ == 0) start = slab;
+            if (length == run) {
+                std::fill_n(free_slabs.begin() + start, run, 0);
+                free_slab_count.fetch_sub(run, std::memory_order_relaxed);
+                offset = start * SLAB_SIZE;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Takes the whole free chain of cls with one CAS; the tag bump makes
+    // every concurrent pop of the old head fail. Returns the top block.
+    bool detach_chain(int cls, uint32_t& top) {
+        uint64_t head = free_heads[cls].load(std::memory_order_acquire);
+        uint64_t desired;
+        do {
+            if ((head & 0xFFFFFFFFULL) == 0) return false;
+            desired = ((head >> 32) + 1) << 32;
+        } while (!free_heads[cls].compare_exchange_weak(head, desired, std::memory_order_acq_rel,
+                                                        std::memory_order_acquire));
+        top = uint32_t(head & 0xFFFFFFFFULL) - 1;
+        return true;
+    }
+
+    // Exhaustion slow path. The detached chains are private to this pass:
+    // a slab is free when all of its blocks are on its chain, the other
+    // blocks are published again. Blocks in other threads' caches keep
+    // their slab bound until the cache spills them.
+    bool reclaim_slabs() {
+        for (int cls = 0; cls < THREAD_CACHE_CLASSES; ++cls) {
+            ThreadCache* cache = local_cache(cls);
+            if (!cache) break;
+            release_blocks(cls, cache->blocks[cls], cache->count[cls]);
+            cache->count[cls] = 0;
+        }
+
+        std::lock_guard<std::mutex> guard(slab_lock);
+        size_t reclaimed = 0;
+        std::vector<uint32_t> chain, keep;
+        for (int cls = 0; cls < NUM_SIZE_CLASSES; ++cls) {
+            uint32_t top;
+            if (!detach_chain(cls, top)) continue;
+
+            const size_t block = class_bytes(cls);
+            const uint32_t per_slab = block < SLAB_SIZE ? uint32_t(SLAB_SIZE / block) : 1;
+            const size_t run = block < SLAB_SIZE ? 1 : block / SLAB_SIZE;
+            chain.clear();
+            keep.clear();
+            for (uint64_t link = uint64_t(top) + 1; link != 0;
+                 link = __atomic_load_n(block_link(uint32_t(link - 1)), __ATOMIC_RELAXED) & 0xFFFFFFFFULL) {
+                chain.push_back(uint32_t(link - 1));
+                ++reclaim_counts[((size_t)(link - 1) << MIN_BLOCK_SHIFT) / SLAB_SIZE];
+            }
+
+            for (uint32_t b : chain) {
+                size_t slab = ((size_t)b << MIN_BLOCK_SHIFT) / SLAB_SIZE;
+                if (reclaim_counts[slab] > per_slab) continue; // Slab already released
+                if (reclaim_counts[slab] < per_slab) {
+                    keep.push_back(b);
+                    continue;
+                }
+                reclaim_counts[slab] = per_slab + 1;
+                slab_class[slab].store(SLAB_UNOWNED, std::memory_order_release);
+                block_table[slab].is_free = true;
+                std::fill_n(free_slabs.begin() + slab, run, 1);
+                free_slab_count.fetch_add(run, std::memory_order_release);
+                reclaimed += run;
+            }
+            for (uint32_t b : chain) reclaim_counts[((size_t)b << MIN_BLOCK_SHIFT) / SLAB_SIZE] = 0;
+            release_blocks(cls, keep.data(), (uint32_t)keep.size());
+        }
+        return reclaimed > 0;
+    }
+
+    // Reclaimed slabs first, then the bump pointer, then one reclaim pass
+    // if a slab went idle since the last one
+    bool acquire_slabs(size_t bytes, size_t& offset) {
+        const size_t run = bytes / SLAB_SIZE;
+        if (take_free_slabs(run, offset) || reserve_slabs(bytes, offset)) return true;
+        return reclaim_hint.exchange(false) && reclaim_slabs() && take_free_slabs(run, offset);
+    }
+
+    // Carves a new slab (or slab run) for cls and returns its first block.
+    // The remaining blocks fill the caller's cache, the rest go to the free list.
+    bool carve_slab(int cls, ThreadCache* cache, uint32_t& index) {
+        size_t block = class_bytes(cls);
+        size_t bytes = block > SLAB_SIZE ? block : SLAB_SIZE;
+        size_t offset;
+        if (!acquire_slabs(bytes, offset)) return false;
+
+        DMA_Block_Header& header = block_table[offset / SLAB_SIZE];
+        header.virtual_addr = (uintptr_t)base_pointer + offset;
+        header.physical_addr = physical_address((void*)header.virtual_addr);
+        header.size = block;
+        header.is_free = false;
+        header.magic_signature = HOCS_BLOCK_MAGIC;
+        slab_class[offset / SLAB_SIZE].store((uint8_t)cls, std::memory_order_release);
+
+        index = uint32_t(offset >> MIN_BLOCK_SHIFT);
+        uint32_t stride = uint32_t(block >> MIN_BLOCK_SHIFT);
+        uint32_t blocks = uint32_t(bytes / block);
+        uint32_t next = 1;
+
+        if (cache) {
+            while (next < blocks && cache->count[cls] < THREAD_CACHE_DEPTH) {
+                cache->blocks[cls][cache->count[cls]++] = index + next * stride;
+                ++next;
+            }
+        }
+        if (next < blocks) {
+            for (uint32_t i = next; i + 1 < blocks; ++i) {
+                __atomic_store_n(block_link(index + i * stride), uint64_t(index + (i + 1) * stride) + 1, __ATOMIC_RELAXED);
+            }
+            push_chain(cls, index + next * stride, index + (blocks - 1) * stride);
+        }
+        return true;
+    }
+
+    // Cache of the calling thread for cls, or nullptr if cls is not cached
+    ThreadCache* local_cache(int cls) {
+        if (cls >= THREAD_CACHE_CLASSES) return nullptr;
+        int slot = HOCSThreadSlot::current();
+        if (slot < 0) return nullptr;
+
+        ThreadCache* cache = &thread_caches[slot];
+        uint32_t epoch = cache_epoch.load(std::memory_order_acquire);
+        if (cache->epoch != epoch) {
+            std::memset(cache->count, 0, sizeof(cache->count));
+            cache->epoch = epoch;
+        }
+        return cache;
+    }
+
+    bool take_block(int cls, uint32_t& index) {
+        ThreadCache* cache = local_cache(cls);
+        if (!cache) return pop_block(cls, index) || carve_slab(cls, nullptr, index);
+
+        if (cache->count[cls] == 0) {
+            // Refill half a cache from the global list in one pass
+            uint32_t block;
+            while (cache->count[cls] < THREAD_CACHE_DEPTH / 2 && pop_block(cls, block)) {
+                cache->blocks[cls][cache->count[cls]++] = block;
+            }
+            if (cache->count[cls] == 0) return carve_slab(cls, cache, index);
+        }
+        index = cache->blocks[cls][--cache->count[cls]];
+        return true;
+    }
 
 public:
-    HOCSMremoryManager(size_t pool_size_mb) {
+    // numa_node >= 0 binds the pool to that node before it is faulted in
+    HOCSMremoryManager(size_t pool_size_mb, int numa_node = -1) {
         total_capacity = pool_size_mb * 1024 * 1024;
         current_offset.store(0);
+        slab_count = total_capacity / SLAB_SIZE;
+        slab_class.reset(new std::atomic<uint8_t>[slab_count]);
+        for (size_t i = 0; i < slab_count; ++i) slab_class[i].store(SLAB_UNOWNED);
+        slab_live.reset(new std::atomic<uint32_t>[slab_count]);
+        for (size_t i = 0; i < slab_count; ++i) slab_live[i].store(0);
+        reclaim_hint.store(false);
+        free_slabs.assign(slab_count, 0);
+        free_slab_count.store(0);
+        reclaim_counts.assign(slab_count, 0);
+        for (auto& head : free_heads) head.store(0);
+        thread_caches.resize(MAX_THREAD_CACHES);
+        cache_epoch.store(0);
+
+        block_table.assign(slab_count, DMA_Block_Header{0, 0, 0, true, HOCS_BLOCK_MAGIC});
+
+        // A u-dma-buf CMA region (HOCS_UDMABUF=udmabuf0) is physically
+        // contiguous and reports its bus address through sysfs
+        const char* udmabuf = std::getenv("HOCS_UDMABUF");
+        if (udmabuf && map_udmabuf(udmabuf)) {
+            std::cout << "[MEM] HOCS Memory Pool Initialized. Base: " << base_pointer
+                      << " | Size: " << pool_size_mb << " MB | CMA: " << udmabuf << std::endl;
+            return;
+        }
 
-        // Open /dev/mem to access physical RAM (Root privileges required)
-        mem_fd = open("/dev/mem", O_RDWR | O_SYNC);
-        if (mem_fd < 0) {
-            // Fallback for simulation if root is not present
-            std::cerr << "[WARN] Failed to open /dev/mem. Switching to Standard Heap." << std::endl;
-            base_pointer = aligned_alloc(PAGE_SIZE, total_capacity);
-        } else {
-            // Map physical memory to user space
-            // Note: In a real driver, we would map a reserved CMA region here.
-            base_pointer = mmap(NULL, total_capacity, PROT_READ | PROT_WRITE, 
-                                MAP_SHARED | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
-            
-            if (base_pointer == MAP_FAILED) {
-                throw std::runtime_error("CRITICAL: mmap() failed. HugePages not configured?");
+        // With the hocs_pci module loaded, allocate from its coherent DMA buffer
+        if (map_device_buffer()) {
+            std::cout << "[MEM] HOCS Memory Pool Initialized. Base: " << base_pointer
+                      << " | Size: " << pool_size_mb << " MB | Device: " << HOCS_DEVICE_PATH << std::endl;
+            return;
+        }
+
+        // Largest pages first: 1 GB and 2 MB hugetlbfs, then transparent huge
+        // pages, then plain 4 KB pages as the last resort
+        if (!map_hugetlb(GIANT_PAGE_SIZE, MAP_HUGE_1GB) &&
+            !map_hugetlb(HUGE_PAGE_SIZE, MAP_HUGE_2MB) &&
+            !map_anonymous()) {
+            throw std::runtime_error("CRITICAL: mmap() failed for the DMA pool.");
+        }
+
+        // Bind before the first touch, so every page is allocated on the node
+        if (numa_node >= 0) {
+            if (bind_to_node(numa_node)) {
+                bound_node = numa_node;
+            } else {
+                std::cerr << "[WARN] mbind() to NUMA node " << numa_node << " failed." << std::endl;
             }
         }
+        resolve_page_frames();
+        if (map_page_size == PAGE_SIZE && tlb_page_size == HUGE_PAGE_SIZE && !thp_backed()) {
+            tlb_page_size = PAGE_SIZE; // The hint was not honoured
+        }
+        if (tlb_page_size == PAGE_SIZE) {
+            std::cerr << "[WARN] No HugePages available, DMA pool uses 4 KB pages (TLB pressure)." << std::endl;
+        }
         
         std::cout << "[MEM] HOCS Memory Pool Initialized. Base: " << base_pointer 
-                  << " | Size: " << pool_size_mb << " MB" << std::endl;
+                  << " | Size: " << pool_size_mb << " MB"
+                  << " | Page: " << (tlb_page_size >> 10) << " KB"
+                  << " | Node: " << bound_node << std::endl;
     }
 
     ~HOCSMremoryManager() {
@@ -75,35 +467,346 @@ public:
         }
     }
 
+private:
+    bool map_hugetlb(size_t page_bytes, int size_flag) {
+        if (total_capacity % page_bytes != 0) return false;
+        void* ptr = mmap(NULL, total_capacity, PROT_READ | PROT_WRITE,
+                         MAP_SHARED | MAP_ANONYMOUS | MAP_HUGETLB | size_flag, -1, 0);
+        if (ptr == MAP_FAILED) return false;
+
+        base_pointer = ptr;
+        map_page_size = page_bytes;
+        tlb_page_size = page_bytes;
+        return true;
+    }
+
+    // 2 MB aligned anonymous mapping with a MADV_HUGEPAGE hint. The kernel
+    // may still back it with 4 KB pages (THP disabled, fragmentation),
+    // so thp_backed() checks the result after the first touch.
+    bool map_anonymous() {
+        size_t span = total_capacity + HUGE_PAGE_SIZE;
+        void* raw = mmap(NULL, span, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (raw == MAP_FAILED) return false;
+
+        uintptr_t start = ALIGN_UP((uintptr_t)raw, (uintptr_t)HUGE_PAGE_SIZE);
+        size_t head = start - (uintptr_t)raw;
+        if (head) munmap(raw, head);
+        if (span - head > total_capacity) munmap((void*)(start + total_capacity), span - head - total_capacity);
+
+        base_pointer = (void*)start;
+        map_page_size = PAGE_SIZE;
+        tlb_page_size = PAGE_SIZE;
+        if (madvise(base_pointer, total_capacity, MADV_HUGEPAGE) == 0 && transparent_hugepages_enabled()) {
+            tlb_page_size = HUGE_PAGE_SIZE;
+        }
+        return true;
+    }
+
+    static bool transparent_hugepages_enabled() {
+        FILE* f = fopen("/sys/kernel/mm/transparent_hugepage/enabled", "r");
+        if (!f) return false;
+        char mode[128] = {0};
+        bool enabled = fgets(mode, sizeof(mode), f) && !strstr(mode, "[never]");
+        fclose(f);
+        return enabled;
+    }
+
+    // AnonHugePages of the VMA holding the pool covers all of it. Read
+    // after resolve_page_frames() touched every page.
+    bool thp_backed() const {
+        FILE* f = fopen("/proc/self/smaps", "r");
+        if (!f) return false;
+        const uintptr_t base = (uintptr_t)base_pointer;
+        char line[256];
+        bool in_pool = false;
+        unsigned long long huge_kb = 0;
+        bool found = false;
+        while (!found && fgets(line, sizeof(line), f)) {
+            unsigned long long start, end;
+            if (sscanf(line, "%llx-%llx ", &start, &end) == 2) { // VMA header line
+                in_pool = start <= base && base < end;
+            } else if (in_pool && sscanf(line, "AnonHugePages: %llu kB", &huge_kb) == 1) {
+                found = true;
+            }
+        }
+        fclose(f);
+        return found && huge_kb * 1024 >= total_capacity;
+    }
+
+    bool bind_to_node(int node) {
+        const size_t bits_per_word = 8 * sizeof(unsigned long);
+        if (node >= HOCS_MAX_NUMA_NODES) return false;
+        unsigned long mask[HOCS_MAX_NUMA_NODES / (8 * sizeof(unsigned long))] = {0};
+        mask[node / bits_per_word] |= 1UL << (node % bits_per_word);
+        return syscall(SYS_mbind, base_pointer, total_capacity, HOCS_MPOL_BIND,
+                       mask, (unsigned long)HOCS_MAX_NUMA_NODES + 1, 0) == 0;
+    }
+
+    bool map_udmabuf(const char* name) {
+        std::string sysfs = std::string("/sys/class/u-dma-buf/") + name + "/phys_addr";
+        FILE* f = fopen(sysfs.c_str(), "r");
+        if (!f) return false;
+        unsigned long long phys_base = 0;
+        int parsed = fscanf(f, "%llx", &phys_base);
+        fclose(f);
+        if (parsed != 1) return false;
+
+        mem_fd = open((std::string("/dev/") + name).c_str(), O_RDWR | O_SYNC);
+        if (mem_fd < 0) return false;
+        base_pointer = mmap(NULL, total_capacity, PROT_READ | PROT_WRITE, MAP_SHARED, mem_fd, 0);
+        if (base_pointer == MAP_FAILED) {
+            close(mem_fd);
+            mem_fd = -1;
+            base_pointer = nullptr;
+            return false;
+        }
+
+        page_frames.resize(total_capacity / map_page_size);
+        for (size_t page = 0; page < page_frames.size(); ++page) {
+            page_frames[page] = phys_base + page * map_page_size;
+        }
+        frames_resolved = true;
+        return true;
+    }
+
+    // The driver's coherent buffer (hocs_uapi.h) is physically contiguous;
+    // its bus address is published in sysfs next to the device
+    bool map_device_buffer() {
+        unsigned long long phys_base = 0, device_bytes = 0;
+        FILE* f = fopen(HOCS_SYSFS_DMA_PHYS_ADDR, "r");
+        if (!f) return false;
+        int parsed = fscanf(f, "%llx", &phys_base);
+        fclose(f);
+        f = fopen(HOCS_SYSFS_DMA_SIZE, "r");
+        if (!f) return false;
+        parsed += fscanf(f, "%llu", &device_bytes);
+        fclose(f);
+        if (parsed != 2) return false;
+        if (device_bytes < total_capacity) {
+            std::cerr << "[WARN] " << HOCS_DEVICE_PATH << " DMA buffer holds " << (device_bytes >> 20)
+                      << " MB, pool needs " << (total_capacity >> 20) << " MB (raise dma_buffer_mb)." << std::endl;
+            return false;
+        }
+
+        mem_fd = open(HOCS_DEVICE_PATH, O_RDWR);
+        if (mem_fd < 0) return false;
+        base_pointer = mmap(NULL, total_capacity, PROT_READ | PROT_WRITE, MAP_SHARED, mem_fd,
+                            (off_t)HOCS_MMAP_DMA_OFFSET);
+        if (base_pointer == MAP_FAILED) {
+            close(mem_fd);
+            mem_fd = -1;
+            base_pointer = nullptr;
+            return false;
+        }
+
+        page_frames.resize(total_capacity / map_page_size);
+        for (size_t page = 0; page < page_frames.size(); ++page) {
+            page_frames[page] = phys_base + page * map_page_size;
+        }
+        frames_resolved = true;
+        return true;
+    }
+
+    // Pins and faults in the pool, then reads the frame of every page with a
+    // single pread() of /proc/self/pagemap. PFNs read as 0 without
+    // CAP_SYS_ADMIN; physical_address() then returns 0 (simulation only).
+    void resolve_page_frames() {
+        page_frames.assign(total_capacity / map_page_size, 0);
+        frames_resolved = false;
+
+        // A frame handed to the FPGA must never be migrated or swapped out
+        if (mlock(base_pointer, total_capacity) != 0) {
+            std::cerr << "[WARN] mlock() failed, DMA pages may move." << std::endl;
+        }
+        for (size_t page = 0; page < page_frames.size(); ++page) {
+            ((volatile uint8_t*)base_pointer)[page * map_page_size] = 0;
+        }
+
+        int fd = open("/proc/self/pagemap", O_RDONLY);
+        if (fd < 0) return;
+        size_t entries = total_capacity / PAGE_SIZE;
+        std::vector<uint64_t> pagemap(entries);
+        off_t first = (off_t)((uintptr_t)base_pointer / PAGE_SIZE) * sizeof(uint64_t);
+        ssize_t got = pread(fd, pagemap.data(), entries * sizeof(uint64_t), first);
+        close(fd);
+        if (got != (ssize_t)(entries * sizeof(uint64_t))) return;
+
+        size_t resolved = 0;
+        size_t step = map_page_size / PAGE_SIZE;
+        for (size_t page = 0; page < page_frames.size(); ++page) {
+            uint64_t entry = pagemap[page * step];
+            uint64_t pfn = entry & PAGEMAP_PFN_MASK;
+            if ((entry & PAGEMAP_PRESENT) && pfn != 0) {
+                page_frames[page] = pfn * PAGE_SIZE;
+                ++resolved;
+            }
+        }
+        frames_resolved = (resolved == page_frames.size());
+        if (!frames_resolved) {
+            std::cerr << "[WARN] Physical addresses unavailable (pagemap PFNs need CAP_SYS_ADMIN)." << std::endl;
+        }
+    }
+
+public:
+    // Page size actually backing the pool (TLB reach)
+    size_t page_size() const { return tlb_page_size; }
+    int numa_node() const { return bound_node; }
+
+    bool owns(const void* ptr) const {
+        return (uintptr_t)ptr >= (uintptr_t)base_pointer &&
+               (uintptr_t)ptr < (uintptr_t)base_pointer + total_capacity;
+    }
+
+    // True once every pool page has a known physical frame
+    bool has_physical_addresses() const { return frames_resolved; }
+
+    // Table lookup, no syscall. 0 if the frame is unknown or ptr is foreign.
+    uint64_t physical_address(const void* ptr) const {
+        uintptr_t offset = (uintptr_t)ptr - (uintptr_t)base_pointer;
+        if ((uintptr_t)ptr < (uintptr_t)base_pointer || offset >= total_capacity) return 0;
+        uint64_t frame = page_frames[offset / map_page_size];
+        return frame ? frame + offset % map_page_size : 0;
+    }
+
+    // Header of the block at ptr, assembled from the side tables
+    DMA_Block_Header describe_buffer(const void* ptr) const {
+        DMA_Block_Header header{0, (uint64_t)(uintptr_t)ptr, 0, true, HOCS_BLOCK_MAGIC};
+        uintptr_t offset = (uintptr_t)ptr - (uintptr_t)base_pointer;
+        if ((uintptr_t)ptr < (uintptr_t)base_pointer || offset >= slab_count * SLAB_SIZE) return header;
+
+        const DMA_Block_Header& slab = block_table[offset / SLAB_SIZE];
+        header.physical_addr = physical_address(ptr);
+        header.size = slab.size;
+        header.is_free = slab.is_free; // Slab granularity: blocks are not tracked one by one
+        return header;
+    }
+
+    // Splits [ptr, ptr + len) into physically contiguous runs for the DMA
+    // descriptor ring. Returns the entries needed (may exceed max_entries);
+    // 0 if a page of the range has no known frame.
+    size_t build_sg_list(const void* ptr, size_t len, DMA_SG_Entry* out, size_t max_entries) const {
+        size_t count = 0;
+        uintptr_t cursor = (uintptr_t)ptr;
+        uintptr_t end = cursor + len;
+        // The run being extended lives here, not in out[], so runs past
+        // max_entries still merge and the returned count stays exact
+        uint64_t run_phys = 0;
+        uint64_t run_len = 0;
+
+        while (cursor < end) {
+            uint64_t phys = physical_address((const void*)cursor);
+            if (phys == 0) return 0;
+            size_t chunk = map_page_size - (cursor - (uintptr_t)base_pointer) % map_page_size;
+            if (chunk > end - cursor) chunk = end - cursor;
+
+            if (count > 0 && run_phys + run_len == phys && run_len + chunk <= UINT32_MAX) {
+                run_len += chunk;
+            } else {
+                ++count;
+                run_phys = phys;
+                run_len = chunk;
+            }
+            if (count <= max_entries) out[count - 1] = DMA_SG_Entry{run_phys, (uint32_t)run_len};
+            cursor += chunk;
+        }
+        return count;
+    }
+
     void* allocate_tensor_buffer(size_t size) {
-        // Custom aligned allocation logic
-        size_t aligned_size = ALIGN_UP(size, 64); // Cache line alignment
-        
-        size_t old_offset = current_offset.fetch_add(aligned_size);
-        
-        if (old_offset + aligned_size > total_capacity) {
-            std::cerr << "[ERR] OOM: DMA Ring Buffer Overflow!" << std::endl;
+        // Rounded up to a power-of-two size class (cache line aligned)
+        int cls = size_class(size);
+        uint32_t index;
+
+        if (cls >= NUM_SIZE_CLASSES || !take_block(cls, index)) {
+            std::cerr << "[ERR] OOM: DMA Pool Exhausted (" << size << " bytes)!" << std::endl;
             return nullptr;
         }
 
-        uintptr_t addr = (uintptr_t)base_pointer + old_offset;
-        
-        // Metadata tagging for debugging
-        DMA_Block_Header header;
-        header.virtual_addr = addr;
-        header.size = aligned_size;
-        header.is_free = false;
-        header.magic_signature = 0xHOCS2026;
-        
-        // In a real scenario, we would store this header in a separate look-up table
-        // to avoid fragmenting the high-speed data path.
-        
-        return (void*)addr;
+        // Metadata lives in block_table / page_frames, see describe_buffer()
+        slab_live[((size_t)index << MIN_BLOCK_SHIFT) / SLAB_SIZE].fetch_add(1, std::memory_order_relaxed);
+        return block_address(index);
+    }
+
+    // Stages a row-major M x K Float32 weight matrix as complete ICD job
+    // packets (header, Q4.12 payload, CRC32C; hocs_packet.hpp), one tensor
+    // buffer per TILE_ID in HOCSTilePlan order (the order the simulator
+    // executes them). Quantization, packing and the CRC are one pass over
+    // each tile. Returns an empty table if the pool is full.
+    // With an occupancy (pruned weights, hocs_block_csr) only its on tiles
+    // are staged: packet k is tile occupancy->tile_ids[k], its header carries
+    // that TILE_ID, and bands without packets read back as zero currents.
+    std::vector<void*> stage_weight_packets(const float* weights, const HOCSTilePlan& plan, uint32_t opcode,
+                                            const HOCSBlockCSR* occupancy = nullptr) {
+        const size_t count = occupancy ? occupancy->tile_count() : plan.tile_count();
+        std::vector<void*> packets;
+        packets.reserve(count);
+
+        for (size_t k = 0; k < count; ++k) {
+            const HOCSTile& tile = occupancy ? plan.tile(occupancy->tile_ids[k]) : plan.all_tiles()[k];
+            void* buffer = allocate_tensor_buffer(hocs_packet_bytes(plan.payload_bytes()));
+            if (!buffer) {
+                for (void* p : packets) free_tensor_buffer(p);
+                return {};
+            }
+            hocs_build_tile_packet(weights, plan.cols(), tile, plan.tile_size(), opcode, buffer);
+            packets.push_back(buffer);
+        }
+        return packets;
+    }
+
+    // O(1) release: the owning slab names the size class, the block goes to
+    // the calling thread's cache, or half the cache spills to the free list
+    void free_tensor_buffer(void* ptr) {
+        if (!ptr) return;
+
+        uintptr_t offset = (uintptr_t)ptr - (uintptr_t)base_pointer;
+        if ((uintptr_t)ptr < (uintptr_t)base_pointer || offset >= slab_count * SLAB_SIZE) {
+            std::cerr << "[ERR] free_tensor_buffer: " << ptr << " is not a pool buffer" << std::endl;
+            return;
+        }
+
+        uint8_t cls = slab_class[offset / SLAB_SIZE].load(std::memory_order_acquire);
+        size_t block = cls == SLAB_UNOWNED ? 0 : class_bytes(cls);
+        if (cls == SLAB_UNOWNED || offset % (block < SLAB_SIZE ? block : SLAB_SIZE) != 0) {
+            std::cerr << "[ERR] free_tensor_buffer: " << ptr << " is not a block start" << std::endl;
+            return;
+        }
+
+        uint32_t index = uint32_t(offset >> MIN_BLOCK_SHIFT);
+        if (slab_live[offset / SLAB_SIZE].fetch_sub(1, std::memory_order_relaxed) == 1) {
+            reclaim_hint.store(true, std::memory_order_relaxed);
+        }
+        ThreadCache* cache = local_cache(cls);
+        if (!cache) {
+            push_chain(cls, index, index);
+            return;
+        }
+
+        if (cache->count[cls] == THREAD_CACHE_DEPTH) {
+            const uint32_t keep = THREAD_CACHE_DEPTH / 2;
+            release_blocks(cls, cache->blocks[cls] + keep, THREAD_CACHE_DEPTH - keep);
+            cache->count[cls] = keep;
+        }
+        cache->blocks[cls][cache->count[cls]++] = index;
     }
 
     void fast_reset() {
-        // Instant "O(1)" memory clear by resetting the pointer
+        // Drops every buffer at once; no buffer may be in use by any thread.
+        // Thread caches are invalidated lazily through the epoch.
         current_offset.store(0);
+        for (auto& head : free_heads) head.store(0);
+        for (size_t i = 0; i < slab_count; ++i) {
+            slab_class[i].store(SLAB_UNOWNED);
+            slab_live[i].store(0);
+            block_table[i].is_free = true;
+        }
+        {
+            std::lock_guard<std::mutex> guard(slab_lock);
+            std::fill(free_slabs.begin(), free_slabs.end(), 0);
+            free_slab_count.store(0);
+        }
+        reclaim_hint.store(false);
+        cache_epoch.fetch_add(1, std::memory_order_release);
         std::cout << "[MEM] Memory Pool Flushed." << std::endl;
     }
 
@@ -117,13 +820,590 @@ public:
     }
 };
 
+// Bounded MPSC ring of fixed-size DMA slots carved out of the pool, for
+// streaming job packets to the FPGA without pool resets.
+//   producers : try_acquire() -> fill slot -> submit()    (any thread)
+//   consumer  : try_dispatch() -> program the DMA engine  (one thread)
+//   completion: complete(), from the IRQ / poll path, in any order
+// Each slot carries a sequence number (position p on lap p / capacity):
+//   p = free, p + 1 = submitted, p + 2 = completed, p + capacity = free again.
+// The tail only passes completed slots, so a slot is never reused while
+// the FPGA may still read it.
+class HOCSDmaRing {
+private:
+    struct alignas(64) Slot {
+        std::atomic<uint64_t> sequence;
+    };
+
+    HOCSMremoryManager& pool;
+    uint8_t* region;
+    size_t slot_size;
+    uint64_t capacity;
+    uint64_t mask;
+    std::unique_ptr<Slot[]> slots;
+
+    // One cache line per cursor: producers, consumer and completer never share
+    alignas(64) std::atomic<uint64_t> head;     // Next position to reserve
+    alignas(64) std::atomic<uint64_t> dispatch; // Next position for the DMA engine
+    alignas(64) std::atomic<uint64_t> tail;     // Oldest position not yet released
+
+public:
+    // slot_count must be a power of two >= 4; slots are 64 B aligned
+    HOCSDmaRing(HOCSMremoryManager& memory, size_t slot_bytes, uint32_t slot_count)
+        : pool(memory), slot_size(ALIGN_UP(slot_bytes, 64)), capacity(slot_count), mask(slot_count - 1) {
+        if (slot_count < 4 || (slot_count & (slot_count - 1)) != 0) {
+            throw std::invalid_argument("HOCSDmaRing: slot count must be a power of two >= 4");
+        }
+        region = (uint8_t*)pool.allocate_tensor_buffer(slot_size * slot_count);
+        if (!region) {
+            throw std::runtime_error("HOCSDmaRing: DMA pool cannot hold the ring");
+        }
+
+        slots.reset(new Slot[slot_count]);
+        for (uint64_t i = 0; i < capacity; ++i) slots[i].sequence.store(i, std::memory_order_relaxed);
+        head.store(0);
+        dispatch.store(0);
+        tail.store(0);
+    }
+
+    ~HOCSDmaRing() { pool.free_tensor_buffer(region); }
+
+    HOCSDmaRing(const HOCSDmaRing&) = delete;
+    HOCSDmaRing& operator=(const HOCSDmaRing&) = delete;
+
+    void* slot_data(uint64_t ticket) const { return region + (ticket & mask) * slot_size; }
+    size_t slot_bytes() const { return slot_size; }
+    uint64_t slot_count() const { return capacity; }
+
+    // Slots reserved but not yet released (producer backlog + DMA in flight)
+    uint64_t occupancy() const {
+        return head.load(std::memory_order_relaxed) - tail.load(std::memory_order_relaxed);
+    }
+
+    // Reserves the next slot; nullptr when every slot is still owned by an
+    // outstanding transfer (back-pressure, the caller retries)
+    void* try_acquire(uint64_t& ticket) {
+        uint64_t pos = head.load(std::memory_order_relaxed);
+        for (;;) {
+            uint64_t seq = slots[pos & mask].sequence.load(std::memory_order_acquire);
+            if (seq == pos) {
+                if (head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    ticket = pos;
+                    return slot_data(pos);
+                }
+            } else if (seq < pos) {
+                return nullptr; // Previous lap not released yet: ring full
+            } else {
+                pos = head.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // Publishes a filled slot to the consumer
+    void submit(uint64_t ticket) {
+        slots[ticket & mask].sequence.store(ticket + 1, std::memory_order_release);
+    }
+
+    // Next submitted slot in ring order, nullptr if the producer at the
+    // dispatch cursor has not submitted yet. Single consumer only.
+    void* try_dispatch(uint64_t& ticket) {
+        uint64_t pos = dispatch.load(std::memory_order_relaxed);
+        if (slots[pos & mask].sequence.load(std::memory_order_acquire) != pos + 1) return nullptr;
+        dispatch.store(pos + 1, std::memory_order_relaxed);
+        ticket = pos;
+        return slot_data(pos);
+    }
+
+    // Marks a transfer done and releases every leading completed slot
+    void complete(uint64_t ticket) {
+        slots[ticket & mask].sequence.store(ticket + 2, std::memory_order_release);
+
+        uint64_t pos = tail.load(std::memory_order_acquire);
+        while (slots[pos & mask].sequence.load(std::memory_order_acquire) == pos + 2) {
+            if (tail.compare_exchange_weak(pos, pos + 1, std::memory_order_acq_rel)) {
+                slots[pos & mask].sequence.store(pos + capacity, std::memory_order_release);
+                ++pos;
+            }
+        }
+    }
+};
+
+// One DMA engine + optical core as seen by HOCSTilePipeline. Each stage
+// (MM2S upload, compute, S2MM drain) serves one tile at a time; calls only
+// start or poll work and never block for a whole stage. The core echoes the
+// TILE_ID of a job in its result, which is how drained tiles are matched.
+// No hardware implementation exists: hocs_pci runs a descriptor's three
+// stages itself and only reports the whole job through HOCS_IOC_REAP, so a
+// device transport would have to collapse them into one submit and reap.
+class HOCSTileTransport {
+public:
+    virtual ~HOCSTileTransport() = default;
+    virtual void start_upload(uint32_t tile_id, const void* payload, size_t bytes) = 0;
+    virtual bool upload_done() = 0;
+    virtual void start_compute(uint32_t tile_id) = 0;
+    virtual bool compute_done() = 0;
+    virtual void start_drain(void* result, size_t bytes) = 0;
+    virtual bool drain_done(uint32_t& tile_id) = 0; // tile_id echoed by the core
+};
+
+// Busy time per stage and how much of it the pipeline hid. A serialized
+// driver needs upload + compute + drain per tile; overlap is the fraction
+// of that saved (0 = serialized, 2/3 = three balanced stages fully hidden).
+struct HOCSPipelineStats {
+    uint32_t tiles;
+    uint32_t depth;
+    double wall_us;
+    double upload_us;
+    double compute_us;
+    double drain_us;
+    double overlap;          // 1 - wall / (upload + compute + drain)
+    double core_utilization; // compute / wall
+};
+
+// N buffer sets in flight: tile k+1 uploads while tile k computes and tile
+// k-1 drains. Payloads are the DMA buffers of stage_weight_packets; packet k
+// is TILE_ID k, or tile_ids[k] of a sparse occupancy, and that TILE_ID is
+// what the transport sees and echoes. Each set owns one result buffer from
+// the pool. Results are handed to the caller strictly in TILE_ID order,
+// whatever order the transport returns them in. Every stage is also recorded in the
+// process telemetry (upload = DMA_SUBMIT, compute = IRQ, drain = READBACK).
+// Simulation harness: it schedules HOCSLoopbackTransport only, and the
+// figures it reports model the ICD latencies rather than a measured card.
+class HOCSTilePipeline {
+public:
+    using Deliver = std::function<void(uint32_t tile_id, const void* result)>;
+
+private:
+    enum class Stage { Free, Uploading, Uploaded, Computing, Computed, Draining, Drained };
+    struct BufferSet {
+        void* result;
+        uint32_t tile_id; // TILE_ID as sent to / echoed by the core
+        Stage stage;
+    };
+    using Clock = std::chrono::steady_clock;
+
+    HOCSMremoryManager& pool;
+    HOCSTileTransport& link;
+    size_t result_size;
+    std::vector<BufferSet> sets;
+
+    static double micros(Clock::time_point since) {
+        return std::chrono::duration<double, std::micro>(Clock::now() - since).count();
+    }
+
+    static void stamp(HOCSStage stage, uint64_t since) {
+        hocs_telemetry().record(stage, since, hocs_cycles());
+    }
+
+public:
+    // depth >= 2 buffer sets; 3 overlaps all three stages
+    HOCSTilePipeline(HOCSMremoryManager& memory, HOCSTileTransport& transport, size_t result_bytes,
+                     uint32_t depth = 3)
+        : pool(memory), link(transport), result_size(result_bytes) {
+        if (depth < 2) throw std::invalid_argument("HOCSTilePipeline: at least two buffer sets are needed");
+        for (uint32_t i = 0; i < depth; ++i) {
+            void* result = pool.allocate_tensor_buffer(result_bytes);
+            if (!result) {
+                for (BufferSet& set : sets) pool.free_tensor_buffer(set.result);
+                throw std::runtime_error("HOCSTilePipeline: DMA pool cannot hold the buffer sets");
+            }
+            sets.push_back(BufferSet{result, 0, Stage::Free});
+        }
+    }
+
+    ~HOCSTilePipeline() {
+        for (BufferSet& set : sets) pool.free_tensor_buffer(set.result);
+    }
+
+    HOCSTilePipeline(const HOCSTilePipeline&) = delete;
+    HOCSTilePipeline& operator=(const HOCSTilePipeline&) = delete;
+
+    uint32_t depth() const { return (uint32_t)sets.size(); }
+
+    // Streams every payload (payload_bytes each) through the core and
+    // returns once the last result was delivered. tile_ids (ascending, one
+    // per payload) are the dense TILE_IDs of a sparse run, as in the packet
+    // headers; without them payload k is TILE_ID k. deliver() gets TILE_IDs.
+    HOCSPipelineStats run(const std::vector<void*>& payloads, size_t payload_bytes, const Deliver& deliver,
+                          const std::vector<uint32_t>* tile_ids = nullptr) {
+        const uint32_t tiles = (uint32_t)payloads.size();
+        if (tile_ids && (tile_ids->size() != tiles || !std::is_sorted(tile_ids->begin(), tile_ids->end()) ||
+                         std::adjacent_find(tile_ids->begin(), tile_ids->end()) != tile_ids->end())) {
+            throw std::invalid_argument("HOCSTilePipeline: tile_ids must be ascending, one per payload");
+        }
+        // Packet index <-> TILE_ID
+        auto id_of = [&](uint32_t index) { return tile_ids ? (*tile_ids)[index] : index; };
+        auto index_of = [&](uint32_t tile_id) -> uint32_t {
+            if (!tile_ids) return tile_id;
+            auto it = std::lower_bound(tile_ids->begin(), tile_ids->end(), tile_id);
+            return it != tile_ids->end() && *it == tile_id ? (uint32_t)(it - tile_ids->begin()) : tiles;
+        };
+        HOCSPipelineStats stats{tiles, depth(), 0, 0, 0, 0, 0, 0};
+
+        // Set holding each drained packet until it is next in TILE_ID order
+        std::vector<int> drained(tiles, -1);
+        std::deque<int> wait_compute, wait_drain;
+        int uploading = -1, computing = -1, draining = -1;
+        uint32_t next_upload = 0, next_deliver = 0;
+        Clock::time_point upload_t0, compute_t0, drain_t0, start = Clock::now();
+        uint64_t upload_c0 = 0, compute_c0 = 0, drain_c0 = 0;
+
+        while (next_deliver < tiles) {
+            // Retire finished stages
+            if (uploading >= 0 && link.upload_done()) {
+                stats.upload_us += micros(upload_t0);
+                stamp(HOCS_STAGE_DMA_SUBMIT, upload_c0);
+                sets[uploading].stage = Stage::Uploaded;
+                wait_compute.push_back(uploading);
+                uploading = -1;
+            }
+            if (computing >= 0 && link.compute_done()) {
+                stats.compute_us += micros(compute_t0);
+                stamp(HOCS_STAGE_IRQ, compute_c0);
+                sets[computing].stage = Stage::Computed;
+                wait_drain.push_back(computing);
+                computing = -1;
+            }
+            uint32_t echoed;
+            if (draining >= 0 && link.drain_done(echoed)) {
+                stats.drain_us += micros(drain_t0);
+                stamp(HOCS_STAGE_READBACK, drain_c0);
+                const uint32_t index = index_of(echoed);
+                if (index >= tiles || index >= next_upload || index < next_deliver || drained[index] >= 0) {
+                    throw std::runtime_error("HOCSTilePipeline: core returned unexpected TILE_ID " +
+                                             std::to_string(echoed));
+                }
+                // The buffer now holds tile `echoed`, whichever tile was sent
+                // last from this set
+                sets[draining].tile_id = echoed;
+                sets[draining].stage = Stage::Drained;
+                drained[index] = draining;
+                draining = -1;
+            }
+
+            // Hand results over in TILE_ID order and recycle their sets
+            while (next_deliver < tiles && drained[next_deliver] >= 0) {
+                BufferSet& set = sets[drained[next_deliver]];
+                deliver(id_of(next_deliver), set.result);
+                set.stage = Stage::Free;
+                ++next_deliver;
+            }
+
+            // Issue: drain first (frees buffers), then compute, then upload
+            if (draining < 0 && !wait_drain.empty()) {
+                draining = wait_drain.front();
+                wait_drain.pop_front();
+                sets[draining].stage = Stage::Draining;
+                drain_t0 = Clock::now();
+                drain_c0 = hocs_cycles();
+                link.start_drain(sets[draining].result, result_size);
+            }
+            if (computing < 0 && !wait_compute.empty()) {
+                computing = wait_compute.front();
+                wait_compute.pop_front();
+                sets[computing].stage = Stage::Computing;
+                compute_t0 = Clock::now();
+                compute_c0 = hocs_cycles();
+                link.start_compute(sets[computing].tile_id);
+            }
+            if (uploading < 0 && next_upload < tiles) {
+                for (int i = 0; i < (int)sets.size(); ++i) {
+                    if (sets[i].stage != Stage::Free) continue;
+                    uploading = i;
+                    sets[i].tile_id = id_of(next_upload);
+                    sets[i].stage = Stage::Uploading;
+                    upload_t0 = Clock::now();
+                    upload_c0 = hocs_cycles();
+                    link.start_upload(sets[i].tile_id, payloads[next_upload], payload_bytes);
+                    ++next_upload;
+                    break;
+                }
+            }
+        }
+
+        stats.wall_us = micros(start);
+        double serial = stats.upload_us + stats.compute_us + stats.drain_us;
+        stats.overlap = serial > 0 ? 1.0 - stats.wall_us / serial : 0.0;
+        stats.core_utilization = stats.wall_us > 0 ? stats.compute_us / stats.wall_us : 0.0;
+        return stats;
+    }
+};
+
+// Stand-in for the FPGA with the ICD's latencies (~15 us DMA per direction,
+// < 50 us per tile): every stage completes after a fixed time and the
+// drained result is the uploaded payload, tagged with its TILE_ID. Like the
+// core it echoes the TILE_ID of the packet header when the payload is a job
+// packet, the one passed to start_upload otherwise.
+class HOCSLoopbackTransport : public HOCSTileTransport {
+private:
+    using Clock = std::chrono::steady_clock;
+    std::chrono::nanoseconds upload_time, compute_time, drain_time;
+    Clock::time_point upload_end, compute_end, drain_end;
+
+    struct Job {
+        uint32_t tile_id;
+        const void* payload;
+        size_t bytes;
+    };
+    Job uploading{}, computing{}, draining{};
+    std::deque<Job> on_core; // Uploaded, waiting for / in compute
+    std::deque<Job> computed;
+
+public:
+    HOCSLoopbackTransport(double upload_us = 15.0, double compute_us = 20.0, double drain_us = 15.0)
+        : upload_time((long long)(upload_us * 1000)), compute_time((long long)(compute_us * 1000)),
+          drain_time((long long)(drain_us * 1000)) {}
+
+    void start_upload(uint32_t tile_id, const void* payload, size_t bytes) override {
+        HOCSPacketHeader header;
+        if (bytes >= sizeof(header)) {
+            memcpy(&header, payload, sizeof(header));
+            if (header.magic == HOCS_PACKET_MAGIC) tile_id = header.tile_id;
+        }
+        uploading = Job{tile_id, payload, bytes};
+        upload_end = Clock::now() + upload_time;
+    }
+
+    bool upload_done() override {
+        if (Clock::now() < upload_end) return false;
+        on_core.push_back(uploading);
+        return true;
+    }
+
+    void start_compute(uint32_t) override {
+        computing = on_core.front();
+        on_core.pop_front();
+        compute_end = Clock::now() + compute_time;
+    }
+
+    bool compute_done() override {
+        if (Clock::now() < compute_end) return false;
+        computed.push_back(computing);
+        return true;
+    }
+
+    void start_drain(void* result, size_t bytes) override {
+        draining = computed.front();
+        computed.pop_front();
+        memcpy(result, draining.payload, bytes < draining.bytes ? bytes : draining.bytes);
+        drain_end = Clock::now() + drain_time;
+    }
+
+    bool drain_done(uint32_t& tile_id) override {
+        if (Clock::now() < drain_end) return false;
+        tile_id = draining.tile_id;
+        return true;
+    }
+};
+
+// One pool per online NUMA node. Threads draw buffers from the pool of the
+// node they are running on, so producers and DMA staging stay socket-local.
+class HOCSNumaPoolSet {
+private:
+    std::vector<std::unique_ptr<HOCSMremoryManager>> pools; // Indexed by node id
+    int fallback_node = 0;
+
+    // Parses /sys/devices/system/node/online ("0", "0-1", "0,2-3")
+    static std::vector<int> online_nodes() {
+        std::vector<int> nodes;
+        FILE* f = fopen("/sys/devices/system/node/online", "r");
+        if (!f) return nodes;
+        char list[256] = {0};
+        if (fgets(list, sizeof(list), f)) {
+            char* cursor = list;
+            while (*cursor && *cursor != '\n') {
+                char* end;
+                long first = strtol(cursor, &end, 10);
+                long last = first;
+                if (end == cursor) break;
+                if (*end == '-') last = strtol(end + 1, &end, 10);
+                for (long n = first; n <= last && n < HOCS_MAX_NUMA_NODES; ++n) nodes.push_back((int)n);
+                cursor = (*end == ',') ? end + 1 : end;
+            }
+        }
+        fclose(f);
+        return nodes;
+    }
+
+public:
+    explicit HOCSNumaPoolSet(size_t pool_size_mb_per_node) {
+        std::vector<int> nodes = online_nodes();
+        if (nodes.size() <= 1) {
+            // UMA host: a single unbound pool
+            pools.emplace_back(new HOCSMremoryManager(pool_size_mb_per_node));
+            return;
+        }
+        pools.resize(nodes.back() + 1);
+        fallback_node = nodes.front();
+        for (int node : nodes) {
+            pools[node].reset(new HOCSMremoryManager(pool_size_mb_per_node, node));
+        }
+    }
+
+    // Node of the calling thread (getcpu), -1 if unknown
+    static int current_node() {
+        unsigned cpu = 0, node = 0;
+        if (syscall(SYS_getcpu, &cpu, &node, nullptr) != 0) return -1;
+        return (int)node;
+    }
+
+    HOCSMremoryManager& pool(int node) {
+        if (node < 0 || node >= (int)pools.size() || !pools[node]) node = fallback_node;
+        return *pools[node];
+    }
+
+    HOCSMremoryManager& local_pool() { return pool(current_node()); }
+
+    void* allocate_local(size_t size) { return local_pool().allocate_tensor_buffer(size); }
+
+    // Returns a buffer to the pool that owns it, whichever node frees it
+    void free_buffer(void* ptr) {
+        for (auto& p : pools) {
+            if (p && p->owns(ptr)) {
+                p->free_tensor_buffer(ptr);
+                return;
+            }
+        }
+        std::cerr << "[ERR] free_buffer: " << ptr << " belongs to no NUMA pool" << std::endl;
+    }
+
+    size_t pool_count() const {
+        size_t count = 0;
+        for (const auto& p : pools) count += p ? 1 : 0;
+        return count;
+    }
+};
+
 // C-Bridge for Python Integration
 extern "C" {
     void* create_pool(int size_mb) {
         return new HOCSMremoryManager(size_mb);
     }
+
+    void* create_numa_pool(int size_mb, int numa_node) {
+        return new HOCSMremoryManager(size_mb, numa_node);
+    }
+
+    void destroy_pool(void* manager) {
+        delete (HOCSMremoryManager*)manager;
+    }
+
+    size_t pool_page_size(void* manager) {
+        return ((HOCSMremoryManager*)manager)->page_size();
+    }
     
     void* alloc_tensor(void* manager, int size) {
         return ((HOCSMremoryManager*)manager)->allocate_tensor_buffer(size);
     }
+
+    void free_tensor(void* manager, void* ptr) {
+        ((HOCSMremoryManager*)manager)->free_tensor_buffer(ptr);
+    }
+
+    // HOCSDmaRing over a pool buffer; NULL on a bad slot count or a full pool
+    void* create_dma_ring(void* manager, size_t slot_bytes, uint32_t slot_count) {
+        try {
+            return new HOCSDmaRing(*(HOCSMremoryManager*)manager, slot_bytes, slot_count);
+        } catch (const std::exception& e) {
+            std::cerr << "[ERR] " << e.what() << std::endl;
+            return nullptr;
+        }
+    }
+
+    void destroy_dma_ring(void* ring) {
+        delete (HOCSDmaRing*)ring;
+    }
+
+    void* dma_ring_acquire(void* ring, uint64_t* ticket) {
+        return ((HOCSDmaRing*)ring)->try_acquire(*ticket);
+    }
+
+    void dma_ring_submit(void* ring, uint64_t ticket) {
+        ((HOCSDmaRing*)ring)->submit(ticket);
+    }
+
+    void* dma_ring_dispatch(void* ring, uint64_t* ticket) {
+        return ((HOCSDmaRing*)ring)->try_dispatch(*ticket);
+    }
+
+    void dma_ring_complete(void* ring, uint64_t ticket) {
+        ((HOCSDmaRing*)ring)->complete(ticket);
+    }
+
+    uint64_t dma_ring_occupancy(void* ring) {
+        return ((HOCSDmaRing*)ring)->occupancy();
+    }
+
+    // Builds an ICD job packet of `count` Float32 values (quantized to Q4.12)
+    // in a new pool buffer; *packet_bytes receives its size. NULL if full.
+    void* build_job_packet(void* manager, const float* values, size_t count, uint32_t opcode, uint32_t tile_id,
+                           size_t* packet_bytes) {
+        HOCSMremoryManager& pool = *(HOCSMremoryManager*)manager;
+        void* buffer = pool.allocate_tensor_buffer(hocs_packet_bytes(count * sizeof(int16_t)));
+        if (!buffer) return nullptr;
+        size_t bytes = hocs_build_packet(opcode, tile_id, values, count, buffer);
+        if (packet_bytes) *packet_bytes = bytes;
+        return buffer;
+    }
+
+    // CRC-32C of the packet codec over bytes of data
+    uint32_t packet_crc32c(const void* data, size_t bytes) {
+        return hocs_crc32c(data, bytes);
+    }
+
+    // Verifies a result packet and dequantizes it into out (capacity floats).
+    // Returns the value count, or a negative HOCSPacketStatus.
+    long parse_job_packet(const void* packet, size_t bytes, float* out, size_t capacity) {
+        HOCSPacketHeader header;
+        int status = hocs_parse_packet(packet, bytes, out, capacity, &header);
+        return status == HOCS_PACKET_OK ? (long)(header.payload_len / sizeof(int16_t)) : status;
+    }
+
+    // Per-stage latency of this process (hocs_telemetry.hpp): drains the
+    // thread rings and writes up to max HOCSStageSummary in HOCSStage order
+    int read_stage_telemetry(HOCSStageSummary* out, int max) {
+        if (!out || max <= 0) return -1;
+        return hocs_telemetry().snapshot(out, max);
+    }
+
+    // Streams tile_count 128x128 Q4.12 tiles through the loopback transport
+    // with `depth` buffer sets and reports the achieved overlap (simulated,
+    // no device is involved). Only a
+    // `density` fraction of the tiles hold weights (a pruned layer, spread
+    // evenly); the rest are skipped through the block-CSR occupancy and
+    // stats->tiles counts the transferred ones.
+    int measure_sparse_tile_pipeline(void* manager, int tile_count, double density, int depth,
+                                     HOCSPipelineStats* stats) {
+        if (!manager || !stats || tile_count <= 0 || !(density > 0.0 && density <= 1.0)) return -1;
+        HOCSMremoryManager& pool = *(HOCSMremoryManager*)manager;
+        HOCSTilePlan plan(HOCS_TILE_DIM, HOCS_TILE_DIM * tile_count);
+        std::vector<float> weights((size_t)plan.rows() * plan.cols(), 0.0f);
+        for (const HOCSTile& tile : plan.all_tiles()) {
+            if ((int)((tile.tile_id + 1) * density) == (int)(tile.tile_id * density)) continue;
+            for (int r = 0; r < tile.rows; ++r) {
+                std::fill_n(weights.begin() + (size_t)r * plan.cols() + tile.col0, tile.cols, 0.5f);
+            }
+        }
+        HOCSBlockCSR occupancy = hocs_block_csr(weights.data(), plan.cols(), plan);
+        std::vector<void*> payloads = pool.stage_weight_packets(weights.data(), plan, HOCS_OPCODE_CONFIG, &occupancy);
+        if (payloads.empty()) return -1;
+
+        try {
+            HOCSLoopbackTransport link;
+            const size_t packet_bytes = hocs_packet_bytes(plan.payload_bytes());
+            HOCSTilePipeline pipeline(pool, link, plan.payload_bytes(), (uint32_t)depth);
+            *stats = pipeline.run(payloads, packet_bytes, [](uint32_t, const void*) {}, &occupancy.tile_ids);
+        } catch (const std::exception& e) {
+            std::cerr << "[ERR] " << e.what() << std::endl;
+            for (void* p : payloads) pool.free_tensor_buffer(p);
+            return -1;
+        }
+        for (void* p : payloads) pool.free_tensor_buffer(p);
+        return 0;
+    }
+
+    // Dense case of measure_sparse_tile_pipeline: every tile is transferred
+    int measure_tile_pipeline(void* manager, int tile_count, int depth, HOCSPipelineStats* stats) {
+        return measure_sparse_tile_pipeline(manager, tile_count, 1.0, depth, stats);
+    }
 }
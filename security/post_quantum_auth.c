@@ -6,77 +6,544 @@
  * Description:
  * Protects the Optical Core bitstreams from reverse engineering and tampering.
  * Utilizes Ring-Learning-With-Errors (Ring-LWE) math resistant to Quantum Attacks.
+ *
+ * Arithmetic is Kyber's: Z_q[X]/(X^256 + 1) with q = 3329, a 7-layer
+ * Cooley-Tukey NTT over precomputed twiddles, Montgomery multiplication and
+ * Barrett reduction (no '%' on the hot path). Layers with 16 (AVX2) or 8
+ * (NEON) butterflies per twiddle run vectorized; AVX2 is picked at run time.
+ *
+ * Every bitstream chunk carries a lattice tag t = A*s + e (HOCS_TAG_BYTES).
+ * A is a public parameter expanded from HOCS_DEVICE_SEED; s and e are
+ * sampled from SipHash-2-4 of the chunk under the 128-bit device key. The
+ * tag is therefore a MAC: only holders of the device key (the bitstream
+ * build host and the HSM) can issue or check it, and without a provisioned
+ * key every verification fails. It is symmetric, not a public-key signature.
+ * verify_bitstream_chunks() checks many chunks in parallel.
+ *
+ * Build: gcc -O2 -fopenmp post_quantum_auth.c -lpthread
  */
 
 #include <stdio.h>
 #include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
+#include <pthread.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define HOCS_NTT_X86 1
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#define HOCS_NTT_NEON 1
+#endif
 
 #define SECURITY_LEVEL 3 // NIST Level 3 (AES-192 equivalent)
 #define POLY_DEGREE 256
 #define MODULUS 3329
 
+#define MONT_QINV   (-3327) // q^-1 mod 2^16, signed
+#define BARRETT_V   20159   // round(2^26 / q)
+#define INVNTT_F    1441    // Montgomery factor^2 / 128, undoes the 7 inverse layers
+
+#define HOCS_TAG_BYTES (POLY_DEGREE * 12 / 8) // t packed as 12-bit coefficients
+#define HOCS_DEVICE_SEED 0x484F43534F505431ULL // Public parameter seed for A ("HOCSOPT1")
+#define HOCS_KEY_BYTES 16                       // Device MAC key, fused per device in silicon
+
 // Galois Field structure for Lattice Operations
 typedef struct {
     int16_t coeffs[POLY_DEGREE];
 } Poly;
 
+/*
+ * Powers of the 256th root of unity zeta = 17 in bit-reversed order,
+ * Montgomery form (17^brv7(i) * 2^16 mod q, centered). zetas_qinv holds
+ * zetas[i] * q^-1 mod 2^16 so vector butterflies save one multiply.
+ */
+static const int16_t zetas[128] = {
+    -1044,  -758,  -359, -1517,  1493,  1422,   287,   202,
+     -171,   622,  1577,   182,   962, -1202, -1474,  1468,
+      573, -1325,   264,   383,  -829,  1458, -1602,  -130,
+     -681,  1017,   732,   608, -1542,   411,  -205, -1571,
+     1223,   652,  -552,  1015, -1293,  1491,  -282, -1544,
+      516,    -8,  -320,  -666, -1618, -1162,   126,  1469,
+     -853,   -90,  -271,   830,   107, -1421,  -247,  -951,
+     -398,   961, -1508,  -725,   448, -1065,   677, -1275,
+    -1103,   430,   555,   843, -1251,   871,  1550,   105,
+      422,   587,   177,  -235,  -291,  -460,  1574,  1653,
+     -246,   778,  1159,  -147,  -777,  1483,  -602,  1119,
+    -1590,   644,  -872,   349,   418,   329,  -156,   -75,
+      817,  1097,   603,   610,  1322, -1285, -1465,   384,
+    -1215,  -136,  1218, -1335,  -874,   220, -1187, -1659,
+    -1185, -1530, -1278,   794, -1510,  -854,  -870,   478,
+     -108,  -308,   996,   991,   958, -1460,  1522,  1628,
+};
+
+static const int16_t zetas_qinv[128] = {
+      -20, 31498, 14745,   787, 13525, -12402, 28191, -16694,
+    -20907, 27758, -3799, -15690, 10690,  1358, -11202, 31164,
+    -5827, 17363, -26360, -29057,  5571, -1102, 21438, -26242,
+    -28073, 24313, -10532,  8800, 18426,  8859, 26675, -16163,
+    -5689, -6516,  1496, 30967, -23565, 20179, 20710, 25080,
+    -12796, 26616, 16064, -12442,  9134,  -650, -25986, 27837,
+    19883, -28250, -15887, -8898, -28309,  9075, -30199, 18249,
+    13426, 14017, -29156, -12757, 16832,  4311, -24155, -17915,
+     -335, 11182, -11477, 13387, -32227, -14233, 20494, -21655,
+    -27738, 13131,   945, -4587, -14883, 23092,  6182,  5493,
+    32010, -32502, 10631, 30317, 29175, -18741, -28762, 12639,
+    -18486, 20100, 17560, 18525, -14430, 19529, -5276, -12619,
+    -31183, 20297, 25435,  2146, -7382, 15355, 24391, -32384,
+    -20927, -6280, 10946, -14903, 24214, -11044, 16989, 14469,
+    10335, -21498, -7934, -20198, -22502, 23210, 10906, -17442,
+    31636, -23860, 28644, -20257, 23998,  7756, -17422, 23132,};
+
+// ---------------------------------------------------------------------------
+// Modular reduction
+// ---------------------------------------------------------------------------
+
+// a * 2^-16 mod q for |a| < q * 2^15; result in (-q, q)
+static inline int16_t montgomery_reduce(int32_t a) {
+    int16_t m = (int16_t)((int16_t)a * MONT_QINV);
+    return (int16_t)((a - (int32_t)m * MODULUS) >> 16);
+}
+
+static inline int16_t fqmul(int16_t a, int16_t b) {
+    return montgomery_reduce((int32_t)a * b);
+}
+
+// a mod q in [0, q], floor quotient (matches the vector kernels bit for bit)
+static inline int16_t barrett_reduce(int16_t a) {
+    int16_t t = (int16_t)(((int32_t)a * BARRETT_V) >> 26);
+    return (int16_t)(a - t * MODULUS);
+}
+
+// Canonical representative in [0, q)
+static inline int16_t freeze(int16_t a) {
+    a = barrett_reduce(a);
+    a -= MODULUS;
+    a += (a >> 15) & MODULUS;
+    return a;
+}
+
+// ---------------------------------------------------------------------------
+// Butterfly kernels. lo/hi are the two halves of one block, n butterflies.
+// CT (forward):  lo, hi = lo + z*hi, lo - z*hi
+// GS (inverse):  lo, hi = barrett(lo + hi), z*(hi - lo)
+// ---------------------------------------------------------------------------
+
+static void butterfly_ct_scalar(int16_t *lo, int16_t *hi, int n, int16_t zeta) {
+    for (int j = 0; j < n; j++) {
+        int16_t t = fqmul(zeta, hi[j]);
+        hi[j] = (int16_t)(lo[j] - t);
+        lo[j] = (int16_t)(lo[j] + t);
+    }
+}
+
+static void butterfly_gs_scalar(int16_t *lo, int16_t *hi, int n, int16_t zeta) {
+    for (int j = 0; j < n; j++) {
+        int16_t t = lo[j];
+        lo[j] = barrett_reduce((int16_t)(t + hi[j]));
+        hi[j] = fqmul(zeta, (int16_t)(hi[j] - t));
+    }
+}
+
+#if HOCS_NTT_X86
+#define HOCS_SIMD_LANES 16
+
+// Montgomery product: hi(a*z) - hi(lo(a*z*qinv) * q), exact since the low halves cancel
+__attribute__((target("avx2")))
+static inline __m256i mont_mul_avx2(__m256i a, __m256i z, __m256i zq, __m256i q) {
+    __m256i t = _mm256_mulhi_epi16(a, z);
+    __m256i m = _mm256_mullo_epi16(a, zq);
+    return _mm256_sub_epi16(t, _mm256_mulhi_epi16(m, q));
+}
+
+__attribute__((target("avx2")))
+static void butterfly_ct_simd(int16_t *lo, int16_t *hi, int n, int16_t zeta, int16_t zeta_qinv) {
+    const __m256i z = _mm256_set1_epi16(zeta);
+    const __m256i zq = _mm256_set1_epi16(zeta_qinv);
+    const __m256i q = _mm256_set1_epi16(MODULUS);
+    for (int j = 0; j < n; j += HOCS_SIMD_LANES) {
+        __m256i a = _mm256_loadu_si256((const __m256i *)(lo + j));
+        __m256i b = _mm256_loadu_si256((const __m256i *)(hi + j));
+        __m256i t = mont_mul_avx2(b, z, zq, q);
+        _mm256_storeu_si256((__m256i *)(hi + j), _mm256_sub_epi16(a, t));
+        _mm256_storeu_si256((__m256i *)(lo + j), _mm256_add_epi16(a, t));
+    }
+}
+
+__attribute__((target("avx2")))
+static void butterfly_gs_simd(int16_t *lo, int16_t *hi, int n, int16_t zeta, int16_t zeta_qinv) {
+    const __m256i z = _mm256_set1_epi16(zeta);
+    const __m256i zq = _mm256_set1_epi16(zeta_qinv);
+    const __m256i q = _mm256_set1_epi16(MODULUS);
+    const __m256i v = _mm256_set1_epi16(BARRETT_V);
+    for (int j = 0; j < n; j += HOCS_SIMD_LANES) {
+        __m256i a = _mm256_loadu_si256((const __m256i *)(lo + j));
+        __m256i b = _mm256_loadu_si256((const __m256i *)(hi + j));
+        __m256i s = _mm256_add_epi16(a, b);
+        __m256i quot = _mm256_srai_epi16(_mm256_mulhi_epi16(s, v), 10);
+        _mm256_storeu_si256((__m256i *)(lo + j), _mm256_sub_epi16(s, _mm256_mullo_epi16(quot, q)));
+        _mm256_storeu_si256((__m256i *)(hi + j), mont_mul_avx2(_mm256_sub_epi16(b, a), z, zq, q));
+    }
+}
+
+static int simd_available(void) {
+    return __builtin_cpu_supports("avx2");
+}
+
+#elif HOCS_NTT_NEON
+#define HOCS_SIMD_LANES 8
+
+// vqdmulh doubles, so both high halves are 2x the AVX2 ones; vhsub halves back exactly
+static inline int16x8_t mont_mul_neon(int16x8_t a, int16x8_t z, int16x8_t zq, int16x8_t q) {
+    int16x8_t t = vqdmulhq_s16(a, z);
+    int16x8_t m = vmulq_s16(a, zq);
+    return vhsubq_s16(t, vqdmulhq_s16(m, q));
+}
+
+static void butterfly_ct_simd(int16_t *lo, int16_t *hi, int n, int16_t zeta, int16_t zeta_qinv) {
+    const int16x8_t z = vdupq_n_s16(zeta);
+    const int16x8_t zq = vdupq_n_s16(zeta_qinv);
+    const int16x8_t q = vdupq_n_s16(MODULUS);
+    for (int j = 0; j < n; j += HOCS_SIMD_LANES) {
+        int16x8_t a = vld1q_s16(lo + j);
+        int16x8_t t = mont_mul_neon(vld1q_s16(hi + j), z, zq, q);
+        vst1q_s16(hi + j, vsubq_s16(a, t));
+        vst1q_s16(lo + j, vaddq_s16(a, t));
+    }
+}
+
+static void butterfly_gs_simd(int16_t *lo, int16_t *hi, int n, int16_t zeta, int16_t zeta_qinv) {
+    const int16x8_t z = vdupq_n_s16(zeta);
+    const int16x8_t zq = vdupq_n_s16(zeta_qinv);
+    const int16x8_t q = vdupq_n_s16(MODULUS);
+    const int16x8_t v = vdupq_n_s16(BARRETT_V);
+    for (int j = 0; j < n; j += HOCS_SIMD_LANES) {
+        int16x8_t a = vld1q_s16(lo + j);
+        int16x8_t b = vld1q_s16(hi + j);
+        int16x8_t s = vaddq_s16(a, b);
+        int16x8_t quot = vshrq_n_s16(vqdmulhq_s16(s, v), 11);
+        vst1q_s16(lo + j, vmlsq_s16(s, quot, q));
+        vst1q_s16(hi + j, mont_mul_neon(vsubq_s16(b, a), z, zq, q));
+    }
+}
+
+static int simd_available(void) {
+    return 1; // Baseline on AArch64
+}
+
+#else
+#define HOCS_SIMD_LANES POLY_DEGREE // Never reached: every layer stays scalar
+
+static void butterfly_ct_simd(int16_t *lo, int16_t *hi, int n, int16_t zeta, int16_t zeta_qinv) {
+    (void)zeta_qinv;
+    butterfly_ct_scalar(lo, hi, n, zeta);
+}
+
+static void butterfly_gs_simd(int16_t *lo, int16_t *hi, int n, int16_t zeta, int16_t zeta_qinv) {
+    (void)zeta_qinv;
+    butterfly_gs_scalar(lo, hi, n, zeta);
+}
+
+static int simd_available(void) {
+    return 0;
+}
+#endif
+
+// ---------------------------------------------------------------------------
+// Polynomial arithmetic
+// ---------------------------------------------------------------------------
+
+// In-place forward NTT, standard order in, bit-reversed order out, [0, q] out
 void ntt_transform(Poly *p) {
-    // Number Theoretic Transform (Fast polynomial multiplication)
-    // Simulating hardware acceleration for security handshake
-    for(int i = 0; i < POLY_DEGREE; i++) {
-        p->coeffs[i] = (p->coeffs[i] * 17) % MODULUS; // Mock Zeta reduction
+    int16_t *r = p->coeffs;
+    const int simd = simd_available();
+    int k = 1;
+    for (int len = 128; len >= 2; len >>= 1) {
+        for (int start = 0; start < POLY_DEGREE; start += 2 * len, k++) {
+            if (simd && len >= HOCS_SIMD_LANES) {
+                butterfly_ct_simd(r + start, r + start + len, len, zetas[k], zetas_qinv[k]);
+            } else {
+                butterfly_ct_scalar(r + start, r + start + len, len, zetas[k]);
+            }
+        }
+    }
+    // Coefficients grow by at most q per layer (< 8q), reduce once at the end
+    for (int i = 0; i < POLY_DEGREE; i++) r[i] = barrett_reduce(r[i]);
+}
+
+// In-place inverse NTT, output multiplied by the Montgomery factor 2^16
+void invntt_tomont(Poly *p) {
+    int16_t *r = p->coeffs;
+    const int simd = simd_available();
+    int k = 127;
+    for (int len = 2; len <= 128; len <<= 1) {
+        for (int start = 0; start < POLY_DEGREE; start += 2 * len, k--) {
+            if (simd && len >= HOCS_SIMD_LANES) {
+                butterfly_gs_simd(r + start, r + start + len, len, zetas[k], zetas_qinv[k]);
+            } else {
+                butterfly_gs_scalar(r + start, r + start + len, len, zetas[k]);
+            }
+        }
+    }
+    for (int i = 0; i < POLY_DEGREE; i++) r[i] = fqmul(r[i], INVNTT_F);
+}
+
+// Product in Z_q[X]/(X^2 - zeta) of one coefficient pair, times 2^-16
+static void basemul(int16_t r[2], const int16_t a[2], const int16_t b[2], int16_t zeta) {
+    r[0] = fqmul(fqmul(a[1], b[1]), zeta);
+    r[0] = (int16_t)(r[0] + fqmul(a[0], b[0]));
+    r[1] = (int16_t)(fqmul(a[0], b[1]) + fqmul(a[1], b[0]));
+}
+
+// r = a o b in the NTT domain (times 2^-16, cancelled by invntt_tomont)
+void poly_basemul_montgomery(Poly *r, const Poly *a, const Poly *b) {
+    for (int i = 0; i < POLY_DEGREE / 4; i++) {
+        basemul(&r->coeffs[4 * i], &a->coeffs[4 * i], &b->coeffs[4 * i], zetas[64 + i]);
+        basemul(&r->coeffs[4 * i + 2], &a->coeffs[4 * i + 2], &b->coeffs[4 * i + 2], (int16_t)-zetas[64 + i]);
     }
 }
 
 void poly_add(Poly *r, const Poly *a, const Poly *b) {
     for(int i=0; i<POLY_DEGREE; i++)
-        r->coeffs[i] = (a->coeffs[i] + b->coeffs[i]) % MODULUS;
+        r->coeffs[i] = barrett_reduce((int16_t)(a->coeffs[i] + b->coeffs[i]));
 }
 
-int verify_firmware_signature(const uint8_t *signature, size_t len) {
-    printf("[SEC-CORE] Initiating Post-Quantum Signature Verification...\n");
-    
-    // Simulate Lattice Vector Operation (Matrix A * Vector s + Error e)
-    Poly secret_s, public_A, noise_e, calculated_t;
-    
-    // Initialize with noise (Entropy)
-    for(int i=0; i<POLY_DEGREE; i++) {
-        secret_s.coeffs[i] = (rand() % 5) - 2; // Small noise
-        public_A.coeffs[i] = rand() % MODULUS;
-        noise_e.coeffs[i]  = (rand() % 3) - 1;
-    }
-
-    // Hardware Accelerated Mathematical Transform
+// ---------------------------------------------------------------------------
+// Sampling. The keyed chunk digest is SipHash-2-4 (a PRF under the device
+// key); splitmix64 expands it into s and e in place of Kyber's SHAKE.
+// ---------------------------------------------------------------------------
+
+static inline uint64_t splitmix64(uint64_t *state) {
+    uint64_t z = (*state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+static inline uint64_t rotl64(uint64_t x, int r) {
+    return (x << r) | (x >> (64 - r));
+}
+
+static inline uint64_t load64(const uint8_t *p) {
+    uint64_t v;
+    memcpy(&v, p, sizeof(v)); // Little-endian hosts (x86-64, AArch64)
+    return v;
+}
+
+#define SIPROUND(v0, v1, v2, v3) do { \
+    v0 += v1; v1 = rotl64(v1, 13); v1 ^= v0; v0 = rotl64(v0, 32); \
+    v2 += v3; v3 = rotl64(v3, 16); v3 ^= v2; \
+    v0 += v3; v3 = rotl64(v3, 21); v3 ^= v0; \
+    v2 += v1; v1 = rotl64(v1, 17); v1 ^= v2; v2 = rotl64(v2, 32); \
+} while (0)
+
+// SipHash-2-4 of data under a 128-bit key
+static uint64_t siphash24(const uint8_t key[HOCS_KEY_BYTES], const uint8_t *data, size_t len) {
+    const uint64_t k0 = load64(key), k1 = load64(key + 8);
+    uint64_t v0 = k0 ^ 0x736F6D6570736575ULL, v1 = k1 ^ 0x646F72616E646F6DULL;
+    uint64_t v2 = k0 ^ 0x6C7967656E657261ULL, v3 = k1 ^ 0x7465646279746573ULL;
+    size_t i = 0;
+    for (; i + 8 <= len; i += 8) {
+        uint64_t m = load64(data + i);
+        v3 ^= m;
+        SIPROUND(v0, v1, v2, v3);
+        SIPROUND(v0, v1, v2, v3);
+        v0 ^= m;
+    }
+    uint64_t b = (uint64_t)len << 56;
+    for (size_t j = 0; i + j < len; j++) b |= (uint64_t)data[i + j] << (8 * j);
+    v3 ^= b;
+    SIPROUND(v0, v1, v2, v3);
+    SIPROUND(v0, v1, v2, v3);
+    v0 ^= b;
+    v2 ^= 0xFF;
+    for (int r = 0; r < 4; r++) SIPROUND(v0, v1, v2, v3);
+    return v0 ^ v1 ^ v2 ^ v3;
+}
+
+// Device key as read from the fuses; sign / verify fail until it is set
+static uint8_t device_key[HOCS_KEY_BYTES];
+static int device_key_set = 0;
+
+// Centered binomial noise, eta = 2: 4 random bits per coefficient
+static void sample_cbd2(Poly *p, uint64_t *state) {
+    for (int i = 0; i < POLY_DEGREE; i += 16) {
+        uint64_t bits = splitmix64(state);
+        uint64_t d = (bits & 0x5555555555555555ULL) + ((bits >> 1) & 0x5555555555555555ULL);
+        for (int j = 0; j < 16; j++) {
+            int16_t a = (int16_t)((d >> (4 * j)) & 0x3);
+            int16_t b = (int16_t)((d >> (4 * j + 2)) & 0x3);
+            p->coeffs[i + j] = (int16_t)(a - b);
+        }
+    }
+}
+
+// Public A, sampled uniformly straight into the NTT domain once per process
+static Poly public_A_hat;
+static pthread_once_t public_A_once = PTHREAD_ONCE_INIT;
+
+static void expand_public_A(void) {
+    uint64_t state = HOCS_DEVICE_SEED;
+    int i = 0;
+    while (i < POLY_DEGREE) {
+        uint64_t bits = splitmix64(&state);
+        for (int j = 0; j < 5 && i < POLY_DEGREE; j++, bits >>= 12) {
+            uint16_t v = (uint16_t)(bits & 0xFFF);
+            if (v < MODULUS) public_A_hat.coeffs[i++] = (int16_t)v; // Rejection keeps it uniform
+        }
+    }
+}
+
+// t = A*s + e for the chunk under the device key, packed into HOCS_TAG_BYTES
+static void lattice_tag(const uint8_t *chunk, size_t len, uint8_t tag[HOCS_TAG_BYTES]) {
+    pthread_once(&public_A_once, expand_public_A);
+
+    Poly secret_s, noise_e, calculated_t;
+    uint64_t state = siphash24(device_key, chunk, len);
+    sample_cbd2(&secret_s, &state);
+    sample_cbd2(&noise_e, &state);
+
     ntt_transform(&secret_s);
-    ntt_transform(&public_A);
-    
-    // t = A*s + e (The Core LWE Problem)
-    // If attacker can solve this, they can hack the chip. 
-    // Quantum computers struggle with this.
-    for(int i=0; i<POLY_DEGREE; i++) {
-        calculated_t.coeffs[i] = (public_A.coeffs[i] * secret_s.coeffs[i] + noise_e.coeffs[i]) % MODULUS;
-    }
-    
+    poly_basemul_montgomery(&calculated_t, &public_A_hat, &secret_s);
+    invntt_tomont(&calculated_t);
+    poly_add(&calculated_t, &calculated_t, &noise_e);
+
+    for (int i = 0; i < POLY_DEGREE; i += 2) {
+        uint16_t t0 = (uint16_t)freeze(calculated_t.coeffs[i]);
+        uint16_t t1 = (uint16_t)freeze(calculated_t.coeffs[i + 1]);
+        tag[3 * i / 2 + 0] = (uint8_t)t0;
+        tag[3 * i / 2 + 1] = (uint8_t)((t0 >> 8) | (t1 << 4));
+        tag[3 * i / 2 + 2] = (uint8_t)(t1 >> 4);
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Public API
+// ---------------------------------------------------------------------------
+
+// Loads the device MAC key (fuse read on silicon, provisioning on the
+// build host). Call before any thread signs or verifies.
+void hocs_provision_device_key(const uint8_t key[HOCS_KEY_BYTES]) {
+    memcpy(device_key, key, HOCS_KEY_BYTES);
+    device_key_set = 1;
+}
+
+// Tag issued for a chunk at bitstream build time; 0 without a device key
+int sign_bitstream_chunk(const uint8_t *chunk, size_t len, uint8_t tag[HOCS_TAG_BYTES]) {
+    if (!device_key_set) return 0;
+    lattice_tag(chunk, len, tag);
+    return 1;
+}
+
+// 1 when tag matches the chunk, compared in constant time. Fails closed
+// without a device key.
+int verify_bitstream_chunk(const uint8_t *chunk, size_t len, const uint8_t tag[HOCS_TAG_BYTES]) {
+    if (!device_key_set) return 0;
+    uint8_t expected[HOCS_TAG_BYTES];
+    lattice_tag(chunk, len, expected);
+    uint8_t diff = 0;
+    for (int i = 0; i < HOCS_TAG_BYTES; i++) diff |= (uint8_t)(expected[i] ^ tag[i]);
+    return diff == 0;
+}
+
+// Verifies count chunks in parallel. results[i] = 1 / 0 per chunk (may be
+// NULL); returns how many verified, so count means the whole image is good.
+int verify_bitstream_chunks(const uint8_t *const *chunks, const size_t *lengths,
+                            const uint8_t *const *tags, int count, int *results) {
+    int valid = 0;
+    #pragma omp parallel for schedule(dynamic) reduction(+:valid)
+    for (int i = 0; i < count; i++) {
+        int ok = verify_bitstream_chunk(chunks[i], lengths[i], tags[i]);
+        if (results) results[i] = ok;
+        valid += ok;
+    }
+    return valid;
+}
+
+// signature = tagged payload followed by its HOCS_TAG_BYTES lattice MAC
+int verify_firmware_signature(const uint8_t *signature, size_t len) {
+    printf("[SEC-CORE] Initiating Lattice MAC Verification...\n");
+    if (!device_key_set) {
+        printf("[SEC-CORE] No device key provisioned: firmware cannot be authenticated.\n");
+        return 0;
+    }
+    if (len < HOCS_TAG_BYTES) {
+        printf("[SEC-CORE] Signature truncated (%zu bytes).\n", len);
+        return 0;
+    }
+
+    // t = A*s + e with s, e derived from the keyed digest: forging a tag
+    // needs the device key
+    size_t payload = len - HOCS_TAG_BYTES;
+    int ok = verify_bitstream_chunk(signature, payload, signature + payload);
+
     printf("[SEC-CORE] Lattice Calculation Complete. Entropy: High.\n");
-    printf("[SEC-CORE] Firmware Authenticated via Ring-LWE Protocol.\n");
-    
-    return 1; // Success
+    if (ok) printf("[SEC-CORE] Firmware Authenticated (device-keyed lattice MAC).\n");
+    return ok;
+}
+
+// Device key from HOCS_DEVICE_KEY (32 hex digits) where no fuses exist
+static int load_device_key_from_env(void) {
+    const char *hex = getenv("HOCS_DEVICE_KEY");
+    uint8_t key[HOCS_KEY_BYTES];
+    if (!hex || strlen(hex) != 2 * HOCS_KEY_BYTES) return 0;
+    for (int i = 0; i < HOCS_KEY_BYTES; i++) {
+        unsigned int byte;
+        if (sscanf(hex + 2 * i, "%2x", &byte) != 1) return 0;
+        key[i] = (uint8_t)byte;
+    }
+    hocs_provision_device_key(key);
+    return 1;
 }
 
 // Interface for Python CTypes
 void run_security_check() {
-    uint8_t dummy_sig[32] = {0};
-    if(verify_firmware_signature(dummy_sig, 32)) {
+    uint8_t dummy_sig[32 + HOCS_TAG_BYTES] = {0};
+    if (!device_key_set && !load_device_key_from_env()) {
+        printf("[SEC-CORE] HOCS_DEVICE_KEY not set.\n");
+    }
+    sign_bitstream_chunk(dummy_sig, 32, dummy_sig + 32);
+    if(verify_firmware_signature(dummy_sig, sizeof(dummy_sig))) {
         printf(">> ACCESS GRANTED: HOCS Optical Core is unlocked.\n");
     } else {
         printf(">> ACCESS DENIED: Tampering Detected. Burning Fuses.\n");
     }
 }
 
+// NTT product against schoolbook multiplication mod X^256 + 1
+static int ntt_self_test(void) {
+    Poly a, b, c;
+    int32_t ref[POLY_DEGREE] = {0};
+    uint64_t state = 1;
+    for (int i = 0; i < POLY_DEGREE; i++) {
+        a.coeffs[i] = (int16_t)(splitmix64(&state) % MODULUS);
+        b.coeffs[i] = (int16_t)(splitmix64(&state) % MODULUS);
+    }
+    for (int i = 0; i < POLY_DEGREE; i++) {
+        for (int j = 0; j < POLY_DEGREE; j++) {
+            int32_t prod = (int32_t)a.coeffs[i] * b.coeffs[j] % MODULUS;
+            int k = i + j;
+            if (k < POLY_DEGREE) ref[k] = (ref[k] + prod) % MODULUS;
+            else ref[k - POLY_DEGREE] = (ref[k - POLY_DEGREE] - prod + MODULUS) % MODULUS;
+        }
+    }
+    ntt_transform(&a);
+    ntt_transform(&b);
+    poly_basemul_montgomery(&c, &a, &b);
+    invntt_tomont(&c);
+    for (int i = 0; i < POLY_DEGREE; i++) {
+        if (freeze(c.coeffs[i]) != ref[i]) return 0;
+    }
+    return 1;
+}
+
 int main() {
     // Self-test
+    if (!ntt_self_test()) {
+        printf("[SEC-CORE] NTT self-test FAILED.\n");
+        return 1;
+    }
     run_security_check();
     return 0;
 }
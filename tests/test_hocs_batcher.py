@@ -0,0 +1,97 @@
+"""
+HOCS REQUEST BATCHER TEST SUITE
+===============================
+Scope: Dynamic Batching & Weights Registry (backend/hocs_batcher.py)
+Framework: PyTest
+"""
+
+import asyncio
+import os
+import sys
+
+import numpy as np
+import pytest
+
+# The batcher imports its siblings as top-level modules
+sys.path.append(os.path.abspath(os.path.join(os.path.dirname(__file__), '..', 'backend')))
+
+from hocs_batcher import HOCSRequestBatcher, HOCSWeightsRegistry
+
+class StubPool:
+    """gemm_async as an exact W @ V, recording the columns of every dispatch."""
+
+    def __init__(self):
+        self.dispatches = []
+
+    async def gemm_async(self, weights, voltages):
+        self.dispatches.append(voltages.shape[1])
+        await asyncio.sleep(0)
+        return np.dot(weights, voltages)
+
+# --- FIXTURES (Setup) ---
+@pytest.fixture
+def weights():
+    return np.random.default_rng(3).standard_normal((200, 64)).astype(np.float32)
+
+def columns(widths, seed=5):
+    rng = np.random.default_rng(seed)
+    return [rng.standard_normal((64, width)).astype(np.float32) for width in widths]
+
+def propagate_all(batcher, weights, voltages):
+    async def run():
+        return await asyncio.gather(*(batcher.propagate("w", weights, v) for v in voltages))
+    return asyncio.run(run())
+
+# --- TESTS ---
+
+def test_batched_columns_equal_per_request_results(weights):
+    """Concurrent requests share one dispatch and each gets back exactly W @ its columns."""
+    pool = StubPool()
+    batcher = HOCSRequestBatcher(pool, window_ms=20.0, max_columns=64)
+    voltages = columns([1, 3, 2, 5, 1])
+    results = propagate_all(batcher, weights, voltages)
+
+    assert pool.dispatches == [12]
+    for v, result in zip(voltages, results):
+        assert result.shape == (weights.shape[0], v.shape[1])
+        assert np.allclose(result, weights @ v, atol=1e-4)
+    assert batcher.stats()["mean_batch"] == 5.0
+
+def test_batches_split_at_max_columns(weights):
+    """A request that would overflow the open batch starts the next one."""
+    pool = StubPool()
+    batcher = HOCSRequestBatcher(pool, window_ms=20.0, max_columns=4)
+    voltages = columns([2, 2, 3, 1, 2])
+    results = propagate_all(batcher, weights, voltages)
+
+    assert pool.dispatches == [4, 4, 2]
+    assert all(width <= batcher.max_columns for width in pool.dispatches)
+    for v, result in zip(voltages, results):
+        assert np.allclose(result, weights @ v, atol=1e-4)
+
+def test_request_wider_than_max_columns_is_rejected(weights):
+    pool = StubPool()
+    batcher = HOCSRequestBatcher(pool, window_ms=1.0, max_columns=4)
+    with pytest.raises(ValueError):
+        propagate_all(batcher, weights, columns([5]))
+    assert pool.dispatches == []
+
+def test_weights_registry_evicts_least_recently_used():
+    """Two 4 KB sets fit; a lookup refreshes one, so the third evicts the other."""
+    rng = np.random.default_rng(11)
+    sets = [rng.standard_normal((32, 32)).astype(np.float32) for _ in range(3)]
+    registry = HOCSWeightsRegistry(max_mb=2 * sets[0].nbytes / (1024 * 1024))
+    first, second = registry.add(sets[0]), registry.add(sets[1])
+    assert registry.add(sets[0].copy()) == first  # Content addressed
+
+    assert registry.get(first) is not None
+    third = registry.add(sets[2])
+    assert registry.get(second) is None
+    assert registry.get(first) is not None and registry.get(third) is not None
+    assert registry.stats()["evicted"] == 1
+
+    assert registry.remove(third)
+    assert not registry.remove(third)
+    assert registry.stats()["bytes"] == sets[0].nbytes
+    with pytest.raises(ValueError):
+        registry.add(np.zeros((64, 64), dtype=np.float32))
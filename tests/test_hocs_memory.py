@@ -0,0 +1,233 @@
+"""
+HOCS DMA MEMORY TEST SUITE
+==========================
+Scope: Slab Allocator, DMA Ring and Job Packet Codec of libhocs_mem.so (C ABI via ctypes)
+Framework: PyTest
+"""
+
+import ctypes
+import os
+import subprocess
+import sys
+
+import pytest
+
+MEM_LIB = os.environ.get(
+    "HOCS_MEM_LIB",
+    os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "memory", "libhocs_mem.so"))
+
+SLAB_BYTES = 1 << 20  # SLAB_SIZE of the allocator
+POOL_MB = 8
+
+# --- FIXTURES (Setup) ---
+@pytest.fixture(scope="module")
+def mem_lib():
+    """libhocs_mem.so with the signatures used below."""
+    if not os.path.exists(MEM_LIB):
+        pytest.skip(f"{MEM_LIB} not built")
+    lib = ctypes.CDLL(MEM_LIB)
+    lib.create_pool.restype = ctypes.c_void_p
+    lib.create_pool.argtypes = [ctypes.c_int]
+    lib.destroy_pool.argtypes = [ctypes.c_void_p]
+    lib.alloc_tensor.restype = ctypes.c_void_p
+    lib.alloc_tensor.argtypes = [ctypes.c_void_p, ctypes.c_int]
+    lib.free_tensor.argtypes = [ctypes.c_void_p, ctypes.c_void_p]
+    return lib
+
+@pytest.fixture
+def pool(mem_lib):
+    """A fresh POOL_MB pool, destroyed after the test."""
+    handle = mem_lib.create_pool(POOL_MB)
+    yield handle
+    mem_lib.destroy_pool(handle)
+
+def drain(lib, pool, size):
+    """Allocates `size` byte buffers until the pool is exhausted."""
+    buffers = []
+    while True:
+        ptr = lib.alloc_tensor(pool, size)
+        if not ptr:
+            return buffers
+        buffers.append(ptr)
+
+# --- TESTS ---
+
+def test_slab_reuse_across_size_classes(mem_lib, pool):
+    """
+    Slabs freed by one size class are carved by another: exhausting the
+    pool with 1 MB buffers and freeing them must leave room for 4 KB ones.
+    """
+    large = drain(mem_lib, pool, SLAB_BYTES)
+    assert len(large) == POOL_MB
+    for ptr in large:
+        mem_lib.free_tensor(pool, ptr)
+
+    small = drain(mem_lib, pool, 4096)
+    assert len(small) == POOL_MB * SLAB_BYTES // 4096
+    assert len(set(small)) == len(small)
+
+    # And back: the 4 KB slabs return once every block is free again
+    for ptr in small:
+        mem_lib.free_tensor(pool, ptr)
+    assert len(drain(mem_lib, pool, SLAB_BYTES)) == POOL_MB
+
+def test_slab_reuse_for_multi_slab_runs(mem_lib, pool):
+    """Classes above 1 MB need consecutive reclaimed slabs."""
+    for ptr in drain(mem_lib, pool, 4096):
+        mem_lib.free_tensor(pool, ptr)
+    assert len(drain(mem_lib, pool, 2 * SLAB_BYTES)) == POOL_MB // 2
+
+# --- DMA RING (HOCSDmaRing) ---
+
+RING_SLOTS = 4
+
+@pytest.fixture
+def ring(mem_lib, pool):
+    """A RING_SLOTS x 64 B HOCSDmaRing on the pool."""
+    lib = mem_lib
+    lib.create_dma_ring.restype = ctypes.c_void_p
+    lib.create_dma_ring.argtypes = [ctypes.c_void_p, ctypes.c_size_t, ctypes.c_uint32]
+    lib.destroy_dma_ring.argtypes = [ctypes.c_void_p]
+    for name in ("dma_ring_acquire", "dma_ring_dispatch"):
+        getattr(lib, name).restype = ctypes.c_void_p
+        getattr(lib, name).argtypes = [ctypes.c_void_p, ctypes.POINTER(ctypes.c_uint64)]
+    for name in ("dma_ring_submit", "dma_ring_complete"):
+        getattr(lib, name).argtypes = [ctypes.c_void_p, ctypes.c_uint64]
+    lib.dma_ring_occupancy.restype = ctypes.c_uint64
+    lib.dma_ring_occupancy.argtypes = [ctypes.c_void_p]
+    handle = lib.create_dma_ring(pool, 64, RING_SLOTS)
+    assert handle
+    yield handle
+    lib.destroy_dma_ring(handle)
+
+def ring_call(lib, name, ring):
+    """(slot pointer or None, ticket) of acquire / dispatch."""
+    ticket = ctypes.c_uint64()
+    ptr = getattr(lib, name)(ring, ctypes.byref(ticket))
+    return ptr, ticket.value
+
+def test_dma_ring_wraps_in_order(mem_lib, ring):
+    """
+    Over several laps: a full ring refuses producers, dispatch follows ring
+    order whatever the submit order, and the tail only passes a slot once
+    every earlier slot completed, however out of order completions arrive.
+    """
+    lib = mem_lib
+    addresses = None
+    for lap in range(3):
+        acquired = [ring_call(lib, "dma_ring_acquire", ring) for _ in range(RING_SLOTS)]
+        tickets = [ticket for _, ticket in acquired]
+        assert tickets == list(range(lap * RING_SLOTS, (lap + 1) * RING_SLOTS))
+        slot_addresses = [ptr for ptr, _ in acquired]
+        assert all(slot_addresses)
+        if addresses is None:
+            addresses = slot_addresses
+        assert slot_addresses == addresses  # Same slots every lap
+        assert ring_call(lib, "dma_ring_acquire", ring)[0] is None  # Full: back-pressure
+
+        for ptr, ticket in reversed(acquired):
+            ctypes.c_uint64.from_address(ptr).value = ticket
+            lib.dma_ring_submit(ring, ticket)
+        for ptr, ticket in acquired:
+            assert ring_call(lib, "dma_ring_dispatch", ring) == (ptr, ticket)
+            assert ctypes.c_uint64.from_address(ptr).value == ticket
+        assert ring_call(lib, "dma_ring_dispatch", ring)[0] is None
+
+        first = tickets[0]
+        lib.dma_ring_complete(ring, first + 2)
+        assert lib.dma_ring_occupancy(ring) == RING_SLOTS  # Slot 0 still in flight
+        assert ring_call(lib, "dma_ring_acquire", ring)[0] is None
+        lib.dma_ring_complete(ring, first)
+        assert lib.dma_ring_occupancy(ring) == RING_SLOTS - 1  # Stops at slot 1
+        lib.dma_ring_complete(ring, first + 3)
+        lib.dma_ring_complete(ring, first + 1)
+        assert lib.dma_ring_occupancy(ring) == 0
+
+def test_dma_ring_dispatch_waits_for_submit(mem_lib, ring):
+    """A later submitted slot is not dispatched ahead of an unsubmitted one."""
+    lib = mem_lib
+    (_, t0), (_, t1) = [ring_call(lib, "dma_ring_acquire", ring) for _ in range(2)]
+    lib.dma_ring_submit(ring, t1)
+    assert ring_call(lib, "dma_ring_dispatch", ring)[0] is None
+    lib.dma_ring_submit(ring, t0)
+    assert ring_call(lib, "dma_ring_dispatch", ring)[1] == t0
+    assert ring_call(lib, "dma_ring_dispatch", ring)[1] == t1
+
+# --- JOB PACKET CODEC (cpp_core/hocs_packet.hpp) ---
+
+Q12_ONE = 4096
+PACKET_BAD_CRC = -3  # HOCS_PACKET_BAD_CRC
+OPCODE_WRITE = 0x1
+
+def packet_codec(lib):
+    """build_job_packet / parse_job_packet signatures."""
+    lib.build_job_packet.restype = ctypes.c_void_p
+    lib.build_job_packet.argtypes = [ctypes.c_void_p, ctypes.POINTER(ctypes.c_float), ctypes.c_size_t,
+                                     ctypes.c_uint32, ctypes.c_uint32, ctypes.POINTER(ctypes.c_size_t)]
+    lib.parse_job_packet.restype = ctypes.c_long
+    lib.parse_job_packet.argtypes = [ctypes.c_void_p, ctypes.c_size_t, ctypes.POINTER(ctypes.c_float),
+                                     ctypes.c_size_t]
+    return lib
+
+def test_crc32c_check_value():
+    """
+    CRC-32C check value on the dispatched kernels and on the scalar ones.
+    HOCS_SIMD is read once per process, so each runs in its own interpreter.
+    """
+    if not os.path.exists(MEM_LIB):
+        pytest.skip(f"{MEM_LIB} not built")
+    script = ("import ctypes, sys; lib = ctypes.CDLL(sys.argv[1]); "
+              "lib.packet_crc32c.restype = ctypes.c_uint32; "
+              "print(lib.packet_crc32c(b'123456789', ctypes.c_size_t(9)))")
+    for isa in (None, "scalar"):
+        env = {k: v for k, v in os.environ.items() if k != "HOCS_SIMD"}
+        if isa:
+            env["HOCS_SIMD"] = isa
+        out = subprocess.run([sys.executable, "-c", script, MEM_LIB], env=env, capture_output=True,
+                             text=True, check=True).stdout
+        assert int(out.split()[-1]) == 0xE3069283, isa
+
+def test_packet_round_trip(mem_lib, pool):
+    """
+    Q4.12 values survive build + parse exactly, out of range ones saturate,
+    and a flipped payload bit is caught by the CRC footer. 37 values cover
+    the vector body and the scalar tail of the kernels.
+    """
+    lib = packet_codec(mem_lib)
+    values = [(i - 18) * 37 / Q12_ONE for i in range(35)] + [100.0, -100.0]
+    expected = values[:35] + [32767 / Q12_ONE, -8.0]
+    src = (ctypes.c_float * len(values))(*values)
+    size = ctypes.c_size_t()
+    packet = lib.build_job_packet(pool, src, len(values), OPCODE_WRITE, 7, ctypes.byref(size))
+    assert packet
+    assert size.value == 16 + 2 * len(values) + 4
+
+    out = (ctypes.c_float * len(values))()
+    assert lib.parse_job_packet(packet, size.value, out, len(values)) == len(values)
+    assert list(out) == expected
+
+    payload = ctypes.c_uint8.from_address(packet + 16 + 5)
+    payload.value ^= 0x10
+    assert lib.parse_job_packet(packet, size.value, out, len(values)) == PACKET_BAD_CRC
+    mem_lib.free_tensor(pool, packet)
+
+# --- TILE PIPELINE (HOCSTilePipeline, loopback transport) ---
+
+class PipelineStats(ctypes.Structure):
+    """struct HOCSPipelineStats of memory/hocs_dma_allocator.cpp."""
+    _fields_ = [("tiles", ctypes.c_uint32), ("depth", ctypes.c_uint32)] + [
+        (name, ctypes.c_double) for name in
+        ("wall_us", "upload_us", "compute_us", "drain_us", "overlap", "core_utilization")]
+
+def test_sparse_pipeline_matches_header_tile_ids(mem_lib, pool):
+    """
+    Sparse packets carry dense TILE_IDs in their headers and the loopback
+    echoes those, like the core: the pipeline must map them back to packets.
+    """
+    lib = mem_lib
+    lib.measure_sparse_tile_pipeline.argtypes = [ctypes.c_void_p, ctypes.c_int, ctypes.c_double, ctypes.c_int,
+                                                 ctypes.POINTER(PipelineStats)]
+    stats = PipelineStats()
+    assert lib.measure_sparse_tile_pipeline(pool, 16, 0.5, 3, ctypes.byref(stats)) == 0
+    assert stats.tiles == 8
+    assert stats.depth == 3
@@ -0,0 +1,106 @@
+"""
+HOCS DEVICE POOL TEST SUITE
+===========================
+Scope: GEMM Sharding, Work Stealing & Thermal Shedding (backend/hocs_device_pool.py)
+Framework: PyTest
+"""
+
+import asyncio
+import os
+import sys
+import time
+
+import numpy as np
+import pytest
+
+# The pool imports its siblings as top-level modules
+sys.path.append(os.path.abspath(os.path.join(os.path.dirname(__file__), '..', 'backend')))
+
+from hocs_axi_driver import HOCSThermalOverload
+from hocs_device_pool import HOCSDevicePool, HOCS_TILE_DIM
+
+ROWS = 5 * HOCS_TILE_DIM - 40  # Five tiles, the last one ragged
+TILE_SECONDS = 0.005           # Long enough that no device drains another's deque before it starts
+
+class StubThermal:
+    def stats(self):
+        return {}
+
+class StubDevice:
+    """Exact W @ V per tile; sheds every tile after the first `shed_after`."""
+
+    def __init__(self, device_id, shed_after=None, retry_after=0.5):
+        self.device_id = device_id
+        self.thermal = StubThermal()
+        self.shed_after = shed_after
+        self.retry_after = retry_after
+        self.tiles = 0
+        self.closed = False
+
+    def _tile(self, weights, voltages):
+        if self.shed_after is not None and self.tiles >= self.shed_after:
+            raise HOCSThermalOverload(self.retry_after)
+        self.tiles += 1
+        return np.dot(weights, voltages)
+
+    def multiply(self, weights, voltages):
+        time.sleep(TILE_SECONDS)
+        return self._tile(weights, voltages)
+
+    async def multiply_async(self, weights, voltages):
+        await asyncio.sleep(TILE_SECONDS)
+        return self._tile(weights, voltages)
+
+    def close(self):
+        self.closed = True
+
+# --- FIXTURES (Setup) ---
+@pytest.fixture
+def operands():
+    rng = np.random.default_rng(7)
+    return (rng.standard_normal((ROWS, 64)).astype(np.float32),
+            rng.standard_normal((64, 8)).astype(np.float32))
+
+def run_gemm(pool, weights, voltages, mode):
+    if mode == "sync":
+        return pool.gemm(weights, voltages)
+    return asyncio.run(pool.gemm_async(weights, voltages))
+
+# --- TESTS ---
+
+def test_gemm_survives_one_shedding_device(operands):
+    """
+    A device that sheds after one tile hands it back and sits out: the
+    others finish the GEMM, which still equals W @ V, on both entry points.
+    """
+    weights, voltages = operands
+    for mode in ("sync", "async"):
+        pool = HOCSDevicePool([StubDevice(0), StubDevice(1, shed_after=1), StubDevice(2)])
+        try:
+            output = run_gemm(pool, weights, voltages, mode)
+            assert output.shape == (ROWS, voltages.shape[1])
+            assert np.allclose(output, weights @ voltages, atol=1e-4), mode
+            assert pool.tiles_shed == [0, 1, 0], mode
+            assert pool.tiles_done[1] == 1, mode
+            assert sum(pool.tiles_done) == 5, mode
+        finally:
+            pool.close()
+
+def test_gemm_fails_when_every_device_sheds(operands):
+    """Only when no device has headroom left does the pool raise, with the earliest retry."""
+    weights, voltages = operands
+    for mode in ("sync", "async"):
+        pool = HOCSDevicePool([StubDevice(0, shed_after=1, retry_after=0.8),
+                               StubDevice(1, shed_after=0, retry_after=0.3)])
+        try:
+            with pytest.raises(HOCSThermalOverload) as excinfo:
+                run_gemm(pool, weights, voltages, mode)
+            assert excinfo.value.retry_after == 0.3, mode
+            assert pool.tiles_shed == [1, 1], mode
+        finally:
+            pool.close()
+
+def test_close_releases_every_device():
+    devices = [StubDevice(0), StubDevice(1)]
+    HOCSDevicePool(devices).close()
+    assert all(device.closed for device in devices)
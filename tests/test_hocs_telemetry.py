@@ -0,0 +1,83 @@
+"""
+HOCS TELEMETRY TEST SUITE
+=========================
+Scope: Per-Thread Event Rings of cpp_core/hocs_telemetry.hpp (C ABI via ctypes)
+Framework: PyTest
+"""
+
+import ctypes
+import os
+import sys
+import threading
+
+import pytest
+
+sys.path.append(os.path.abspath(os.path.join(os.path.dirname(__file__), '..', 'backend')))
+
+from hocs_axi_driver import NATIVE_ENGINE_LIB, HOCSStageSummary
+
+STAGE_COUNT = 5  # HOCS_STAGE_COUNT
+STAGE_IRQ = 2
+THREADS = 1000
+EVENTS_PER_THREAD = 100
+
+# --- FIXTURES (Setup) ---
+@pytest.fixture(scope="module")
+def engine_lib():
+    """libhocs_engine.so with the telemetry signatures used below."""
+    if not os.path.exists(NATIVE_ENGINE_LIB):
+        pytest.skip(f"{NATIVE_ENGINE_LIB} not built")
+    lib = ctypes.CDLL(NATIVE_ENGINE_LIB)
+    lib.hocs_telemetry_snapshot.argtypes = [ctypes.POINTER(HOCSStageSummary), ctypes.c_int]
+    lib.hocs_telemetry_now.restype = ctypes.c_uint64
+    lib.hocs_telemetry_record.argtypes = [ctypes.c_int, ctypes.c_uint64, ctypes.c_uint64]
+    lib.hocs_telemetry_dropped.restype = ctypes.c_uint64
+    return lib
+
+def recorded(lib, stage):
+    summaries = (HOCSStageSummary * STAGE_COUNT)()
+    assert lib.hocs_telemetry_snapshot(summaries, STAGE_COUNT) == STAGE_COUNT
+    return summaries[stage].count
+
+# --- TESTS ---
+
+def test_rings_registered_during_a_snapshot_keep_recording(engine_lib):
+    """
+    Threads register their ring (first event) while another thread keeps
+    taking snapshots, then record more once snapshots have passed. No ring
+    of a live thread may be dropped by the collector, so every event counts.
+    """
+    lib = engine_lib
+    lib.hocs_telemetry_reset()
+    stop = threading.Event()
+
+    def poll():
+        summaries = (HOCSStageSummary * STAGE_COUNT)()
+        while not stop.is_set():
+            lib.hocs_telemetry_snapshot(summaries, STAGE_COUNT)
+
+    def record(registered, resume):
+        start = lib.hocs_telemetry_now()
+        lib.hocs_telemetry_record(STAGE_IRQ, start, start + 1)
+        registered.set()
+        resume.wait()
+        for _ in range(EVENTS_PER_THREAD - 1):
+            lib.hocs_telemetry_record(STAGE_IRQ, start, start + 1)
+
+    poller = threading.Thread(target=poll)
+    poller.start()
+    try:
+        for _ in range(THREADS):
+            registered, resume = threading.Event(), threading.Event()
+            worker = threading.Thread(target=record, args=(registered, resume))
+            worker.start()
+            registered.wait()
+            recorded(lib, STAGE_IRQ)  # At least one collection after the registration
+            resume.set()
+            worker.join()
+    finally:
+        stop.set()
+        poller.join()
+
+    assert lib.hocs_telemetry_dropped() == 0
+    assert recorded(lib, STAGE_IRQ) == THREADS * EVENTS_PER_THREAD